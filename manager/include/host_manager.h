@@ -8,21 +8,39 @@
 #include <unordered_map>
 #include <mutex>
 #include "monitor_info.pb.h"
-#include "utils/safe_queue.h" // [新增] 引入队列头文件
+#include "storage/batch_writer.h"
+#include "storage/mysql_conn_pool.h"
+#include "storage/storage_pipeline.h"
+#include "utils/message_ptr.h"
+#include "utils/mpsc_ring.h" // 分片接收队列（无锁 MPSC 环形队列）
 
 namespace monitor {
 
 // 定义 HostScore 结构体 (保留原有逻辑)
 struct HostScore {
-  monitor::proto::MonitorInfo info;
+  MonitorInfoPtr info;  // 与接收/入库阶段共享同一份上报，不做拷贝
   double score;
   std::chrono::system_clock::time_point timestamp;
 };
 
+// 接收队列参数
+struct IngressOptions {
+  size_t queue_capacity = 1024;  // 每个分片接收队列的容量（条上报，向上取整为 2 的幂）
+  size_t consume_batch = 64;     // 消费线程单次批量出队的最大条数
+  // kDropOldest：队列满时同一主机的新上报替换它自己的旧上报，不影响其他主机
+  OverflowPolicy overflow_policy = OverflowPolicy::kDropOldest;
+  std::chrono::milliseconds retry_after{5000};  // 拒绝时建议工作者退避的时间
+};
+
 class HostManager {
  public:
   // [修改] 构造函数增加 thread_count 参数，默认 4 个线程
-  explicit HostManager(size_t thread_count = 4);
+  // storage_options: 入库流水线（写库线程池、存储队列）参数
+  // ingress_options: 分片接收队列的容量与溢出策略
+  explicit HostManager(size_t thread_count = 4,
+                       const StoragePipelineOptions& storage_options =
+                           StoragePipelineOptions(),
+                       const IngressOptions& ingress_options = IngressOptions());
   ~HostManager();
 
   // 启动后台清理线程等
@@ -31,7 +49,17 @@ class HostManager {
   void Stop();
 
   // [生产者接口] gRPC 线程调用此方法，内部实现 Hash 分发
-  void OnDataReceived(const monitor::proto::MonitorInfo& host_info);
+  // 返回 false 表示目标分片已饱和、数据被拒绝，调用方应通知工作者退避
+  bool OnDataReceived(MonitorInfoPtr host_info);
+
+  // 被拒绝时建议工作者等待多久再重试
+  std::chrono::milliseconds RetryAfterHint() const {
+    return ingress_options_.retry_after;
+  }
+
+  // 接收队列溢出统计
+  uint64_t GetRejectedCount() const { return rejected_count_; }
+  uint64_t GetReplacedCount() const { return replaced_count_; }
 
   // 获取所有主机评分 (供 QueryService 使用)
   std::unordered_map<std::string, HostScore> GetAllHostScores();
@@ -39,14 +67,26 @@ class HostManager {
   // 获取最高分主机
   std::string GetBestHost();
 
+  // 获取数据库连接池统计（等待时间、重连次数）
+  MysqlPoolStats GetDbPoolStats() const;
+
+  // 获取入库流水线统计（存储队列深度、排队耗时、批量写入情况）
+  StoragePipelineStats GetStorageStats() const;
+
+  // 获取评分阶段耗时统计（单条上报从出队到投递入库的耗时）
+  StageLatency GetScoreLatency() const;
+
+  // 获取各分片接收队列的当前深度
+  std::vector<size_t> GetQueueDepths() const;
+
  private:
   // [新增] 消费者线程的工作函数
   // queue_index: 标记当前线程负责处理第几个队列
   void ConsumeMessage(int queue_index);
 
-  // [新增] 真正的业务处理逻辑 (计算评分、入库、告警)
-  // 由后台线程调用，不阻塞 gRPC 线程
-  void ProcessData(const monitor::proto::MonitorInfo& host_info);
+  // [新增] 真正的业务处理逻辑 (计算评分、生成入库数据、告警)
+  // 由后台线程调用，不阻塞 gRPC 线程；shard_idx 为消费线程的队列索引
+  void ProcessData(const MonitorInfoPtr& host_info, size_t shard_idx);
 
   // 清理过期数据的线程函数
   void ProcessLoop();
@@ -54,9 +94,9 @@ class HostManager {
   // 辅助函数：计算评分
   double CalcScore(const monitor::proto::MonitorInfo& info);
   
-  // 辅助函数：写入 MySQL
-  void WriteToMysql(
-      const std::string& host_name, const HostScore& host_score,
+  // 辅助函数：生成各表的行数据并投递到入库流水线，不在评分线程上写库
+  void SubmitToStorage(
+      size_t shard_idx, const std::string& host_name, const HostScore& host_score,
       double net_in_rate, double net_out_rate, float cpu_percent_rate,
       float usr_percent_rate, float system_percent_rate, float nice_percent_rate,
       float idle_percent_rate, float io_wait_percent_rate, float irq_percent_rate,
@@ -69,15 +109,65 @@ class HostManager {
 
   // 线程数量
   size_t thread_count_;
+  IngressOptions ingress_options_;
+
+  // 被拒绝 / 被同一主机更新的上报替换掉的上报条数
+  std::atomic<uint64_t> rejected_count_{0};
+  std::atomic<uint64_t> replaced_count_{0};
   
   // 运行状态标志
   std::atomic<bool> running_;
 
+  // 一个分片的接收队列
+  // kDropOldest 策略下环形队列满时不挤掉队头（可能是其他主机唯一的一条），
+  // 只有该主机自己已有上报在排队时才接收：新的放进它的溢出槽，同时丢弃它在
+  // 环形队列中最早的一条（或直接替换溢出槽中的那条），该主机排队的条数不变；
+  // 否则拒绝，由工作者按 retry_after 退避
+  struct IngressShard {
+    struct Pending {
+      MonitorInfoPtr info;
+      // 放入时环形队列的入队位置；消费者取完这之前入队的数据后才处理它，
+      // 同一主机的上报保持先后顺序
+      size_t ring_pos;
+    };
+    // 一个主机在环形队列中的实时上报（补传的历史样本不计入，也不会被丢弃）
+    struct Backlog {
+      int64_t queued = 0;  // 在环形队列中的条数；出队与入队计数可能先后颠倒，暂时为负
+      int64_t skip = 0;    // 其中最早的 skip 条已被溢出槽中的新上报取代，出队时丢弃
+    };
+
+    IngressShard(size_t capacity, OverflowPolicy policy)
+        : ring(capacity, policy == OverflowPolicy::kDropOldest
+                             ? OverflowPolicy::kReject
+                             : policy) {}
+
+    MpscRing<MonitorInfoPtr> ring;
+    std::mutex overflow_mtx;
+    std::unordered_map<std::string, Pending> overflow;  // key: 主机标识
+    std::unordered_map<std::string, Backlog> backlog;   // key: 主机标识
+    std::atomic<size_t> overflow_size{0};  // 生产者 / 消费者无锁判断溢出槽是否为空
+  };
+
+  // 出队后更新各主机的排队计数，丢弃已被取代的上报（置空）
+  void SettleBacklog(IngressShard& shard, MonitorInfoPtr* batch, size_t n);
+  // 处理溢出槽中已轮到的上报，返回处理的条数
+  size_t DrainOverflow(IngressShard& shard, size_t shard_idx,
+                       std::vector<MonitorInfoPtr>* ready);
+
   // [核心新增] N 个队列，N 个线程
-  // 使用 shared_ptr 管理 SafeQueue，方便在 vector 中存储和传递
-  std::vector<std::shared_ptr<SafeQueue<monitor::proto::MonitorInfo>>> queues_;
-  //std::vector<std::shared_ptr<SafeQueue<monitor::proto::MonitorInfo>> queues_;
+  // gRPC 线程为多生产者，每个队列只有对应的一个消费线程
+  std::vector<std::unique_ptr<IngressShard>> shards_;
   std::vector<std::thread> worker_threads_;
+
+  // 数据库长连接池，每个写库线程固定持有自己的连接
+  std::unique_ptr<MysqlConnPool> db_pool_;
+
+  // 入库流水线：有界存储队列 + 写库线程池
+  std::unique_ptr<StoragePipeline> storage_;
+
+  // 评分阶段耗时
+  mutable std::mutex score_latency_mtx_;
+  StageLatency score_latency_;
   
   // 清理线程
   std::unique_ptr<std::thread> thread_;
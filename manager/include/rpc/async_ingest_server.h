@@ -0,0 +1,114 @@
+/**
+ * @file async_ingest_server.h
+ * @brief SetMonitorInfo / StreamMonitorInfo 的异步（完成队列）接收服务
+ * @details 同步服务每个在途推送都要占用一个 gRPC 同步线程，线程数随并发连接增长。
+ *          这里为每个轮询线程创建一个 ServerCompletionQueue，并预先在每个队列上
+ *          挂起若干个 SetMonitorInfo 调用；请求到达后在轮询线程上直接交给
+ *          GrpcServerImpl::HandleMonitorInfo（进而投递到 HostManager 分片队列），
+ *          全程不阻塞，线程总数固定为 thread_count。
+ *
+ *          每个调用的请求消息预先分配在 Arena 句柄上，gRPC 直接反序列化到其中，
+ *          之后以 MonitorInfoPtr 共享给下游，接收路径上不再有消息拷贝。
+ *
+ *          StreamMonitorInfo 是工作者的长连接推送：每条流在一个完成队列上
+ *          循环 Read，每条上报同样交给 Ingest；管理者至多每 ack_interval
+ *          回一个 PushAck，分片饱和时立即回执并带上 retry_after_ms。
+ *          同一条流同时最多一个在途 Write，其余回执合并到下一次。
+ *
+ *          Backfill 是工作者断连期间积压样本的批量补传，调用频率低，
+ *          每个完成队列只挂起一个；批次整体反序列化到一个 Arena 上。
+ *
+ * 用法：
+ *   AsyncIngestServer ingest(&service, options);
+ *   builder.RegisterService(&service);
+ *   ingest.AddCompletionQueues(&builder);   // BuildAndStart 之前
+ *   auto server = builder.BuildAndStart();
+ *   ingest.Start();
+ *   ...
+ *   server->Shutdown(deadline);             // 推送流是长连接，需给 deadline 才会被取消
+ *   ingest.Shutdown();                      // Server::Shutdown 之后
+ */
+#pragma once
+
+#include <grpcpp/server_builder.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rpc/grpc_server.h"
+
+namespace monitor {
+
+struct AsyncIngestOptions {
+  size_t thread_count = 2;     // 轮询线程数，每个线程独占一个完成队列
+  size_t calls_per_queue = 64; // 每个完成队列上预先挂起的调用数，决定单队列的并发上限
+  size_t streams_per_queue = 4;  // 每个完成队列上预先挂起的流式推送数
+  std::chrono::milliseconds ack_interval{1000};  // 流式推送的回执间隔
+};
+
+struct AsyncIngestStats {
+  uint64_t calls = 0;     // 已处理的推送（一元调用与流上的上报合计）
+  uint64_t rejected = 0;  // 因分片饱和被拒绝
+  uint64_t invalid = 0;   // 请求不合法
+  uint64_t streams_opened = 0;  // 累计建立的推送流
+  uint64_t streams_active = 0;  // 当前打开的推送流
+  uint64_t backfilled = 0;      // 经 Backfill 补传接收的历史样本
+};
+
+class AsyncIngestServer {
+ public:
+  AsyncIngestServer(GrpcServerImpl* service,
+                    const AsyncIngestOptions& options = AsyncIngestOptions());
+  ~AsyncIngestServer();
+
+  AsyncIngestServer(const AsyncIngestServer&) = delete;
+  AsyncIngestServer& operator=(const AsyncIngestServer&) = delete;
+
+  // 向 builder 注册完成队列，必须在 BuildAndStart 之前调用
+  void AddCompletionQueues(grpc::ServerBuilder* builder);
+
+  // 挂起初始调用并启动轮询线程，必须在 BuildAndStart 之后调用
+  void Start();
+
+  // 关闭完成队列并等待轮询线程退出，必须在 Server::Shutdown 之后调用
+  void Shutdown();
+
+  AsyncIngestStats GetStats() const;
+
+ private:
+  class Operation;
+  class CallData;
+  class StreamCall;
+  class BackfillCall;
+
+  void PollLoop(grpc::ServerCompletionQueue* cq);
+
+  // 在完成队列仍可用时执行 start（挂起调用或发起读写），返回是否执行。
+  // 完成队列关闭后不能再投递任何操作，与 Shutdown 互斥
+  template <typename F>
+  bool RunIfActive(F&& start);
+
+  void CountResult(IngestResult result);
+
+  GrpcServerImpl* service_;
+  AsyncIngestOptions options_;
+  std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs_;
+  std::vector<std::thread> threads_;
+  bool started_ = false;
+  std::mutex shutdown_mtx_;
+  bool shutting_down_ = false;
+
+  std::atomic<uint64_t> calls_{0};
+  std::atomic<uint64_t> rejected_{0};
+  std::atomic<uint64_t> invalid_{0};
+  std::atomic<uint64_t> streams_opened_{0};
+  std::atomic<uint64_t> streams_active_{0};
+  std::atomic<uint64_t> backfilled_{0};
+};
+
+}  // namespace monitor
@@ -3,6 +3,7 @@
 #include <grpcpp/support/status.h>
 #include <grpcpp/server_context.h>
 
+#include <array>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -11,28 +12,54 @@
 
 #include "monitor_info.grpc.pb.h"
 #include "monitor_info.pb.h"
+#include "utils/message_ptr.h"
 
 namespace monitor {
 
 struct HostData {
-  monitor::proto::MonitorInfo info;
+  MonitorInfoPtr info;
   std::chrono::system_clock::time_point timestamp;
 };
 
 // 数据接收回调函数类型
-using DataReceivedCallback = std::function<void(const monitor::proto::MonitorInfo&)>;
+// 返回 false 表示数据未被接收（分片饱和），SetMonitorInfo 将返回 RESOURCE_EXHAUSTED
+// 回调在 gRPC 轮询线程上执行，不能阻塞
+// 回调拿到的是共享句柄，可直接保存/入队，无需拷贝消息
+using DataReceivedCallback = std::function<bool(MonitorInfoPtr)>;
+
+// 过载时通过 trailing metadata 告诉工作者多久后再重试（毫秒）
+constexpr char kRetryAfterMetadataKey[] = "retry-after-ms";
+
+// 单条上报的处理结果
+enum class IngestResult {
+  kAccepted,  // 已投递到分片队列
+  kRejected,  // 分片饱和，工作者应退避
+  kInvalid,   // 缺少主机标识等，直接丢弃
+};
 
 // gRPC 服务实现类 - 接收工作者推送的监控数据
-class GrpcServerImpl : public monitor::proto::GrpcManager::Service 
-{
+// SetMonitorInfo / StreamMonitorInfo / Backfill 标记为异步方法，由 AsyncIngestServer
+// 在完成队列上驱动，请求直接反序列化到 Arena 句柄中后交给 Ingest；
+// GetMonitorInfo 仍走同步接口
+class GrpcServerImpl
+    : public monitor::proto::GrpcManager::WithAsyncMethod_SetMonitorInfo<
+          monitor::proto::GrpcManager::WithAsyncMethod_StreamMonitorInfo<
+              monitor::proto::GrpcManager::WithAsyncMethod_Backfill<
+                  monitor::proto::GrpcManager::Service>>> {
  public:
   GrpcServerImpl() = default;
   virtual ~GrpcServerImpl() = default;
 
-  // 接收工作者推送的监控数据
-  ::grpc::Status SetMonitorInfo(::grpc::ServerContext* context,
-                                const ::monitor::proto::MonitorInfo* request,
-                                ::google::protobuf::Empty* response) override;
+  // 处理一条上报：记录最新数据并交给回调（补传的历史样本不更新最新数据）
+  IngestResult Ingest(MonitorInfoPtr info);
+
+  // 处理一个补传批次：按顺序逐条 Ingest，分片饱和时停止，回执中给出已接收条数
+  monitor::proto::BackfillAck IngestBackfill(
+      const std::shared_ptr<monitor::proto::MonitorInfoBatch>& batch);
+
+  // 一元推送：Ingest 的结果转换为返回给工作者的状态，过载时附带重试提示
+  ::grpc::Status HandleMonitorInfo(::grpc::ServerContext* context,
+                                   MonitorInfoPtr info);
 
   // 获取监控数据（保留接口）
   ::grpc::Status GetMonitorInfo(::grpc::ServerContext* context,
@@ -44,6 +71,12 @@ class GrpcServerImpl : public monitor::proto::GrpcManager::Service
     callback_ = std::move(callback);
   }
 
+  // 设置过载时建议工作者退避的时间
+  void SetRetryAfterHint(std::chrono::milliseconds retry_after) {
+    retry_after_ = retry_after;
+  }
+  std::chrono::milliseconds RetryAfterHint() const { return retry_after_; }
+
   // 获取所有主机数据
   std::unordered_map<std::string, HostData> GetAllHostData();
 
@@ -51,9 +84,20 @@ class GrpcServerImpl : public monitor::proto::GrpcManager::Service
   bool GetHostData(const std::string& hostname, HostData* data);
 
  private:
-  std::mutex mtx_;
-  std::unordered_map<std::string, HostData> host_data_;
+  // 按主机名分段加锁，多个轮询线程同时写入时互不阻塞
+  static constexpr size_t kHostDataShards = 16;
+  struct HostDataShard {
+    std::mutex mtx;
+    std::unordered_map<std::string, HostData> data;
+  };
+
+  HostDataShard& ShardFor(const std::string& hostname) {
+    return host_data_[std::hash<std::string>{}(hostname) % kHostDataShards];
+  }
+
+  std::array<HostDataShard, kHostDataShards> host_data_;
   DataReceivedCallback callback_;
+  std::chrono::milliseconds retry_after_{5000};
 };
 
 }  // namespace monitor
@@ -0,0 +1,155 @@
+/**
+ * @file batch_writer.h
+ * @brief 分片批量写库器 (Group Commit)
+ * @details 每个消费分片持有一个 MysqlBatchWriter，收集多个主机的行数据，
+ *          达到行数阈值或延迟预算时，按表合并为多行
+ *          INSERT ... VALUES (...),(...) 并在同一个事务内提交。
+ *          默认走预编译语句 + 二进制协议（见 prepared_insert.h），
+ *          也可切换回拼接 SQL 文本的方式。
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "storage/mysql_conn_pool.h"
+
+namespace monitor {
+
+// 写入的目标表
+enum class StorageTable {
+  kPerformance = 0,  // server_performance
+  kNetDetail,        // server_net_detail
+  kSoftIrqDetail,    // server_softirq_detail
+  kMemDetail,        // server_mem_detail
+  kDiskDetail,       // server_disk_detail
+  kCount
+};
+
+// 表结构描述：server_name [+ 子对象列] + 整数列 + 浮点列 + timestamp
+struct TableSchema {
+  const char* table;
+  const char* sub_name_column;  // nullptr 表示没有子对象列（网卡名/CPU名/磁盘名）
+  std::vector<const char*> int_columns;
+  std::vector<const char*> float_columns;
+
+  // 一行的总列数（含 server_name 与 timestamp）
+  size_t ColumnCount() const {
+    return 2 + (sub_name_column ? 1 : 0) + int_columns.size() +
+           float_columns.size();
+  }
+};
+
+// 获取表结构定义
+const TableSchema& GetTableSchema(StorageTable table);
+
+// 生成 "INSERT INTO t (`a`,`b`,...) VALUES " 前缀
+std::string BuildInsertPrefix(const TableSchema& schema);
+
+// 单表最多的列数（server_performance 有 53 个浮点列）
+constexpr size_t kMaxIntColumns = 10;
+constexpr size_t kMaxFloatColumns = 53;
+
+// 一行待写入的数据，列值按 TableSchema 中的顺序存放
+struct StorageRow {
+  StorageTable table = StorageTable::kPerformance;
+  std::string server_name;
+  std::string sub_name;
+  std::array<int64_t, kMaxIntColumns> ints{};
+  std::array<double, kMaxFloatColumns> floats{};
+  std::time_t timestamp = 0;
+
+  // 按列顺序填值，个数必须与表结构一致
+  void SetInts(std::initializer_list<int64_t> values);
+  void SetFloats(std::initializer_list<double> values);
+};
+
+// 入库方式
+enum class InsertMode {
+  kPrepared,  // 预编译语句 + 参数绑定（二进制协议）
+  kText,      // 拼接多行 INSERT 文本
+};
+
+struct BatchWriterOptions {
+  InsertMode mode = InsertMode::kPrepared;
+  size_t max_rows = 5000;                       // 攒够多少行立即提交
+  std::chrono::milliseconds max_delay{200};     // 首行入批后最多等待多久提交
+  size_t max_statement_bytes = 1024 * 1024;     // 单条 INSERT 的大小上限（需小于 max_allowed_packet）
+};
+
+// 批量写入统计
+struct BatchWriterStats {
+  uint64_t flush_count = 0;      // 提交次数
+  uint64_t failed_flushes = 0;   // 失败（回滚）次数
+  uint64_t rows_written = 0;     // 成功写入行数
+  uint64_t rows_dropped = 0;     // 因失败丢弃的行数
+  uint64_t statements = 0;       // 执行的 INSERT 语句条数
+  uint64_t last_batch_rows = 0;  // 最近一次提交的行数
+  uint64_t max_batch_rows = 0;   // 单次提交最大行数
+  uint64_t total_flush_us = 0;   // 累计提交耗时（微秒）
+  uint64_t max_flush_us = 0;     // 单次提交最大耗时（微秒）
+};
+
+class PreparedInsertCache;
+
+class MysqlBatchWriter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // shard: 使用连接池中哪个分片的连接
+  MysqlBatchWriter(MysqlConnPool* pool, size_t shard,
+                   const BatchWriterOptions& options = BatchWriterOptions());
+  ~MysqlBatchWriter();
+
+  MysqlBatchWriter(const MysqlBatchWriter&) = delete;
+  MysqlBatchWriter& operator=(const MysqlBatchWriter&) = delete;
+
+  // 追加一行，达到行数阈值时立即提交
+  void Add(StorageRow row);
+
+  // 到达延迟预算时提交
+  void FlushIfDue();
+
+  // 立即提交当前批次，返回是否成功（空批次返回 true）
+  bool Flush();
+
+  // 当前批次的提交截止时间；没有待写入数据时返回 Clock::time_point::max()
+  Clock::time_point Deadline() const;
+
+  size_t PendingRows() const { return pending_rows_; }
+
+  BatchWriterStats GetStats() const;
+
+ private:
+#ifdef ENABLE_MYSQL
+  // 两种写入方式，返回是否成功，statements 累加执行的语句数
+  bool WriteText(MysqlConnPool::Handle& conn, uint64_t* statements);
+  bool WritePrepared(MysqlConnPool::Handle& conn, uint64_t* statements);
+#endif
+
+  MysqlConnPool* pool_;
+  size_t shard_;
+  BatchWriterOptions options_;
+
+  std::array<std::vector<StorageRow>, static_cast<size_t>(StorageTable::kCount)>
+      rows_;
+  size_t pending_rows_ = 0;
+  Clock::time_point batch_start_;
+
+#ifdef ENABLE_MYSQL
+  // 预编译语句缓存，绑定在某个连接上，连接重建后重新创建
+  std::unique_ptr<PreparedInsertCache> stmt_cache_;
+#endif
+
+  mutable std::mutex stats_mtx_;
+  BatchWriterStats stats_;
+};
+
+}  // namespace monitor
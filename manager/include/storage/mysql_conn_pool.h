@@ -0,0 +1,138 @@
+/**
+ * @file mysql_conn_pool.h
+ * @brief MySQL 长连接池
+ * @details 按消费分片固定分配连接（每个分片一个或多个），连接长期复用，
+ *          使用前做健康检查，出错后在下一次获取时自动重连。
+ *          入库热路径不再执行 mysql_init / mysql_real_connect / mysql_close。
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_MYSQL
+#include <mysql/mysql.h>
+#endif
+
+namespace monitor {
+
+// MySQL 连接参数
+struct MysqlConfig {
+  std::string host;
+  std::string user;
+  std::string password;
+  std::string database;
+  unsigned int port = 0;
+  unsigned int connect_timeout_sec = 3;
+};
+
+// 连接池统计信息
+struct MysqlPoolStats {
+  uint64_t acquire_count = 0;     // 获取连接次数
+  uint64_t total_wait_us = 0;     // 累计等待连接时间（微秒）
+  uint64_t max_wait_us = 0;       // 单次最大等待时间（微秒）
+  uint64_t reconnect_count = 0;   // 重连成功次数
+  uint64_t connect_failures = 0;  // 连接失败次数
+};
+
+class MysqlConnPool {
+  struct Slot;
+
+ public:
+  // 连接句柄 (RAII)：持有期间独占该连接，析构时归还
+  class Handle {
+   public:
+    Handle() = default;
+    Handle(MysqlConnPool* pool, Slot* slot) : pool_(pool), slot_(slot) {}
+    ~Handle() { Release(); }
+
+    Handle(Handle&& other) noexcept : pool_(other.pool_), slot_(other.slot_) {
+      other.pool_ = nullptr;
+      other.slot_ = nullptr;
+    }
+    Handle& operator=(Handle&& other) noexcept {
+      if (this != &other) {
+        Release();
+        pool_ = other.pool_;
+        slot_ = other.slot_;
+        other.pool_ = nullptr;
+        other.slot_ = nullptr;
+      }
+      return *this;
+    }
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+#ifdef ENABLE_MYSQL
+    MYSQL* get() const;
+#endif
+    explicit operator bool() const;
+
+    // 当前连接的唯一编号，每次(重)连接都会变化，用于判断预编译语句是否还有效
+    uint64_t id() const;
+
+    // 执行 SQL，遇到断线类错误时标记连接失效，下次获取时重连
+    bool Query(const std::string& sql);
+
+    // 手动标记连接失效
+    void MarkBroken();
+
+   private:
+    void Release();
+
+    MysqlConnPool* pool_ = nullptr;
+    Slot* slot_ = nullptr;
+  };
+
+  // conns_per_shard: 每个分片固定分配的连接数
+  MysqlConnPool(const MysqlConfig& config, size_t shard_count,
+                size_t conns_per_shard = 1);
+  ~MysqlConnPool();
+
+  MysqlConnPool(const MysqlConnPool&) = delete;
+  MysqlConnPool& operator=(const MysqlConnPool&) = delete;
+
+  // 获取分片 shard 的连接：优先取该分片空闲的连接，全部占用时阻塞等待
+  // 返回的句柄可能为空（数据库不可达），调用方需判断
+  Handle Acquire(size_t shard);
+
+  MysqlPoolStats GetStats() const;
+
+  size_t Size() const { return slots_.size(); }
+
+  // 错误码是否意味着连接已不可用
+  static bool IsConnectionError(unsigned int err);
+
+ private:
+  struct Slot {
+    std::mutex mtx;  // 持有期间上锁，保证一个连接同一时刻只被一个线程使用
+#ifdef ENABLE_MYSQL
+    MYSQL* conn = nullptr;
+#endif
+    bool broken = false;
+    bool ever_connected = false;
+    uint64_t conn_id = 0;
+    std::chrono::steady_clock::time_point last_used;
+    std::chrono::steady_clock::time_point next_retry;  // 连接失败后的重试时间
+  };
+
+  // 确保 slot 持有可用连接（调用方已持有 slot->mtx）
+  bool EnsureConnected(Slot* slot);
+  bool Connect(Slot* slot);
+  void Disconnect(Slot* slot);
+
+  MysqlConfig config_;
+  size_t shard_count_;
+  size_t conns_per_shard_;
+  std::vector<std::unique_ptr<Slot>> slots_;
+  uint64_t next_conn_id_ = 1;  // 只在持有 stats_mtx_ 时递增
+
+  mutable std::mutex stats_mtx_;
+  MysqlPoolStats stats_;
+};
+
+}  // namespace monitor
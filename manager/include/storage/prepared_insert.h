@@ -0,0 +1,78 @@
+/**
+ * @file prepared_insert.h
+ * @brief 预编译多行 INSERT 语句缓存 (二进制协议)
+ * @details 每张表按 2 的幂行数 (1, 2, 4, ..., 256) 预编译
+ *          INSERT ... VALUES (?,...),(?,...) 语句，参数直接绑定到 StorageRow
+ *          中的整数/浮点/字符串字段：客户端不再做文本格式化和转义，
+ *          服务端也不再重复解析 SQL。主机名等字符串作为参数传递，不存在注入问题。
+ *
+ *          libmysqlclient 不支持 MariaDB 的数组绑定 (STMT_ATTR_ARRAY_SIZE)，
+ *          因此用“多行占位符语句 + 按 2 的幂拆分批次”达到同样的效果：
+ *          任意行数的批次最多执行 log2(256) + N/256 条语句。
+ *
+ *          语句属于某条连接，连接重建后必须整体丢弃重新预编译。
+ *          非线程安全，由持有它的 MysqlBatchWriter 在其消费线程中使用。
+ */
+#pragma once
+
+#ifdef ENABLE_MYSQL
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <mysql/mysql.h>
+
+#include "storage/batch_writer.h"
+
+namespace monitor {
+
+class PreparedInsertCache {
+ public:
+  // 单条语句最多绑定的行数，40 列 x 256 行远小于 65535 个占位符的上限
+  static constexpr size_t kMaxRowsPerStatement = 256;
+
+  PreparedInsertCache(MYSQL* conn, uint64_t conn_id);
+  ~PreparedInsertCache();
+
+  PreparedInsertCache(const PreparedInsertCache&) = delete;
+  PreparedInsertCache& operator=(const PreparedInsertCache&) = delete;
+
+  // 语句所属的连接编号（MysqlConnPool::Handle::id）
+  uint64_t conn_id() const { return conn_id_; }
+
+  // 写入某张表的全部行
+  // 失败时返回 false，*err 为 MySQL 错误码（供调用方判断是否断线）
+  bool Insert(StorageTable table, const std::vector<StorageRow>& rows,
+              uint64_t* statements, unsigned int* err);
+
+ private:
+  // 2^0 .. 2^8 行共 9 档
+  static constexpr size_t kLevels = 9;
+  static_assert((size_t{1} << (kLevels - 1)) == kMaxRowsPerStatement,
+                "kLevels must match kMaxRowsPerStatement");
+
+  // 取 (表, 2^level 行) 对应的语句，首次使用时预编译
+  MYSQL_STMT* GetStatement(StorageTable table, size_t level, unsigned int* err);
+  void CloseStatement(StorageTable table, size_t level);
+
+  // 绑定 rows[begin, begin + count) 并执行
+  bool Execute(MYSQL_STMT* stmt, const TableSchema& schema,
+               const std::vector<StorageRow>& rows, size_t begin, size_t count,
+               unsigned int* err);
+
+  MYSQL* conn_;
+  uint64_t conn_id_;
+  std::array<std::array<MYSQL_STMT*, kLevels>,
+             static_cast<size_t>(StorageTable::kCount)>
+      stmts_{};
+
+  // 绑定用的临时缓冲区，跨批次复用避免反复分配
+  std::vector<MYSQL_BIND> binds_;
+  std::vector<MYSQL_TIME> times_;
+  std::vector<unsigned long> lengths_;
+};
+
+}  // namespace monitor
+
+#endif  // ENABLE_MYSQL
@@ -0,0 +1,107 @@
+/**
+ * @file storage_pipeline.h
+ * @brief 入库流水线阶段：评分线程 -> 有界存储队列 -> 写库线程池
+ * @details 分片消费线程只负责评分和内存状态更新，生成的行数据以批次为单位
+ *          投递到有界存储队列，由独立的写库线程池合并后批量写入 MySQL。
+ *          数据库变慢时只会堆积存储队列，不会拖慢评分与 host_scores_ 的刷新；
+ *          队列满时按 StorageOverflowPolicy 处理（阻塞评分线程或丢弃并计数）。
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "storage/batch_writer.h"
+#include "storage/mysql_conn_pool.h"
+#include "utils/safe_queue.h"
+
+namespace monitor {
+
+// 存储队列满时的处理方式
+enum class StorageOverflowPolicy {
+  kBlock,       // 阻塞投递方直到有空位（不丢数据，数据库慢会反压到评分线程）
+  kDropNewest,  // 最多等待 max_enqueue_wait，仍满则丢弃本批次并计数
+};
+
+struct StoragePipelineOptions {
+  size_t writer_count = 2;        // 写库线程数，每个线程固定使用连接池中的一个分片
+  size_t queue_capacity = 4096;   // 存储队列容量（批次数，一个批次为一台主机的一次上报）
+  StorageOverflowPolicy overflow_policy = StorageOverflowPolicy::kDropNewest;
+  std::chrono::milliseconds max_enqueue_wait{50};
+  BatchWriterOptions batch;       // 每个写库线程的合并参数
+};
+
+// 阶段耗时统计
+struct StageLatency {
+  uint64_t count = 0;
+  uint64_t total_us = 0;
+  uint64_t max_us = 0;
+
+  void Record(uint64_t us) {
+    ++count;
+    total_us += us;
+    if (us > max_us) max_us = us;
+  }
+  // 一批 n 个元素共耗时 total_us，按平均值计入
+  void RecordBatch(uint64_t batch_us, uint64_t n) {
+    if (n == 0) return;
+    count += n;
+    total_us += batch_us;
+    if (batch_us / n > max_us) max_us = batch_us / n;
+  }
+  uint64_t AvgUs() const { return count ? total_us / count : 0; }
+};
+
+struct StoragePipelineStats {
+  uint64_t queue_depth = 0;        // 当前存储队列中的批次数
+  uint64_t queue_high_water = 0;   // 存储队列历史最大深度
+  uint64_t batches_enqueued = 0;   // 成功投递的批次数
+  uint64_t batches_dropped = 0;    // 因队列满被丢弃的批次数
+  uint64_t rows_dropped = 0;       // 因队列满被丢弃的行数
+  StageLatency enqueue_wait;       // 投递等待耗时（反压的直接体现）
+  StageLatency queue_latency;      // 批次在队列中的停留时间
+  BatchWriterStats writer;         // 所有写库线程的合并写入统计
+};
+
+class StoragePipeline {
+ public:
+  // pool 的分片数应不少于 writer_count
+  StoragePipeline(MysqlConnPool* pool, const StoragePipelineOptions& options);
+  ~StoragePipeline();
+
+  StoragePipeline(const StoragePipeline&) = delete;
+  StoragePipeline& operator=(const StoragePipeline&) = delete;
+
+  void Start();
+  // 停止接收新批次，写完队列中剩余的数据后退出写库线程
+  void Stop();
+
+  // [评分线程调用] 投递一批行数据，返回 false 表示按策略被丢弃或流水线已停止
+  bool Submit(std::vector<StorageRow> rows);
+
+  StoragePipelineStats GetStats() const;
+
+ private:
+  struct Batch {
+    std::vector<StorageRow> rows;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  void WriterLoop(size_t index);
+
+  StoragePipelineOptions options_;
+  SafeQueue<Batch> queue_;
+  std::vector<std::unique_ptr<MysqlBatchWriter>> writers_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> running_{false};
+
+  mutable std::mutex stats_mtx_;
+  StoragePipelineStats stats_;
+};
+
+}  // namespace monitor
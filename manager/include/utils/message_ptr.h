@@ -0,0 +1,75 @@
+/**
+ * @file message_ptr.h
+ * @brief 只读共享的 MonitorInfo 句柄
+ * @details 一次上报在接收时只物化一次，之后以引用计数句柄在 host_data_、
+ *          分片队列、host_scores_ 与入库阶段之间传递，不再深拷贝。
+ *          消息分配在独立的 protobuf Arena 上：子消息和字符串集中在少数几个
+ *          内存块里，释放时整块归还；首块内嵌在句柄的控制块中，
+ *          小消息只需要一次 malloc。
+ *
+ *          补传批次（MonitorInfoBatch）同样整体分配在一个 Arena 上，
+ *          其中每条样本以别名句柄共享出去，批次在最后一条样本释放后整体回收。
+ */
+#pragma once
+
+#include <google/protobuf/arena.h>
+
+#include <memory>
+
+#include "monitor_info.pb.h"
+
+namespace monitor {
+
+// 只读共享句柄，持有者之间不得修改消息内容
+using MonitorInfoPtr = std::shared_ptr<const monitor::proto::MonitorInfo>;
+
+namespace detail {
+
+// Arena 与消息同生命周期，shared_ptr 的控制块即为该对象
+template <typename Message>
+struct ArenaMessage {
+  static constexpr size_t kInitialBlockSize = 4096;
+
+  ArenaMessage() : arena(MakeOptions(initial_block)) {
+    message = google::protobuf::Arena::CreateMessage<Message>(&arena);
+  }
+
+  static google::protobuf::ArenaOptions MakeOptions(char* block) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block;
+    options.initial_block_size = kInitialBlockSize;
+    return options;
+  }
+
+  alignas(8) char initial_block[kInitialBlockSize];
+  google::protobuf::Arena arena;
+  Message* message = nullptr;
+};
+
+template <typename Message>
+std::shared_ptr<Message> NewArenaMessage() {
+  auto holder = std::make_shared<ArenaMessage<Message>>();
+  Message* message = holder->message;
+  // 别名构造：句柄指向消息，引用计数管理整个 holder（含 Arena）
+  return std::shared_ptr<Message>(std::move(holder), message);
+}
+
+}  // namespace detail
+
+// 创建一个 Arena 上的可写 MonitorInfo，填充完成后转为 MonitorInfoPtr 共享
+inline std::shared_ptr<monitor::proto::MonitorInfo> NewMonitorInfo() {
+  return detail::NewArenaMessage<monitor::proto::MonitorInfo>();
+}
+
+// 创建一个 Arena 上的补传批次，gRPC 直接反序列化到其中
+inline std::shared_ptr<monitor::proto::MonitorInfoBatch> NewMonitorInfoBatch() {
+  return detail::NewArenaMessage<monitor::proto::MonitorInfoBatch>();
+}
+
+// 批次中第 index 条样本的共享句柄，与批次共用同一个引用计数
+inline MonitorInfoPtr BatchItem(
+    const std::shared_ptr<monitor::proto::MonitorInfoBatch>& batch, int index) {
+  return MonitorInfoPtr(batch, &batch->items(index));
+}
+
+}  // namespace monitor
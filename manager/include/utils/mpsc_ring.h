@@ -0,0 +1,247 @@
+/**
+ * @file mpsc_ring.h
+ * @brief 无锁有界环形队列（多生产者 / 单消费者）
+ * @details 基于 Dmitry Vyukov 的有界队列算法：每个槽位带序号，生产者用 CAS
+ *          抢占写位置，写完后发布序号；槽位按缓存行对齐，避免相邻槽位伪共享。
+ *          消费者批量出队（PopBatch），空闲时先自旋，再通过 futex 睡眠，
+ *          生产者只有在消费者确实睡眠时才发起 futex 唤醒系统调用。
+ *
+ *          出队同样使用 CAS，因此 kDropOldest 策略下生产者可以直接“替消费者”
+ *          取走队头元素腾出空位；正常情况下只有一个消费者，CAS 不会竞争。
+ */
+#pragma once
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "utils/queue_policy.h"
+
+namespace mpsc_detail {
+
+constexpr size_t kCacheLine = 64;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// 单核机器上自旋只会拖延持有者，直接让出/睡眠
+inline int SpinLimit(int spins) {
+    static const bool multi_core = std::thread::hardware_concurrency() > 1;
+    return multi_core ? spins : 1;
+}
+
+// 当 *addr == expected 时睡眠，最多 timeout；被唤醒、值已改变或超时都会返回
+inline void FutexWait(std::atomic<uint32_t>* addr, uint32_t expected,
+                      std::chrono::nanoseconds timeout) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT_PRIVATE,
+            expected, &ts, nullptr, 0);
+}
+
+inline void FutexWakeOne(std::atomic<uint32_t>* addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, 1,
+            nullptr, nullptr, 0);
+}
+
+}  // namespace mpsc_detail
+
+template <typename T>
+class MpscRing {
+public:
+    // 消费者进入 futex 睡眠前的自旋次数
+    static constexpr int kSpinIterations = 256;
+
+    // capacity 会向上取整为 2 的幂
+    explicit MpscRing(size_t capacity, OverflowPolicy policy = OverflowPolicy::kBlock)
+        : policy_(policy) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+        for (size_t i = 0; i < cap; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // [生产者调用，可多线程]：按溢出策略入队
+    OfferResult Offer(T&& value) {
+        if (stop_.load(std::memory_order_relaxed)) {
+            return OfferResult::kRejected;
+        }
+
+        OfferResult result = OfferResult::kAccepted;
+        int spins = 0;
+        while (!TryEnqueue(value)) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                return OfferResult::kRejected;
+            }
+            if (policy_ == OverflowPolicy::kReject) {
+                return OfferResult::kRejected;
+            }
+            if (policy_ == OverflowPolicy::kDropOldest) {
+                // 取走并丢弃队头，为新数据腾出空位
+                T dropped;
+                if (TryDequeue(dropped)) {
+                    result = OfferResult::kReplaced;
+                }
+                continue;
+            }
+            // kBlock：先自旋，再让出 CPU，等待消费者腾出空位
+            if (++spins < mpsc_detail::SpinLimit(kSpinIterations)) {
+                mpsc_detail::CpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        WakeConsumer();
+        return result;
+    }
+
+    // [消费者调用]：非阻塞批量出队，返回取出的个数，out 至少能容纳 max 个元素
+    size_t TryPopBatch(T* out, size_t max) {
+        size_t n = 0;
+        while (n < max && TryDequeue(out[n])) {
+            ++n;
+        }
+        return n;
+    }
+
+    // [消费者调用]：批量出队，队列为空时先自旋再睡眠，最多等待 timeout
+    // 返回 0 表示超时或已停止
+    template <typename Rep, typename Period>
+    size_t PopBatch(T* out, size_t max, const std::chrono::duration<Rep, Period>& timeout) {
+        const int spin_limit = mpsc_detail::SpinLimit(kSpinIterations);
+        for (int i = 0; i < spin_limit; ++i) {
+            size_t n = TryPopBatch(out, max);
+            if (n > 0 || stop_.load(std::memory_order_relaxed)) {
+                return n;
+            }
+            mpsc_detail::CpuRelax();
+        }
+
+        // 先声明“我要睡了”，再检查一次队列，与生产者的“先发布、再检查”配对，
+        // 两侧都有全序屏障，保证不会出现数据已入队但消费者睡死的情况
+        sleeping_.store(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t n = TryPopBatch(out, max);
+        if (n == 0 && !stop_.load(std::memory_order_relaxed)) {
+            mpsc_detail::FutexWait(&sleeping_, 1,
+                                   std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+            n = TryPopBatch(out, max);
+        }
+        sleeping_.store(0, std::memory_order_relaxed);
+        return n;
+    }
+
+    // 停止队列，唤醒睡眠中的消费者
+    void Stop() {
+        stop_.store(true, std::memory_order_seq_cst);
+        sleeping_.store(0, std::memory_order_seq_cst);
+        mpsc_detail::FutexWakeOne(&sleeping_);
+    }
+
+    bool Stopped() const { return stop_.load(std::memory_order_relaxed); }
+
+    // 近似元素个数（并发修改时仅供统计）
+    size_t Size() const {
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+    // 累计的入队 / 出队位置（单调递增）：DequeuePosition() >= p 表示
+    // 位置 p 之前入队的元素都已被取出
+    size_t EnqueuePosition() const { return enqueue_pos_.load(std::memory_order_acquire); }
+    size_t DequeuePosition() const { return dequeue_pos_.load(std::memory_order_acquire); }
+
+private:
+    struct alignas(mpsc_detail::kCacheLine) Slot {
+        std::atomic<size_t> seq{0};
+        T value;
+    };
+
+    // 入队成功时 value 被移走；队列满返回 false 且 value 保持不变
+    bool TryEnqueue(T& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 满
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryDequeue(T& value) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 空
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(slot->value);
+        slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 数据已发布，若消费者在睡眠则唤醒
+    void WakeConsumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed) != 0 &&
+            sleeping_.exchange(0, std::memory_order_relaxed) != 0) {
+            mpsc_detail::FutexWakeOne(&sleeping_);
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    const OverflowPolicy policy_;
+
+    alignas(mpsc_detail::kCacheLine) std::atomic<size_t> enqueue_pos_{0};
+    alignas(mpsc_detail::kCacheLine) std::atomic<size_t> dequeue_pos_{0};
+    alignas(mpsc_detail::kCacheLine) std::atomic<uint32_t> sleeping_{0};
+    std::atomic<bool> stop_{false};
+};
@@ -0,0 +1,20 @@
+/**
+ * @file queue_policy.h
+ * @brief 有界队列的溢出策略与入队结果（SafeQueue / MpscRing 共用）
+ */
+#pragma once
+
+// 队列满时 Offer 的处理策略
+enum class OverflowPolicy {
+    kBlock,       // 阻塞等待空位
+    kDropOldest,  // 丢弃最旧元素腾出空位（SafeQueue: 与新元素 key 相同的最旧元素，
+                  // 没有同 key 元素时拒绝；MpscRing: 队头元素）
+    kReject,      // 直接拒绝新元素
+};
+
+// Offer 的结果
+enum class OfferResult {
+    kAccepted,  // 已入队
+    kReplaced,  // 已入队，同时丢弃了一个旧元素
+    kRejected,  // 队列满（或已停止），未入队
+};
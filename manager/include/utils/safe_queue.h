@@ -2,23 +2,94 @@
  * @file safe_queue.h
  * @brief [新增文件] 线程安全的任务队列 (生产者-消费者模型核心组件)
  * @details 使用 mutex 和 condition_variable 实现阻塞式出队
+ *          可选容量上限：队列满时 Push 阻塞，TryPush/PushFor 可限时放弃，
+ *          Offer 按构造时指定的溢出策略（阻塞 / 按 key 丢弃最旧 / 拒绝）处理
  */
 #pragma once
-#include <queue>
+#include <deque>
 #include <mutex>
+#include <chrono>
+#include <functional>
+#include <string>
 #include <condition_variable>
 
+#include "utils/queue_policy.h"
+
 template <typename T>
 class SafeQueue {
 public:
-    SafeQueue() = default;
+    // 从元素中提取 key，kDropOldest 用它找到“同一来源”的旧元素
+    using KeyFn = std::function<std::string(const T&)>;
+
+    // capacity: 队列容量上限，0 表示不限制
+    explicit SafeQueue(size_t capacity = 0,
+                       OverflowPolicy policy = OverflowPolicy::kBlock,
+                       KeyFn key_fn = nullptr)
+        : capacity_(capacity), policy_(policy), key_fn_(std::move(key_fn)) {}
     ~SafeQueue() = default;
 
-    // [生产者调用]：将数据放入队列
-    void Push(T value) {
-        std::lock_guard<std::mutex> lock(mtx_);
-        queue_.push(std::move(value));
+    // [生产者调用]：将数据放入队列，队列满时阻塞等待
+    // 队列已停止（消费者已退出）时返回 false，元素被丢弃
+    bool Push(T value) {
+        size_t hash = KeyHash(value);
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_full_.wait(lock, [this] { return HasSpace() || stop_; });
+        if (stop_) {
+            return false;
+        }
+        PushBack(std::move(value), hash);
         cond_.notify_one(); // 唤醒一个正在等待的消费者
+        return true;
+    }
+
+    // [生产者调用]：非阻塞入队，队列满或已停止时返回 false（此时 value 不会被移走）
+    bool TryPush(T&& value) {
+        size_t hash = KeyHash(value);
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!HasSpace() || stop_) {
+            return false;
+        }
+        PushBack(std::move(value), hash);
+        cond_.notify_one();
+        return true;
+    }
+
+    // [生产者调用]：限时入队，超时仍满或已停止时返回 false（此时 value 不会被移走）
+    template <typename Rep, typename Period>
+    bool PushFor(T&& value, const std::chrono::duration<Rep, Period>& timeout) {
+        size_t hash = KeyHash(value);
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (!not_full_.wait_for(lock, timeout, [this] { return HasSpace() || stop_; }) || stop_) {
+            return false;
+        }
+        PushBack(std::move(value), hash);
+        cond_.notify_one();
+        return true;
+    }
+
+    // [生产者调用]：按溢出策略入队
+    OfferResult Offer(T&& value) {
+        // key 在加锁前算好，队列满时锁内只比较哈希值
+        std::string key = key_fn_ ? key_fn_(value) : std::string();
+        size_t hash = key_fn_ ? std::hash<std::string>()(key) : 0;
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (policy_ == OverflowPolicy::kBlock) {
+            not_full_.wait(lock, [this] { return HasSpace() || stop_; });
+        }
+        if (stop_) {
+            return OfferResult::kRejected;
+        }
+
+        OfferResult result = OfferResult::kAccepted;
+        if (!HasSpace()) {
+            if (policy_ != OverflowPolicy::kDropOldest || !EraseOldestSameKey(key, hash)) {
+                return OfferResult::kRejected;
+            }
+            result = OfferResult::kReplaced;
+        }
+        PushBack(std::move(value), hash);
+        cond_.notify_one();
+        return result;
     }
 
     // [消费者调用]：从队列取出数据
@@ -32,8 +103,26 @@ public:
             return false;
         }
 
-        value = std::move(queue_.front());
-        queue_.pop();
+        PopFront(value);
+        not_full_.notify_one(); // 唤醒一个等待空位的生产者
+        return true;
+    }
+
+    // [消费者调用]：带截止时间的出队
+    // 返回值：true 表示成功取出；超时或队列已停止且为空时返回 false
+    template <typename Clock, typename Duration>
+    bool PopUntil(T& value, const std::chrono::time_point<Clock, Duration>& deadline) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (!cond_.wait_until(lock, deadline, [this] { return !queue_.empty() || stop_; })) {
+            return false; // 超时
+        }
+
+        if (queue_.empty()) {
+            return false; // 已停止
+        }
+
+        PopFront(value);
+        not_full_.notify_one(); // 唤醒一个等待空位的生产者
         return true;
     }
 
@@ -42,21 +131,65 @@ public:
         std::lock_guard<std::mutex> lock(mtx_);
         stop_ = true;
         cond_.notify_all(); // 唤醒所有等待的线程
+        not_full_.notify_all();
     }
 
-    bool Empty() {
+    bool Empty() const {
         std::lock_guard<std::mutex> lock(mtx_);
         return queue_.empty();
     }
 
-    size_t Size() {
+    size_t Size() const {
         std::lock_guard<std::mutex> lock(mtx_);
         return queue_.size();
     }
 
+    size_t Capacity() const { return capacity_; }
+
 private:
-    std::queue<T> queue_;
-    std::mutex mtx_;
+    // 调用方需持有 mtx_
+    bool HasSpace() const { return capacity_ == 0 || queue_.size() < capacity_; }
+
+    // 元素 key 的哈希；没有 key_fn_ 时为 0，不计算
+    size_t KeyHash(const T& value) const {
+        return key_fn_ ? std::hash<std::string>()(key_fn_(value)) : 0;
+    }
+
+    // 以下调用方需持有 mtx_；key_hashes_ 与 queue_ 一一对应
+    void PushBack(T&& value, size_t hash) {
+        queue_.push_back(std::move(value));
+        if (key_fn_) key_hashes_.push_back(hash);
+    }
+
+    void PopFront(T& value) {
+        value = std::move(queue_.front());
+        queue_.pop_front();
+        if (key_fn_) key_hashes_.pop_front();
+    }
+
+    // 删除与新元素同 key 的最旧元素，只在队列满时走到这里。
+    // 先比较入队时记下的哈希，只有哈希相同时才取 key 确认，避免逐个构造字符串
+    bool EraseOldestSameKey(const std::string& key, size_t hash) {
+        if (!key_fn_) {
+            return false;
+        }
+        for (size_t i = 0; i < key_hashes_.size(); ++i) {
+            if (key_hashes_[i] == hash && key_fn_(queue_[i]) == key) {
+                queue_.erase(queue_.begin() + i);
+                key_hashes_.erase(key_hashes_.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::deque<T> queue_;
+    std::deque<size_t> key_hashes_;
+    mutable std::mutex mtx_;
     std::condition_variable cond_;
+    std::condition_variable not_full_;
+    const size_t capacity_;
+    const OverflowPolicy policy_;
+    const KeyFn key_fn_;
     bool stop_ = false; // 停止标志
-};
\ No newline at end of file
+};
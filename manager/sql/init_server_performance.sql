@@ -56,6 +56,23 @@ CREATE TABLE IF NOT EXISTS server_performance (
     -- 网络变化率
     send_rate_rate FLOAT DEFAULT 0,           -- 发送速率变化率
     rcv_rate_rate FLOAT DEFAULT 0,            -- 接收速率变化率
+    -- 推送窗口内的统计（worker 按 MONITOR_SAMPLE_MS 高频采样）
+    cpu_percent_min FLOAT DEFAULT 0,          -- CPU总使用率窗口最小值
+    cpu_percent_max FLOAT DEFAULT 0,          -- CPU总使用率窗口最大值
+    cpu_percent_avg FLOAT DEFAULT 0,          -- CPU总使用率窗口平均值
+    cpu_percent_p95 FLOAT DEFAULT 0,          -- CPU总使用率窗口P95
+    disk_util_percent_min FLOAT DEFAULT 0,    -- 磁盘利用率（各盘最大）窗口最小值
+    disk_util_percent_max FLOAT DEFAULT 0,    -- 磁盘利用率（各盘最大）窗口最大值
+    disk_util_percent_avg FLOAT DEFAULT 0,    -- 磁盘利用率（各盘最大）窗口平均值
+    disk_util_percent_p95 FLOAT DEFAULT 0,    -- 磁盘利用率（各盘最大）窗口P95
+    send_rate_min FLOAT DEFAULT 0,            -- 发送速率窗口最小值
+    send_rate_max FLOAT DEFAULT 0,            -- 发送速率窗口最大值
+    send_rate_avg FLOAT DEFAULT 0,            -- 发送速率窗口平均值
+    send_rate_p95 FLOAT DEFAULT 0,            -- 发送速率窗口P95
+    rcv_rate_min FLOAT DEFAULT 0,             -- 接收速率窗口最小值
+    rcv_rate_max FLOAT DEFAULT 0,             -- 接收速率窗口最大值
+    rcv_rate_avg FLOAT DEFAULT 0,             -- 接收速率窗口平均值
+    rcv_rate_p95 FLOAT DEFAULT 0,             -- 接收速率窗口P95
     -- 时间戳
     timestamp DATETIME NOT NULL,              -- 采集时间
     INDEX idx_server_time(server_name, timestamp),
@@ -87,6 +104,23 @@ CREATE TABLE IF NOT EXISTS server_net_detail (
     err_out_rate FLOAT DEFAULT 0,               -- 发送错误数变化率
     drop_in_rate FLOAT DEFAULT 0,               -- 接收丢弃数变化率
     drop_out_rate FLOAT DEFAULT 0,              -- 发送丢弃数变化率
+    -- 推送窗口内的统计
+    rcv_bytes_rate_min FLOAT DEFAULT 0,       -- 接收速率窗口最小值
+    rcv_bytes_rate_max FLOAT DEFAULT 0,       -- 接收速率窗口最大值
+    rcv_bytes_rate_avg FLOAT DEFAULT 0,       -- 接收速率窗口平均值
+    rcv_bytes_rate_p95 FLOAT DEFAULT 0,       -- 接收速率窗口P95
+    rcv_packets_rate_min FLOAT DEFAULT 0,     -- 接收包数速率窗口最小值
+    rcv_packets_rate_max FLOAT DEFAULT 0,     -- 接收包数速率窗口最大值
+    rcv_packets_rate_avg FLOAT DEFAULT 0,     -- 接收包数速率窗口平均值
+    rcv_packets_rate_p95 FLOAT DEFAULT 0,     -- 接收包数速率窗口P95
+    snd_bytes_rate_min FLOAT DEFAULT 0,       -- 发送速率窗口最小值
+    snd_bytes_rate_max FLOAT DEFAULT 0,       -- 发送速率窗口最大值
+    snd_bytes_rate_avg FLOAT DEFAULT 0,       -- 发送速率窗口平均值
+    snd_bytes_rate_p95 FLOAT DEFAULT 0,       -- 发送速率窗口P95
+    snd_packets_rate_min FLOAT DEFAULT 0,     -- 发送包数速率窗口最小值
+    snd_packets_rate_max FLOAT DEFAULT 0,     -- 发送包数速率窗口最大值
+    snd_packets_rate_avg FLOAT DEFAULT 0,     -- 发送包数速率窗口平均值
+    snd_packets_rate_p95 FLOAT DEFAULT 0,     -- 发送包数速率窗口P95
     -- 时间戳
     timestamp DATETIME NOT NULL,
     INDEX idx_server_net_time(server_name, net_name, timestamp)
@@ -119,6 +153,15 @@ CREATE TABLE IF NOT EXISTS server_softirq_detail (
     sched_rate FLOAT DEFAULT 0,
     hrtimer_rate FLOAT DEFAULT 0,
     rcu_rate FLOAT DEFAULT 0,
+    -- 推送窗口内的统计
+    net_tx_min FLOAT DEFAULT 0,               -- NET_TX窗口最小值
+    net_tx_max FLOAT DEFAULT 0,               -- NET_TX窗口最大值
+    net_tx_avg FLOAT DEFAULT 0,               -- NET_TX窗口平均值
+    net_tx_p95 FLOAT DEFAULT 0,               -- NET_TX窗口P95
+    net_rx_min FLOAT DEFAULT 0,               -- NET_RX窗口最小值
+    net_rx_max FLOAT DEFAULT 0,               -- NET_RX窗口最大值
+    net_rx_avg FLOAT DEFAULT 0,               -- NET_RX窗口平均值
+    net_rx_p95 FLOAT DEFAULT 0,               -- NET_RX窗口P95
     -- 时间戳
     timestamp DATETIME NOT NULL,
     INDEX idx_server_cpu_time(server_name, cpu_name, timestamp)
@@ -205,6 +248,19 @@ CREATE TABLE IF NOT EXISTS server_disk_detail (
     avg_read_latency_ms_rate FLOAT DEFAULT 0,
     avg_write_latency_ms_rate FLOAT DEFAULT 0,
     util_percent_rate FLOAT DEFAULT 0,
+    -- 推送窗口内的统计
+    read_bytes_per_sec_min FLOAT DEFAULT 0,   -- 读吞吐窗口最小值
+    read_bytes_per_sec_max FLOAT DEFAULT 0,   -- 读吞吐窗口最大值
+    read_bytes_per_sec_avg FLOAT DEFAULT 0,   -- 读吞吐窗口平均值
+    read_bytes_per_sec_p95 FLOAT DEFAULT 0,   -- 读吞吐窗口P95
+    write_bytes_per_sec_min FLOAT DEFAULT 0,  -- 写吞吐窗口最小值
+    write_bytes_per_sec_max FLOAT DEFAULT 0,  -- 写吞吐窗口最大值
+    write_bytes_per_sec_avg FLOAT DEFAULT 0,  -- 写吞吐窗口平均值
+    write_bytes_per_sec_p95 FLOAT DEFAULT 0,  -- 写吞吐窗口P95
+    util_percent_min FLOAT DEFAULT 0,         -- 利用率窗口最小值
+    util_percent_max FLOAT DEFAULT 0,         -- 利用率窗口最大值
+    util_percent_avg FLOAT DEFAULT 0,         -- 利用率窗口平均值
+    util_percent_p95 FLOAT DEFAULT 0,         -- 利用率窗口P95
     -- 时间戳
     timestamp DATETIME NOT NULL,
     INDEX idx_server_disk_time(server_name, disk_name, timestamp)
@@ -0,0 +1,63 @@
+-- 为已有的库补充推送窗口统计列（min / max / avg / p95）
+-- 新建的库直接使用 init_server_performance.sql，不需要执行本脚本
+USE monitor_db;
+
+ALTER TABLE server_performance
+    ADD COLUMN cpu_percent_min FLOAT DEFAULT 0,
+    ADD COLUMN cpu_percent_max FLOAT DEFAULT 0,
+    ADD COLUMN cpu_percent_avg FLOAT DEFAULT 0,
+    ADD COLUMN cpu_percent_p95 FLOAT DEFAULT 0,
+    ADD COLUMN disk_util_percent_min FLOAT DEFAULT 0,
+    ADD COLUMN disk_util_percent_max FLOAT DEFAULT 0,
+    ADD COLUMN disk_util_percent_avg FLOAT DEFAULT 0,
+    ADD COLUMN disk_util_percent_p95 FLOAT DEFAULT 0,
+    ADD COLUMN send_rate_min FLOAT DEFAULT 0,
+    ADD COLUMN send_rate_max FLOAT DEFAULT 0,
+    ADD COLUMN send_rate_avg FLOAT DEFAULT 0,
+    ADD COLUMN send_rate_p95 FLOAT DEFAULT 0,
+    ADD COLUMN rcv_rate_min FLOAT DEFAULT 0,
+    ADD COLUMN rcv_rate_max FLOAT DEFAULT 0,
+    ADD COLUMN rcv_rate_avg FLOAT DEFAULT 0,
+    ADD COLUMN rcv_rate_p95 FLOAT DEFAULT 0;
+
+ALTER TABLE server_net_detail
+    ADD COLUMN rcv_bytes_rate_min FLOAT DEFAULT 0,
+    ADD COLUMN rcv_bytes_rate_max FLOAT DEFAULT 0,
+    ADD COLUMN rcv_bytes_rate_avg FLOAT DEFAULT 0,
+    ADD COLUMN rcv_bytes_rate_p95 FLOAT DEFAULT 0,
+    ADD COLUMN rcv_packets_rate_min FLOAT DEFAULT 0,
+    ADD COLUMN rcv_packets_rate_max FLOAT DEFAULT 0,
+    ADD COLUMN rcv_packets_rate_avg FLOAT DEFAULT 0,
+    ADD COLUMN rcv_packets_rate_p95 FLOAT DEFAULT 0,
+    ADD COLUMN snd_bytes_rate_min FLOAT DEFAULT 0,
+    ADD COLUMN snd_bytes_rate_max FLOAT DEFAULT 0,
+    ADD COLUMN snd_bytes_rate_avg FLOAT DEFAULT 0,
+    ADD COLUMN snd_bytes_rate_p95 FLOAT DEFAULT 0,
+    ADD COLUMN snd_packets_rate_min FLOAT DEFAULT 0,
+    ADD COLUMN snd_packets_rate_max FLOAT DEFAULT 0,
+    ADD COLUMN snd_packets_rate_avg FLOAT DEFAULT 0,
+    ADD COLUMN snd_packets_rate_p95 FLOAT DEFAULT 0;
+
+ALTER TABLE server_softirq_detail
+    ADD COLUMN net_tx_min FLOAT DEFAULT 0,
+    ADD COLUMN net_tx_max FLOAT DEFAULT 0,
+    ADD COLUMN net_tx_avg FLOAT DEFAULT 0,
+    ADD COLUMN net_tx_p95 FLOAT DEFAULT 0,
+    ADD COLUMN net_rx_min FLOAT DEFAULT 0,
+    ADD COLUMN net_rx_max FLOAT DEFAULT 0,
+    ADD COLUMN net_rx_avg FLOAT DEFAULT 0,
+    ADD COLUMN net_rx_p95 FLOAT DEFAULT 0;
+
+ALTER TABLE server_disk_detail
+    ADD COLUMN read_bytes_per_sec_min FLOAT DEFAULT 0,
+    ADD COLUMN read_bytes_per_sec_max FLOAT DEFAULT 0,
+    ADD COLUMN read_bytes_per_sec_avg FLOAT DEFAULT 0,
+    ADD COLUMN read_bytes_per_sec_p95 FLOAT DEFAULT 0,
+    ADD COLUMN write_bytes_per_sec_min FLOAT DEFAULT 0,
+    ADD COLUMN write_bytes_per_sec_max FLOAT DEFAULT 0,
+    ADD COLUMN write_bytes_per_sec_avg FLOAT DEFAULT 0,
+    ADD COLUMN write_bytes_per_sec_p95 FLOAT DEFAULT 0,
+    ADD COLUMN util_percent_min FLOAT DEFAULT 0,
+    ADD COLUMN util_percent_max FLOAT DEFAULT 0,
+    ADD COLUMN util_percent_avg FLOAT DEFAULT 0,
+    ADD COLUMN util_percent_p95 FLOAT DEFAULT 0;
@@ -1,11 +1,12 @@
 #include "host_manager.h"
-#include "utils/safe_queue.h" // [必须] 引入队列头文件
 
+#include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <map>
-#include <sstream>
+#include <unordered_map>
 #include <vector>
 #include <functional> // for std::hash
 
@@ -66,6 +67,28 @@ static std::vector<std::map<std::string, std::map<std::string, NetDetailSample>>
 static std::vector<std::map<std::string, std::map<std::string, SoftIrqSample>>> last_softirq_samples_shards;
 static std::vector<std::map<std::string, MemDetailSample>> last_mem_samples_shards;
 static std::vector<std::map<std::string, std::map<std::string, DiskDetailSample>>> last_disk_samples_shards;
+// 补传的历史样本与实时样本交错到达，各明细表的变化率同样以同类的上一条为基准
+static std::vector<std::map<std::string, std::map<std::string, NetDetailSample>>> replayed_net_samples_shards;
+static std::vector<std::map<std::string, std::map<std::string, SoftIrqSample>>> replayed_softirq_samples_shards;
+static std::vector<std::map<std::string, MemDetailSample>> replayed_mem_samples_shards;
+static std::vector<std::map<std::string, std::map<std::string, DiskDetailSample>>> replayed_disk_samples_shards;
+
+// 推送窗口内的统计列（min / max / avg / p95），scale 为入库单位换算系数；
+// 老版本 worker 没有上报统计时四列都取当前值
+struct WindowColumns {
+  float min = 0, max = 0, avg = 0, p95 = 0;
+};
+
+WindowColumns Window(bool has_agg, const monitor::proto::MetricAggregate& agg,
+                     float current, double scale = 1.0) {
+  if (!has_agg || agg.samples() == 0) {
+    return {current, current, current, current};
+  }
+  return {static_cast<float>(agg.min() * scale),
+          static_cast<float>(agg.max() * scale),
+          static_cast<float>(agg.mean() * scale),
+          static_cast<float>(agg.p95() * scale)};
+}
 
 }  // namespace
 #endif
@@ -94,38 +117,67 @@ PerfSample {
 };
 // [分片存储]
 static std::vector<std::map<std::string, PerfSample>> last_perf_samples_shards;
+// 补传的历史样本与实时样本交错到达，变化率各自以同类的上一条为基准
+static std::vector<std::map<std::string, PerfSample>> replayed_perf_samples_shards;
 //static std::vector<std::map<<std::string.PerfSample>> lasetone;
 
 
+namespace {
+// 主机标识：优先使用 host_info 中的主机名，与分片路由保持一致
+std::string HostKey(const monitor::proto::MonitorInfo& info) {
+  if (info.has_host_info() && !info.host_info().hostname().empty()) {
+    return info.host_info().hostname();
+  }
+  return info.name();
+}
+}  // namespace
+
 // 构造函数
-HostManager::HostManager(size_t thread_count) 
-    : thread_count_(thread_count), running_(false) {
+HostManager::HostManager(size_t thread_count,
+                         const StoragePipelineOptions& storage_options,
+                         const IngressOptions& ingress_options)
+    : thread_count_(thread_count),
+      ingress_options_(ingress_options),
+      running_(false) {
   
   if (thread_count_ < 1) thread_count_ = 1;
 
   std::cout << "HostManager initializing with " << thread_count_ << " worker threads..." << std::endl;
 
+  // 创建数据库连接池与入库流水线：每个写库线程一个长连接
+#ifdef ENABLE_MYSQL
+  db_pool_ = std::make_unique<MysqlConnPool>(
+      MysqlConfig{host, user, password, database},
+      std::max<size_t>(storage_options.writer_count, 1));
+  storage_ = std::make_unique<StoragePipeline>(db_pool_.get(), storage_options);
+#else
+  (void)storage_options;
+#endif
+
   // 初始化分片存储空间
   // 注意：这里简单的 resize 假设 HostManager 全局唯一
   if (last_perf_samples_shards.empty()) {
       last_perf_samples_shards.resize(thread_count_);
+      replayed_perf_samples_shards.resize(thread_count_);
       net_samples_shards.resize(thread_count_);
       #ifdef ENABLE_MYSQL
       last_net_samples_shards.resize(thread_count_);
       last_softirq_samples_shards.resize(thread_count_);
       last_mem_samples_shards.resize(thread_count_);
       last_disk_samples_shards.resize(thread_count_);
+      replayed_net_samples_shards.resize(thread_count_);
+      replayed_softirq_samples_shards.resize(thread_count_);
+      replayed_mem_samples_shards.resize(thread_count_);
+      replayed_disk_samples_shards.resize(thread_count_);
       #endif
   }
 
-  // 初始化 N 个队列和 N 个线程
+  // 初始化 N 个有界无锁队列（消费线程在 Start 中启动）
+  // 队列满时按策略处理：同一主机的新数据替换旧数据、阻塞或直接拒绝
+  if (ingress_options_.consume_batch < 1) ingress_options_.consume_batch = 1;
   for (size_t i = 0; i < thread_count_; ++i) {
-      queues_.push_back(std::make_shared<SafeQueue<monitor::proto::MonitorInfo>>());
-      
-      // 启动消费者线程，绑定到 ConsumeMessage 函数
-      worker_threads_.emplace_back([this, i] {
-          this->ConsumeMessage(i);
-      });
+      shards_.push_back(std::make_unique<IngressShard>(
+          ingress_options_.queue_capacity, ingress_options_.overflow_policy));
   }
 }
 
@@ -135,6 +187,17 @@ HostManager::~HostManager() {
 
 void HostManager::Start() {
   running_ = true;
+
+  // 先启动写库线程池，消费线程产生的行数据才有去处
+  if (storage_) storage_->Start();
+
+  // 启动 N 个消费者线程，必须在 running_ 置位之后，否则线程会立即退出
+  for (size_t i = 0; i < thread_count_; ++i) {
+      worker_threads_.emplace_back([this, i] {
+          this->ConsumeMessage(i);
+      });
+  }
+
   // 启动清理过期数据的线程
   thread_ = std::make_unique<std::thread>(&HostManager::ProcessLoop, this);
 }
@@ -144,8 +207,8 @@ void HostManager::Stop() {
   running_ = false;
 
   // 1. 停止所有队列 (唤醒等待的线程)
-  for (auto& queue : queues_) {
-      if (queue) queue->Stop();
+  for (auto& shard : shards_) {
+      if (shard) shard->ring.Stop();
   }
 
   // 2. 等待 Worker 线程退出
@@ -153,7 +216,10 @@ void HostManager::Stop() {
       if (t.joinable()) t.join();
   }
 
-  // 3. 等待清理线程退出
+  // 3. 消费线程已退出，写完存储队列中剩余的数据
+  if (storage_) storage_->Stop();
+
+  // 4. 等待清理线程退出
   if (thread_ && thread_->joinable()) {
     thread_->join();
   }
@@ -164,6 +230,53 @@ void HostManager::ProcessLoop() {
   while (running_) {
     std::this_thread::sleep_for(std::chrono::seconds(60));
     
+    if (db_pool_) {
+      auto stats = db_pool_->GetStats();
+      std::cout << "[DbPool] acquires: " << stats.acquire_count
+                << ", avg wait: "
+                << (stats.acquire_count ? stats.total_wait_us / stats.acquire_count : 0)
+                << " us, max wait: " << stats.max_wait_us
+                << " us, reconnects: " << stats.reconnect_count
+                << ", connect failures: " << stats.connect_failures << std::endl;
+    }
+
+    size_t ingress_depth = 0, ingress_max = 0;
+    for (size_t depth : GetQueueDepths()) {
+      ingress_depth += depth;
+      ingress_max = std::max(ingress_max, depth);
+    }
+    auto score = GetScoreLatency();
+    std::cout << "[Pipeline] ingress queued: " << ingress_depth
+              << " (max shard " << ingress_max << "/" << ingress_options_.queue_capacity << ")"
+              << ", replaced: " << replaced_count_
+              << ", rejected: " << rejected_count_
+              << ", score avg: " << score.AvgUs()
+              << " us, max: " << score.max_us << " us" << std::endl;
+
+    if (storage_) {
+      auto st = GetStorageStats();
+      const auto& batch = st.writer;
+      std::cout << "[Storage] queued: " << st.queue_depth
+                << " (high water " << st.queue_high_water << ")"
+                << ", enqueue wait avg: " << st.enqueue_wait.AvgUs()
+                << " us, max: " << st.enqueue_wait.max_us
+                << " us, queue latency avg: " << st.queue_latency.AvgUs()
+                << " us, max: " << st.queue_latency.max_us
+                << " us, dropped batches: " << st.batches_dropped
+                << " (" << st.rows_dropped << " rows)" << std::endl;
+      std::cout << "[BatchWriter] flushes: " << batch.flush_count
+                << ", rows: " << batch.rows_written
+                << ", statements: " << batch.statements
+                << ", avg batch: "
+                << (batch.flush_count ? (batch.rows_written + batch.rows_dropped) / batch.flush_count : 0)
+                << " rows, max batch: " << batch.max_batch_rows
+                << ", avg flush: "
+                << (batch.flush_count ? batch.total_flush_us / batch.flush_count : 0)
+                << " us, max flush: " << batch.max_flush_us
+                << " us, failed: " << batch.failed_flushes
+                << ", dropped rows: " << batch.rows_dropped << std::endl;
+    }
+
     auto now = std::chrono::system_clock::now();
     std::lock_guard<std::mutex> lock(mtx_);
     for (auto it = host_scores_.begin(); it != host_scores_.end();) {
@@ -179,44 +292,166 @@ void HostManager::ProcessLoop() {
   }
 }
 
-// [生产者]：gRPC 线程调用，只做分发，不阻塞
-void HostManager::OnDataReceived(const monitor::proto::MonitorInfo& info) {
-    std::string host_name = info.name();
-    if (info.has_host_info() && !info.host_info().hostname().empty()) {
-        host_name = info.host_info().hostname();
+// [生产者]：gRPC 线程调用，只做分发，不阻塞（kBlock 策略除外）
+bool HostManager::OnDataReceived(MonitorInfoPtr info) {
+    if (!info) {
+        return true;
     }
+    std::string host_name = HostKey(*info);
 
-    // 必须有标识符才能 Hash
-    if (host_name.empty()) {
-         if (!queues_.empty()) queues_[0]->Push(info); // 兜底
-         return;
+    // 计算 Hash 并路由到指定队列；没有标识符的数据兜底进 0 号队列
+    size_t index = 0;
+    if (!host_name.empty()) {
+        std::hash<std::string> hasher;
+        index = hasher(host_name) % thread_count_;
+    }
+    if (index >= shards_.size()) {
+        return true;
+    }
+    IngressShard& shard = *shards_[index];
+    // 补传的历史样本一经接收，工作者就会推进 spool 游标，不能再被替换掉：
+    // 队列满时直接拒绝，由工作者按 retry_after 稍后重传
+    const bool per_host = ingress_options_.overflow_policy == OverflowPolicy::kDropOldest &&
+                          !info->replayed();
+
+    // 该主机已有上报在溢出槽里：新的直接替换它，不能越过它先进入环形队列
+    if (per_host && shard.overflow_size.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(shard.overflow_mtx);
+        auto it = shard.overflow.find(host_name);
+        if (it != shard.overflow.end()) {
+            it->second.info = std::move(info);
+            replaced_count_++;
+            return true;
+        }
+    }
+
+    // 只移动句柄，不拷贝消息；被拒绝时 info 保持不变
+    switch (shard.ring.Offer(std::move(info))) {
+        case OfferResult::kAccepted:
+            if (per_host) {
+                std::lock_guard<std::mutex> lock(shard.overflow_mtx);
+                shard.backlog[host_name].queued++;
+            }
+            return true;
+        case OfferResult::kReplaced:
+            replaced_count_++;
+            return true;
+        case OfferResult::kRejected:
+        default:
+            break;
     }
 
-    // 计算 Hash 并路由到指定队列
-    std::hash<std::string> hasher;
-    size_t index = hasher(host_name) % thread_count_;
+    // 环形队列满：只替换该主机自己更早的上报。它在环形队列中还有未被取代的
+    // 上报时，最早的一条出队时丢弃，新的放进溢出槽；什么都没有排队则拒绝，
+    // 不会给每个主机额外多出一个队列容量之外的位置
+    if (per_host && !shard.ring.Stopped()) {
+        std::lock_guard<std::mutex> lock(shard.overflow_mtx);
+        auto parked = shard.overflow.find(host_name);
+        if (parked != shard.overflow.end()) {
+            parked->second.info = std::move(info);
+            replaced_count_++;
+            return true;
+        }
+        auto queued = shard.backlog.find(host_name);
+        if (queued != shard.backlog.end() && queued->second.queued > queued->second.skip) {
+            queued->second.skip++;
+            shard.overflow.emplace(host_name,
+                                   IngressShard::Pending{std::move(info),
+                                                         shard.ring.EnqueuePosition()});
+            shard.overflow_size.store(shard.overflow.size(), std::memory_order_release);
+            replaced_count_++;
+            return true;
+        }
+    }
+    rejected_count_++;
+    return false;
+}
 
-    if (index < queues_.size()) {
-        queues_[index]->Push(info);
+void HostManager::SettleBacklog(IngressShard& shard, MonitorInfoPtr* batch, size_t n) {
+    std::lock_guard<std::mutex> lock(shard.overflow_mtx);
+    for (size_t i = 0; i < n; ++i) {
+        if (batch[i]->replayed()) {
+            continue;
+        }
+        IngressShard::Backlog& backlog = shard.backlog[HostKey(*batch[i])];
+        backlog.queued--;
+        // FIFO：被取代的正是该主机最早的几条
+        if (backlog.skip > 0) {
+            backlog.skip--;
+            batch[i].reset();
+        }
     }
 }
 
+size_t HostManager::DrainOverflow(IngressShard& shard, size_t shard_idx,
+                                  std::vector<MonitorInfoPtr>* ready) {
+    if (shard.overflow_size.load(std::memory_order_acquire) == 0) {
+        return 0;
+    }
+    // 放入溢出槽之前进入环形队列的数据都已处理完，才轮到它
+    size_t consumed = shard.ring.DequeuePosition();
+    ready->clear();
+    {
+        std::lock_guard<std::mutex> lock(shard.overflow_mtx);
+        for (auto it = shard.overflow.begin(); it != shard.overflow.end();) {
+            if (it->second.ring_pos <= consumed) {
+                ready->push_back(std::move(it->second.info));
+                it = shard.overflow.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        shard.overflow_size.store(shard.overflow.size(), std::memory_order_release);
+    }
+    for (auto& info : *ready) {
+        ProcessData(info, shard_idx);
+        info.reset();
+    }
+    return ready->size();
+}
+
 // [消费者]：后台线程循环
 void HostManager::ConsumeMessage(int queue_index) {
-    monitor::proto::MonitorInfo info;
-    auto my_queue = queues_[queue_index];
+    IngressShard& shard = *shards_[queue_index];
+    const size_t max_batch = ingress_options_.consume_batch;
+    std::vector<MonitorInfoPtr> batch(max_batch);
+    std::vector<MonitorInfoPtr> ready;
+    const bool per_host = ingress_options_.overflow_policy == OverflowPolicy::kDropOldest;
 
     while (running_) {
-        // Pop 会阻塞等待，直到有数据
-        if (my_queue->Pop(info)) {
+        // 批量出队：空闲时先自旋再睡眠，超时用于检查 running_
+        size_t n = shard.ring.PopBatch(batch.data(), max_batch, std::chrono::milliseconds(200));
+        if (n > 0 && per_host) {
+            SettleBacklog(shard, batch.data(), n);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t processed = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!batch[i]) {
+                continue;  // 已被同一主机更新的上报取代
+            }
             // [核心] 调用具体的业务处理逻辑
-            ProcessData(info);
+            ProcessData(batch[i], queue_index);
+            batch[i].reset(); // 尽早释放本线程持有的引用
+            ++processed;
+        }
+        processed += DrainOverflow(shard, queue_index, &ready);
+
+        if (processed > 0) {
+            auto cost_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            std::lock_guard<std::mutex> lock(score_latency_mtx_);
+            score_latency_.RecordBatch(cost_us, processed);
         }
     }
 }
 
 // [业务逻辑]：这里承载了原先 OnDataReceived 的所有重活
-void HostManager::ProcessData(const monitor::proto::MonitorInfo& info) {
+void HostManager::ProcessData(const MonitorInfoPtr& info_ptr,
+                              size_t shard_idx) {
+  const monitor::proto::MonitorInfo& info = *info_ptr;
+
   // 1. 构建服务器唯一标识
   std::string host_name;
   if (info.has_host_info()) {
@@ -239,38 +474,15 @@ void HostManager::ProcessData(const monitor::proto::MonitorInfo& info) {
     return;
   }
 
-  // 2. 计算当前 Host 属于哪个分片索引 (用于获取历史数据)
-  std::hash<std::string> hasher;
-  size_t shard_idx = hasher(host_name) % thread_count_;
-
-
-
-
-// =========================================================
-  // [新增] 添加可视化打印代码
-  // =========================================================
-  // 获取当前线程 ID
-  std::ostringstream ss;
-  ss << std::this_thread::get_id();
-  
-  // 打印格式：[Worker-线程ID] 处理主机: ServerA (分片: 0)
-  std::cout << "\033[1;33m" // 设置颜色为黄色，方便在刷屏中看清
-            << "[Worker-" << ss.str() << "] "
-            << "Processing Host: " << host_name 
-            << " | Shard Index: " << shard_idx 
-            << "\033[0m" << std::endl;
-  // =========================================================
-
-
-
-
-
-
+  // 2. 分片索引即当前消费线程的队列索引 (用于获取历史数据)
+  //    同一主机总是被路由到同一个队列，分片数据只会被一个线程访问
 
-
-  // 3. 计算评分
+  // 3. 计算评分；样本时间优先使用工作者的采集时刻，补传的历史数据据此落到正确的时间点
   double score = CalcScore(info);
-  auto now = std::chrono::system_clock::now();
+  auto sample_time = info.collect_time_ms() > 0
+                         ? std::chrono::system_clock::time_point(
+                               std::chrono::milliseconds(info.collect_time_ms()))
+                         : std::chrono::system_clock::now();
 
   // 4. 网络速率计算
   double net_in_rate = 0, net_out_rate = 0;
@@ -309,7 +521,9 @@ void HostManager::ProcessData(const monitor::proto::MonitorInfo& info) {
   curr.score = score;
 
   // 6. 获取历史数据并计算变化率 (使用 shard_idx 访问分片 Map，无锁)
-  PerfSample last = last_perf_samples_shards[shard_idx][host_name];
+  auto& last_samples = info.replayed() ? replayed_perf_samples_shards[shard_idx]
+                                       : last_perf_samples_shards[shard_idx];
+  PerfSample last = last_samples[host_name];
   
   auto rate = [](float now_val, float last_val) -> float {
     if (last_val == 0) return 0;
@@ -335,16 +549,23 @@ void HostManager::ProcessData(const monitor::proto::MonitorInfo& info) {
   float net_out_rate_rate = rate(curr.net_out_rate, last.net_out_rate);
 
   // 7. 更新历史数据
-  last_perf_samples_shards[shard_idx][host_name] = curr;
+  last_samples[host_name] = curr;
 
-  // 8. 更新实时内存表 (供查询用，需加锁)
+  // 8. 更新实时内存表 (供查询用，需加锁)，与入库阶段共享同一份上报；
+  //    补传的历史样本只入库，不覆盖更新的实时状态
+  HostScore host_score{info_ptr, score, sample_time};
   {
     std::lock_guard<std::mutex> lock(mtx_);
-    host_scores_[host_name] = HostScore{info, score, now};
+    auto it = host_scores_.find(host_name);
+    if (it == host_scores_.end()) {
+      if (!info.replayed()) host_scores_.emplace(host_name, host_score);
+    } else if (!info.replayed() || it->second.timestamp < sample_time) {
+      it->second = host_score;
+    }
   }
 
-  // 9. 写入 MySQL 数据库
-  WriteToMysql(host_name, HostScore{info, score, now}, net_in_rate, net_out_rate,
+  // 9. 生成入库数据，交给写库线程池
+  SubmitToStorage(shard_idx, host_name, host_score, net_in_rate, net_out_rate,
                cpu_percent_rate, usr_percent_rate, system_percent_rate,
                nice_percent_rate, idle_percent_rate, io_wait_percent_rate,
                irq_percent_rate, soft_irq_percent_rate, 0, 0, 0,
@@ -374,6 +595,28 @@ std::string HostManager::GetBestHost() {
   return best_host;
 }
 
+MysqlPoolStats HostManager::GetDbPoolStats() const {
+  return db_pool_ ? db_pool_->GetStats() : MysqlPoolStats{};
+}
+
+StoragePipelineStats HostManager::GetStorageStats() const {
+  return storage_ ? storage_->GetStats() : StoragePipelineStats{};
+}
+
+StageLatency HostManager::GetScoreLatency() const {
+  std::lock_guard<std::mutex> lock(score_latency_mtx_);
+  return score_latency_;
+}
+
+std::vector<size_t> HostManager::GetQueueDepths() const {
+  std::vector<size_t> depths;
+  depths.reserve(shards_.size());
+  for (const auto& shard : shards_) {
+    depths.push_back(shard->ring.Size() + shard->overflow_size.load());
+  }
+  return depths;
+}
+
 
 double HostManager::CalcScore(const monitor::proto::MonitorInfo& info) {
   // 简化的评分逻辑
@@ -419,8 +662,8 @@ double HostManager::CalcScore(const monitor::proto::MonitorInfo& info) {
   return score < 0 ? 0 : (score > 100 ? 100 : score);
 }
 
-void HostManager::WriteToMysql(
-    const std::string& host_name, const HostScore& host_score,
+void HostManager::SubmitToStorage(
+    size_t shard_idx, const std::string& host_name, const HostScore& host_score,
     double net_in_rate, double net_out_rate, float cpu_percent_rate,
     float usr_percent_rate, float system_percent_rate, float nice_percent_rate,
     float idle_percent_rate, float io_wait_percent_rate, float irq_percent_rate,
@@ -431,29 +674,11 @@ void HostManager::WriteToMysql(
     float mem_avail_rate, float net_in_rate_rate, float net_out_rate_rate,
     float net_in_drop_rate_rate, float net_out_drop_rate_rate) {
 #ifdef ENABLE_MYSQL
-  MYSQL* conn = mysql_init(NULL);
-  if (!conn) {
-    std::cerr << "mysql_init failed\n";
-    return;
-  }
-  
-  if (!mysql_real_connect(conn, host, user, password, database, 0, NULL, 0)) {
-    std::cerr << "mysql_real_connect failed: " << mysql_error(conn) << "\n";
-    mysql_close(conn);
-    return;
-  }
-
-  // 重新计算 shard_idx 以访问正确的分片数据
-  std::hash<std::string> hasher;
-  size_t shard_idx = hasher(host_name) % thread_count_;
-
-  std::time_t t = std::chrono::system_clock::to_time_t(host_score.timestamp);
-  std::tm tm_time;
-  localtime_r(&t, &tm_time);
-  char time_buf[32];
-  std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", &tm_time);
+  // 本次上报的所有行作为一个批次投递，由写库线程合并提交
+  std::vector<StorageRow> rows;
+  std::time_t ts = std::chrono::system_clock::to_time_t(host_score.timestamp);
 
-  const auto& info = host_score.info;
+  const auto& info = *host_score.info;
   auto rate = [](float now_val, float last_val) -> float {
     if (last_val == 0) return 0;
     return (now_val - last_val) / last_val;
@@ -467,6 +692,7 @@ void HostManager::WriteToMysql(
     float irq_percent = 0, soft_irq_percent = 0;
     float load_avg_1 = 0, load_avg_3 = 0, load_avg_15 = 0, mem_used_percent = 0;
     float disk_util_percent = 0;
+    WindowColumns cpu_window, disk_util_window, send_window, rcv_window;
 
     if (info.has_mem_info()) {
       total = info.mem_info().total();
@@ -475,8 +701,13 @@ void HostManager::WriteToMysql(
       mem_used_percent = info.mem_info().used_percent();
     }
     if (info.net_info_size() > 0) {
-      send_rate = info.net_info(0).send_rate() / 1024.0;
-      rcv_rate = info.net_info(0).rcv_rate() / 1024.0;
+      const auto& net = info.net_info(0);
+      send_rate = net.send_rate() / 1024.0;
+      rcv_rate = net.rcv_rate() / 1024.0;
+      send_window = Window(net.has_send_rate_agg(), net.send_rate_agg(),
+                           send_rate, 1.0 / 1024.0);
+      rcv_window = Window(net.has_rcv_rate_agg(), net.rcv_rate_agg(),
+                          rcv_rate, 1.0 / 1024.0);
     }
     if (info.cpu_stat_size() > 0) {
       const auto& cpu = info.cpu_stat(0);
@@ -488,15 +719,25 @@ void HostManager::WriteToMysql(
       io_wait_percent = cpu.io_wait_percent();
       irq_percent = cpu.irq_percent();
       soft_irq_percent = cpu.soft_irq_percent();
+      cpu_window = Window(cpu.has_cpu_percent_agg(), cpu.cpu_percent_agg(),
+                          cpu_percent);
     }
     if (info.has_cpu_load()) {
       load_avg_1 = info.cpu_load().load_avg_1();
       load_avg_3 = info.cpu_load().load_avg_3();
       load_avg_15 = info.cpu_load().load_avg_15();
     }
+    // 与 disk_util_percent 一样取各盘中的最大值，统计列逐项取最大
     for (int i = 0; i < info.disk_info_size(); ++i) {
-      float util = info.disk_info(i).util_percent();
+      const auto& disk = info.disk_info(i);
+      float util = disk.util_percent();
       if (util > disk_util_percent) disk_util_percent = util;
+      WindowColumns w = Window(disk.has_util_percent_agg(),
+                               disk.util_percent_agg(), util);
+      disk_util_window.min = std::max(disk_util_window.min, w.min);
+      disk_util_window.max = std::max(disk_util_window.max, w.max);
+      disk_util_window.avg = std::max(disk_util_window.avg, w.avg);
+      disk_util_window.p95 = std::max(disk_util_window.p95, w.p95);
     }
 
     // [改进] 使用 thread_local 来存储磁盘利用率历史，保证线程安全且无锁
@@ -509,41 +750,34 @@ void HostManager::WriteToMysql(
     }
     last_disk_util[host_name] = disk_util_percent;
 
-    std::ostringstream oss;
-    oss << "INSERT INTO server_performance "
-        << "(server_name, cpu_percent, usr_percent, system_percent, nice_percent, "
-        << "idle_percent, io_wait_percent, irq_percent, soft_irq_percent, "
-        << "load_avg_1, load_avg_3, load_avg_15, "
-        << "mem_used_percent, total, free, avail, "
-        << "disk_util_percent, send_rate, rcv_rate, score, "
-        << "cpu_percent_rate, usr_percent_rate, system_percent_rate, "
-        << "nice_percent_rate, idle_percent_rate, io_wait_percent_rate, "
-        << "irq_percent_rate, soft_irq_percent_rate, "
-        << "load_avg_1_rate, load_avg_3_rate, load_avg_15_rate, "
-        << "mem_used_percent_rate, total_rate, free_rate, avail_rate, "
-        << "disk_util_percent_rate, send_rate_rate, rcv_rate_rate, timestamp) VALUES ('"
-        << host_name << "',"
-        << cpu_percent << "," << usr_percent << "," << system_percent << ","
-        << nice_percent << "," << idle_percent << "," << io_wait_percent << ","
-        << irq_percent << "," << soft_irq_percent << ","
-        << load_avg_1 << "," << load_avg_3 << "," << load_avg_15 << ","
-        << mem_used_percent << "," << total << "," << free_mem << "," << avail << ","
-        << disk_util_percent << "," << send_rate << "," << rcv_rate << "," << host_score.score << ","
-        << cpu_percent_rate << "," << usr_percent_rate << "," << system_percent_rate << ","
-        << nice_percent_rate << "," << idle_percent_rate << "," << io_wait_percent_rate << ","
-        << irq_percent_rate << "," << soft_irq_percent_rate << ","
-        << load_avg_1_rate << "," << load_avg_3_rate << "," << load_avg_15_rate << ","
-        << mem_used_percent_rate << "," << mem_total_rate << "," << mem_free_rate << ","
-        << mem_avail_rate << "," << disk_util_percent_rate << ","
-        << net_in_rate_rate << "," << net_out_rate_rate
-        << ",'" << time_buf << "')";
-    mysql_query(conn, oss.str().c_str());
+    StorageRow row;
+    row.table = StorageTable::kPerformance;
+    row.server_name = host_name;
+    row.timestamp = ts;
+    row.SetFloats({
+        cpu_percent, usr_percent, system_percent, nice_percent,
+        idle_percent, io_wait_percent, irq_percent, soft_irq_percent,
+        load_avg_1, load_avg_3, load_avg_15,
+        mem_used_percent, total, free_mem, avail,
+        disk_util_percent, send_rate, rcv_rate, host_score.score,
+        cpu_percent_rate, usr_percent_rate, system_percent_rate,
+        nice_percent_rate, idle_percent_rate, io_wait_percent_rate,
+        irq_percent_rate, soft_irq_percent_rate,
+        load_avg_1_rate, load_avg_3_rate, load_avg_15_rate,
+        mem_used_percent_rate, mem_total_rate, mem_free_rate, mem_avail_rate,
+        disk_util_percent_rate, net_in_rate_rate, net_out_rate_rate,
+        cpu_window.min, cpu_window.max, cpu_window.avg, cpu_window.p95,
+        disk_util_window.min, disk_util_window.max,
+        disk_util_window.avg, disk_util_window.p95,
+        send_window.min, send_window.max, send_window.avg, send_window.p95,
+        rcv_window.min, rcv_window.max, rcv_window.avg, rcv_window.p95});
+    rows.push_back(std::move(row));
   }
 
   // 2. 写入网络详细表
   for (int i = 0; i < info.net_info_size(); ++i) {
     const auto& net = info.net_info(i);
-    std::string net_name = net.name();
+    const std::string& net_name = net.name();
     
     NetDetailSample curr;
     curr.rcv_bytes_rate = net.rcv_rate();
@@ -555,43 +789,54 @@ void HostManager::WriteToMysql(
     curr.drop_in = net.drop_in();
     curr.drop_out = net.drop_out();
 
-    NetDetailSample& last = last_net_samples_shards[shard_idx][host_name][net_name];
+    NetDetailSample& last = (info.replayed() ? replayed_net_samples_shards
+                                             : last_net_samples_shards)[shard_idx][host_name][net_name];
+    WindowColumns rcv_bytes = Window(net.has_rcv_rate_agg(), net.rcv_rate_agg(),
+                                     curr.rcv_bytes_rate);
+    WindowColumns rcv_packets =
+        Window(net.has_rcv_packets_rate_agg(), net.rcv_packets_rate_agg(),
+               curr.rcv_packets_rate);
+    WindowColumns snd_bytes = Window(net.has_send_rate_agg(),
+                                     net.send_rate_agg(), curr.snd_bytes_rate);
+    WindowColumns snd_packets =
+        Window(net.has_send_packets_rate_agg(), net.send_packets_rate_agg(),
+               curr.snd_packets_rate);
     
     auto rate_u64 = [](uint64_t now_val, uint64_t last_val) -> float {
       if (last_val == 0) return 0;
       return static_cast<float>(now_val - last_val) / static_cast<float>(last_val);
     };
     
-    std::ostringstream oss;
-    oss << "INSERT INTO server_net_detail "
-        << "(server_name, net_name, err_in, err_out, drop_in, drop_out, "
-        << "rcv_bytes_rate, rcv_packets_rate, snd_bytes_rate, snd_packets_rate, "
-        << "rcv_bytes_rate_rate, rcv_packets_rate_rate, "
-        << "snd_bytes_rate_rate, snd_packets_rate_rate, "
-        << "err_in_rate, err_out_rate, drop_in_rate, drop_out_rate, "
-        << "timestamp) VALUES ('"
-        << host_name << "','" << net_name << "',"
-        << curr.err_in << "," << curr.err_out << ","
-        << curr.drop_in << "," << curr.drop_out << ","
-        << curr.rcv_bytes_rate << "," << curr.rcv_packets_rate << ","
-        << curr.snd_bytes_rate << "," << curr.snd_packets_rate << ","
-        << rate(curr.rcv_bytes_rate, last.rcv_bytes_rate) << ","
-        << rate(curr.rcv_packets_rate, last.rcv_packets_rate) << ","
-        << rate(curr.snd_bytes_rate, last.snd_bytes_rate) << ","
-        << rate(curr.snd_packets_rate, last.snd_packets_rate) << ","
-        << rate_u64(curr.err_in, last.err_in) << ","
-        << rate_u64(curr.err_out, last.err_out) << ","
-        << rate_u64(curr.drop_in, last.drop_in) << ","
-        << rate_u64(curr.drop_out, last.drop_out)
-        << ",'" << time_buf << "')";
-    mysql_query(conn, oss.str().c_str());
+    StorageRow row;
+    row.table = StorageTable::kNetDetail;
+    row.server_name = host_name;
+    row.sub_name = net_name;
+    row.timestamp = ts;
+    row.SetInts({static_cast<int64_t>(curr.err_in), static_cast<int64_t>(curr.err_out),
+                 static_cast<int64_t>(curr.drop_in), static_cast<int64_t>(curr.drop_out)});
+    row.SetFloats({
+        curr.rcv_bytes_rate, curr.rcv_packets_rate,
+        curr.snd_bytes_rate, curr.snd_packets_rate,
+        rate(curr.rcv_bytes_rate, last.rcv_bytes_rate),
+        rate(curr.rcv_packets_rate, last.rcv_packets_rate),
+        rate(curr.snd_bytes_rate, last.snd_bytes_rate),
+        rate(curr.snd_packets_rate, last.snd_packets_rate),
+        rate_u64(curr.err_in, last.err_in),
+        rate_u64(curr.err_out, last.err_out),
+        rate_u64(curr.drop_in, last.drop_in),
+        rate_u64(curr.drop_out, last.drop_out),
+        rcv_bytes.min, rcv_bytes.max, rcv_bytes.avg, rcv_bytes.p95,
+        rcv_packets.min, rcv_packets.max, rcv_packets.avg, rcv_packets.p95,
+        snd_bytes.min, snd_bytes.max, snd_bytes.avg, snd_bytes.p95,
+        snd_packets.min, snd_packets.max, snd_packets.avg, snd_packets.p95});
+    rows.push_back(std::move(row));
     last = curr;
   }
 
   // 3. 写入软中断详细表
   for (int i = 0; i < info.soft_irq_size(); ++i) {
     const auto& sirq = info.soft_irq(i);
-    std::string cpu_name = sirq.cpu();
+    const std::string& cpu_name = sirq.cpu();
     
     SoftIrqSample curr;
     curr.hi = sirq.hi();
@@ -605,27 +850,32 @@ void HostManager::WriteToMysql(
     curr.hrtimer = sirq.hrtimer();
     curr.rcu = sirq.rcu();
 
-    SoftIrqSample& last = last_softirq_samples_shards[shard_idx][host_name][cpu_name];
+    SoftIrqSample& last = (info.replayed() ? replayed_softirq_samples_shards
+                                           : last_softirq_samples_shards)[shard_idx][host_name][cpu_name];
+    WindowColumns net_tx = Window(sirq.has_net_tx_agg(), sirq.net_tx_agg(),
+                                  curr.net_tx);
+    WindowColumns net_rx = Window(sirq.has_net_rx_agg(), sirq.net_rx_agg(),
+                                  curr.net_rx);
     
-    std::ostringstream oss;
-    oss << "INSERT INTO server_softirq_detail "
-        << "(server_name, cpu_name, hi, timer, net_tx, net_rx, block, "
-        << "irq_poll, tasklet, sched, hrtimer, rcu, "
-        << "hi_rate, timer_rate, net_tx_rate, net_rx_rate, block_rate, "
-        << "irq_poll_rate, tasklet_rate, sched_rate, hrtimer_rate, rcu_rate, "
-        << "timestamp) VALUES ('"
-        << host_name << "','" << cpu_name << "',"
-        << curr.hi << "," << curr.timer << "," << curr.net_tx << ","
-        << curr.net_rx << "," << curr.block << "," << curr.irq_poll << ","
-        << curr.tasklet << "," << curr.sched << "," << curr.hrtimer << ","
-        << curr.rcu << ","
-        << rate(curr.hi, last.hi) << "," << rate(curr.timer, last.timer) << ","
-        << rate(curr.net_tx, last.net_tx) << "," << rate(curr.net_rx, last.net_rx) << ","
-        << rate(curr.block, last.block) << "," << rate(curr.irq_poll, last.irq_poll) << ","
-        << rate(curr.tasklet, last.tasklet) << "," << rate(curr.sched, last.sched) << ","
-        << rate(curr.hrtimer, last.hrtimer) << "," << rate(curr.rcu, last.rcu)
-        << ",'" << time_buf << "')";
-    mysql_query(conn, oss.str().c_str());
+    StorageRow row;
+    row.table = StorageTable::kSoftIrqDetail;
+    row.server_name = host_name;
+    row.sub_name = cpu_name;
+    row.timestamp = ts;
+    row.SetInts({std::llround(curr.hi), std::llround(curr.timer),
+                 std::llround(curr.net_tx), std::llround(curr.net_rx),
+                 std::llround(curr.block), std::llround(curr.irq_poll),
+                 std::llround(curr.tasklet), std::llround(curr.sched),
+                 std::llround(curr.hrtimer), std::llround(curr.rcu)});
+    row.SetFloats({
+        rate(curr.hi, last.hi), rate(curr.timer, last.timer),
+        rate(curr.net_tx, last.net_tx), rate(curr.net_rx, last.net_rx),
+        rate(curr.block, last.block), rate(curr.irq_poll, last.irq_poll),
+        rate(curr.tasklet, last.tasklet), rate(curr.sched, last.sched),
+        rate(curr.hrtimer, last.hrtimer), rate(curr.rcu, last.rcu),
+        net_tx.min, net_tx.max, net_tx.avg, net_tx.p95,
+        net_rx.min, net_rx.max, net_rx.avg, net_rx.p95});
+    rows.push_back(std::move(row));
     last = curr;
   }
 
@@ -643,45 +893,37 @@ void HostManager::WriteToMysql(
     curr.kreclaimable = mem.kreclaimable(); curr.sreclaimable = mem.sreclaimable();
     curr.sunreclaim = mem.sunreclaim();
 
-    MemDetailSample& last = last_mem_samples_shards[shard_idx][host_name];
+    MemDetailSample& last = (info.replayed() ? replayed_mem_samples_shards
+                                             : last_mem_samples_shards)[shard_idx][host_name];
     
-    std::ostringstream oss;
-    oss << "INSERT INTO server_mem_detail "
-        << "(server_name, total, free, avail, buffers, cached, swap_cached, "
-        << "active, inactive, active_anon, inactive_anon, active_file, inactive_file, "
-        << "dirty, writeback, anon_pages, mapped, kreclaimable, sreclaimable, sunreclaim, "
-        << "total_rate, free_rate, avail_rate, buffers_rate, cached_rate, swap_cached_rate, "
-        << "active_rate, inactive_rate, active_anon_rate, inactive_anon_rate, "
-        << "active_file_rate, inactive_file_rate, dirty_rate, writeback_rate, "
-        << "anon_pages_rate, mapped_rate, kreclaimable_rate, sreclaimable_rate, "
-        << "sunreclaim_rate, timestamp) VALUES ('"
-        << host_name << "',"
-        << curr.total << "," << curr.free << "," << curr.avail << ","
-        << curr.buffers << "," << curr.cached << "," << curr.swap_cached << ","
-        << curr.active << "," << curr.inactive << "," << curr.active_anon << ","
-        << curr.inactive_anon << "," << curr.active_file << "," << curr.inactive_file << ","
-        << curr.dirty << "," << curr.writeback << "," << curr.anon_pages << ","
-        << curr.mapped << "," << curr.kreclaimable << "," << curr.sreclaimable << ","
-        << curr.sunreclaim << ","
-        << rate(curr.total, last.total) << "," << rate(curr.free, last.free) << ","
-        << rate(curr.avail, last.avail) << "," << rate(curr.buffers, last.buffers) << ","
-        << rate(curr.cached, last.cached) << "," << rate(curr.swap_cached, last.swap_cached) << ","
-        << rate(curr.active, last.active) << "," << rate(curr.inactive, last.inactive) << ","
-        << rate(curr.active_anon, last.active_anon) << "," << rate(curr.inactive_anon, last.inactive_anon) << ","
-        << rate(curr.active_file, last.active_file) << "," << rate(curr.inactive_file, last.inactive_file) << ","
-        << rate(curr.dirty, last.dirty) << "," << rate(curr.writeback, last.writeback) << ","
-        << rate(curr.anon_pages, last.anon_pages) << "," << rate(curr.mapped, last.mapped) << ","
-        << rate(curr.kreclaimable, last.kreclaimable) << "," << rate(curr.sreclaimable, last.sreclaimable) << ","
-        << rate(curr.sunreclaim, last.sunreclaim)
-        << ",'" << time_buf << "')";
-    mysql_query(conn, oss.str().c_str());
+    StorageRow row;
+    row.table = StorageTable::kMemDetail;
+    row.server_name = host_name;
+    row.timestamp = ts;
+    row.SetFloats({
+        curr.total, curr.free, curr.avail, curr.buffers, curr.cached,
+        curr.swap_cached, curr.active, curr.inactive, curr.active_anon,
+        curr.inactive_anon, curr.active_file, curr.inactive_file,
+        curr.dirty, curr.writeback, curr.anon_pages, curr.mapped,
+        curr.kreclaimable, curr.sreclaimable, curr.sunreclaim,
+        rate(curr.total, last.total), rate(curr.free, last.free),
+        rate(curr.avail, last.avail), rate(curr.buffers, last.buffers),
+        rate(curr.cached, last.cached), rate(curr.swap_cached, last.swap_cached),
+        rate(curr.active, last.active), rate(curr.inactive, last.inactive),
+        rate(curr.active_anon, last.active_anon), rate(curr.inactive_anon, last.inactive_anon),
+        rate(curr.active_file, last.active_file), rate(curr.inactive_file, last.inactive_file),
+        rate(curr.dirty, last.dirty), rate(curr.writeback, last.writeback),
+        rate(curr.anon_pages, last.anon_pages), rate(curr.mapped, last.mapped),
+        rate(curr.kreclaimable, last.kreclaimable), rate(curr.sreclaimable, last.sreclaimable),
+        rate(curr.sunreclaim, last.sunreclaim)});
+    rows.push_back(std::move(row));
     last = curr;
   }
 
   // 5. 写入磁盘详细表
   for (int i = 0; i < info.disk_info_size(); ++i) {
     const auto& disk = info.disk_info(i);
-    std::string disk_name = disk.name();
+    const std::string& disk_name = disk.name();
     
     DiskDetailSample curr;
     curr.read_bytes_per_sec = disk.read_bytes_per_sec();
@@ -692,45 +934,54 @@ void HostManager::WriteToMysql(
     curr.avg_write_latency_ms = disk.avg_write_latency_ms();
     curr.util_percent = disk.util_percent();
 
-    DiskDetailSample& last = last_disk_samples_shards[shard_idx][host_name][disk_name];
+    DiskDetailSample& last = (info.replayed() ? replayed_disk_samples_shards
+                                              : last_disk_samples_shards)[shard_idx][host_name][disk_name];
+    WindowColumns read_bytes =
+        Window(disk.has_read_bytes_per_sec_agg(), disk.read_bytes_per_sec_agg(),
+               curr.read_bytes_per_sec);
+    WindowColumns write_bytes =
+        Window(disk.has_write_bytes_per_sec_agg(),
+               disk.write_bytes_per_sec_agg(), curr.write_bytes_per_sec);
+    WindowColumns util = Window(disk.has_util_percent_agg(),
+                                disk.util_percent_agg(), curr.util_percent);
     
-    std::ostringstream oss;
-    oss << "INSERT INTO server_disk_detail "
-        << "(server_name, disk_name, reads, writes, sectors_read, sectors_written, "
-        << "read_time_ms, write_time_ms, io_in_progress, io_time_ms, weighted_io_time_ms, "
-        << "read_bytes_per_sec, write_bytes_per_sec, read_iops, write_iops, "
-        << "avg_read_latency_ms, avg_write_latency_ms, util_percent, "
-        << "read_bytes_per_sec_rate, write_bytes_per_sec_rate, read_iops_rate, write_iops_rate, "
-        << "avg_read_latency_ms_rate, avg_write_latency_ms_rate, util_percent_rate, "
-        << "timestamp) VALUES ('"
-        << host_name << "','" << disk_name << "',"
-        << disk.reads() << "," << disk.writes() << ","
-        << disk.sectors_read() << "," << disk.sectors_written() << ","
-        << disk.read_time_ms() << "," << disk.write_time_ms() << ","
-        << disk.io_in_progress() << "," << disk.io_time_ms() << ","
-        << disk.weighted_io_time_ms() << ","
-        << curr.read_bytes_per_sec << "," << curr.write_bytes_per_sec << ","
-        << curr.read_iops << "," << curr.write_iops << ","
-        << curr.avg_read_latency_ms << "," << curr.avg_write_latency_ms << ","
-        << curr.util_percent << ","
-        << rate(curr.read_bytes_per_sec, last.read_bytes_per_sec) << ","
-        << rate(curr.write_bytes_per_sec, last.write_bytes_per_sec) << ","
-        << rate(curr.read_iops, last.read_iops) << ","
-        << rate(curr.write_iops, last.write_iops) << ","
-        << rate(curr.avg_read_latency_ms, last.avg_read_latency_ms) << ","
-        << rate(curr.avg_write_latency_ms, last.avg_write_latency_ms) << ","
-        << rate(curr.util_percent, last.util_percent)
-        << ",'" << time_buf << "')";
-    mysql_query(conn, oss.str().c_str());
+    StorageRow row;
+    row.table = StorageTable::kDiskDetail;
+    row.server_name = host_name;
+    row.sub_name = disk_name;
+    row.timestamp = ts;
+    row.SetInts({static_cast<int64_t>(disk.reads()), static_cast<int64_t>(disk.writes()),
+                 static_cast<int64_t>(disk.sectors_read()), static_cast<int64_t>(disk.sectors_written()),
+                 static_cast<int64_t>(disk.read_time_ms()), static_cast<int64_t>(disk.write_time_ms()),
+                 static_cast<int64_t>(disk.io_in_progress()), static_cast<int64_t>(disk.io_time_ms()),
+                 static_cast<int64_t>(disk.weighted_io_time_ms())});
+    row.SetFloats({
+        curr.read_bytes_per_sec, curr.write_bytes_per_sec,
+        curr.read_iops, curr.write_iops,
+        curr.avg_read_latency_ms, curr.avg_write_latency_ms,
+        curr.util_percent,
+        rate(curr.read_bytes_per_sec, last.read_bytes_per_sec),
+        rate(curr.write_bytes_per_sec, last.write_bytes_per_sec),
+        rate(curr.read_iops, last.read_iops),
+        rate(curr.write_iops, last.write_iops),
+        rate(curr.avg_read_latency_ms, last.avg_read_latency_ms),
+        rate(curr.avg_write_latency_ms, last.avg_write_latency_ms),
+        rate(curr.util_percent, last.util_percent),
+        read_bytes.min, read_bytes.max, read_bytes.avg, read_bytes.p95,
+        write_bytes.min, write_bytes.max, write_bytes.avg, write_bytes.p95,
+        util.min, util.max, util.avg, util.p95});
+    rows.push_back(std::move(row));
     last = curr;
   }
 
-  mysql_close(conn);
+  if (storage_) {
+    storage_->Submit(std::move(rows));
+  }
 #else
   // 防止未使用变量警告
-  (void)host_name; (void)host_score; (void)net_in_rate;
+  (void)shard_idx; (void)host_name; (void)host_score; (void)net_in_rate;
   // ... 其他变量 ...
 #endif
 }
 
-}  // namespace monitor
\ No newline at end of file
+}  // namespace monitor
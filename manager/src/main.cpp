@@ -1,13 +1,16 @@
 #include <grpc/grpc.h>
 #include <grpcpp/server_builder.h>
+#include <signal.h>
 
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <thread>
 
 #include "host_manager.h"
 #include "query_manager.h"
+#include "rpc/async_ingest_server.h"
 #include "rpc/grpc_server.h"
 #include "rpc/query_service.h"
 
@@ -21,16 +24,36 @@ const char* database = "monitor_db";
 
 constexpr char kDefaultListenAddress[] = "0.0.0.0:50051";
 
+// 查询类同步接口的轮询线程上限（推送走异步接收服务，不占用同步线程）
+constexpr int kMaxSyncPollers = 2;
+// 允许工作者 keepalive ping 的最小间隔，需小于工作者侧的 keepalive 周期
+constexpr int kMinKeepalivePingIntervalMs = 20000;
+// 退出时等待在途调用完成的时间；推送流是长连接，到点后被取消
+constexpr auto kShutdownGrace = std::chrono::seconds(5);
+
 int main(int argc, char* argv[]) {
   std::string listen_address = kDefaultListenAddress;
+  monitor::AsyncIngestOptions ingest_options;
 
-  // 解析命令行参数
+  // 解析命令行参数: [listen_address] [ingest_threads]
   if (argc > 1) {
     listen_address = argv[1];
   }
+  if (argc > 2) {
+    int threads = std::atoi(argv[2]);
+    if (threads > 0) ingest_options.thread_count = threads;
+  }
+
+  // 在创建任何线程之前屏蔽 SIGINT / SIGTERM，由主线程 sigwait 后有序退出
+  sigset_t stop_signals;
+  sigemptyset(&stop_signals);
+  sigaddset(&stop_signals, SIGINT);
+  sigaddset(&stop_signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
 
   std::cout << "Starting Monitor Client (Manager Mode)..." << std::endl;
   std::cout << "Listening on: " << listen_address << std::endl;
+  std::cout << "Ingest threads: " << ingest_options.thread_count << std::endl;
 
   // 创建 gRPC 服务
   monitor::GrpcServerImpl service;
@@ -38,9 +61,10 @@ int main(int argc, char* argv[]) {
   // 创建 HostManager 并设置回调
   monitor::HostManager mgr;
   service.SetDataReceivedCallback(
-      [&mgr](const monitor::proto::MonitorInfo& info) {
-        mgr.OnDataReceived(info);
+      [&mgr](monitor::MonitorInfoPtr info) {
+        return mgr.OnDataReceived(std::move(info));
       });
+  service.SetRetryAfterHint(mgr.RetryAfterHint());
 
   // 启动 HostManager 后台处理
   mgr.Start();
@@ -65,13 +89,31 @@ int main(int argc, char* argv[]) {
   builder.AddListeningPort(listen_address, grpc::InsecureServerCredentials());
   builder.RegisterService(&service);
   builder.RegisterService(&query_service);
+  builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::MAX_POLLERS,
+                              kMaxSyncPollers);
+  // 工作者的推送流是长连接，允许其发送 keepalive ping 探测断链
+  builder.AddChannelArgument(GRPC_ARG_HTTP2_MIN_RECV_PING_INTERVAL_WITHOUT_DATA_MS,
+                             kMinKeepalivePingIntervalMs);
+
+  // SetMonitorInfo / StreamMonitorInfo 由异步接收服务在固定数量的轮询线程上处理
+  monitor::AsyncIngestServer ingest(&service, ingest_options);
+  ingest.AddCompletionQueues(&builder);
 
   std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
+  ingest.Start();
   std::cout << "Monitor Client listening on " << listen_address << std::endl;
   std::cout << "Waiting for workers to push data..." << std::endl;
   std::cout << "Query service available for performance data queries" << std::endl;
 
+  int sig = 0;
+  sigwait(&stop_signals, &sig);
+  std::cout << "Received signal " << sig << ", shutting down..." << std::endl;
+
+  // 先让服务器在 deadline 内处理完在途调用（到点取消推送流），
+  // 再关闭异步接收服务的完成队列（见 async_ingest_server.h）
+  server->Shutdown(std::chrono::system_clock::now() + kShutdownGrace);
   server->Wait();
+  ingest.Shutdown();
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include "rpc/async_ingest_server.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace monitor {
+
+// 完成队列上的 tag 统一指向 Operation
+class AsyncIngestServer::Operation {
+ public:
+  virtual ~Operation() = default;
+  // ok 为 false 表示调用被取消或完成队列正在关闭
+  virtual void Proceed(bool ok) = 0;
+};
+
+template <typename F>
+bool AsyncIngestServer::RunIfActive(F&& start) {
+  std::lock_guard<std::mutex> lock(shutdown_mtx_);
+  if (shutting_down_) {
+    return false;
+  }
+  start();
+  return true;
+}
+
+void AsyncIngestServer::CountResult(IngestResult result) {
+  calls_.fetch_add(1, std::memory_order_relaxed);
+  if (result == IngestResult::kRejected) {
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+  } else if (result == IngestResult::kInvalid) {
+    invalid_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// 一次 SetMonitorInfo 调用的状态机：
+//   kPending  已挂起，等待请求到达
+//   kFinishing 已回复，等待 Finish 完成后释放
+class AsyncIngestServer::CallData : public AsyncIngestServer::Operation {
+ public:
+  CallData(AsyncIngestServer* owner, grpc::ServerCompletionQueue* cq)
+      : owner_(owner), cq_(cq), request_(NewMonitorInfo()), responder_(&ctx_) {
+    owner_->service_->RequestSetMonitorInfo(&ctx_, request_.get(), &responder_,
+                                            cq_, cq_, Tag());
+  }
+
+  void Proceed(bool ok) override {
+    if (state_ == State::kFinishing || !ok) {
+      delete this;
+      return;
+    }
+
+    // 先挂起下一个调用，保证队列上待接收的调用数不变
+    owner_->RunIfActive([this] { new CallData(owner_, cq_); });
+
+    grpc::Status status =
+        owner_->service_->HandleMonitorInfo(&ctx_, std::move(request_));
+    if (status.error_code() == grpc::StatusCode::RESOURCE_EXHAUSTED) {
+      owner_->CountResult(IngestResult::kRejected);
+    } else if (status.error_code() == grpc::StatusCode::INVALID_ARGUMENT) {
+      owner_->CountResult(IngestResult::kInvalid);
+    } else {
+      owner_->CountResult(IngestResult::kAccepted);
+    }
+
+    state_ = State::kFinishing;
+    bool started = owner_->RunIfActive([this, &status] {
+      if (status.ok()) {
+        responder_.Finish(response_, status, Tag());
+      } else {
+        responder_.FinishWithError(status, Tag());
+      }
+    });
+    if (!started) {
+      delete this;
+    }
+  }
+
+ private:
+  enum class State { kPending, kFinishing };
+
+  void* Tag() { return static_cast<Operation*>(this); }
+
+  AsyncIngestServer* owner_;
+  grpc::ServerCompletionQueue* cq_;
+  grpc::ServerContext ctx_;
+  // 请求直接反序列化到 Arena 句柄中，处理后移交下游
+  std::shared_ptr<monitor::proto::MonitorInfo> request_;
+  google::protobuf::Empty response_;
+  grpc::ServerAsyncResponseWriter<google::protobuf::Empty> responder_;
+  State state_ = State::kPending;
+};
+
+// 一次 Backfill 调用：批次整体反序列化到一个 Arena 上，逐条以别名句柄交给 Ingest
+class AsyncIngestServer::BackfillCall : public AsyncIngestServer::Operation {
+ public:
+  BackfillCall(AsyncIngestServer* owner, grpc::ServerCompletionQueue* cq)
+      : owner_(owner), cq_(cq), request_(NewMonitorInfoBatch()), responder_(&ctx_) {
+    owner_->service_->RequestBackfill(&ctx_, request_.get(), &responder_, cq_,
+                                      cq_, Tag());
+  }
+
+  void Proceed(bool ok) override {
+    if (finishing_ || !ok) {
+      delete this;
+      return;
+    }
+
+    owner_->RunIfActive([this] { new BackfillCall(owner_, cq_); });
+
+    monitor::proto::BackfillAck ack = owner_->service_->IngestBackfill(request_);
+    request_.reset();
+    owner_->backfilled_.fetch_add(ack.accepted(), std::memory_order_relaxed);
+
+    finishing_ = true;
+    if (!owner_->RunIfActive(
+            [this, &ack] { responder_.Finish(ack, grpc::Status::OK, Tag()); })) {
+      delete this;
+    }
+  }
+
+ private:
+  void* Tag() { return static_cast<Operation*>(this); }
+
+  AsyncIngestServer* owner_;
+  grpc::ServerCompletionQueue* cq_;
+  grpc::ServerContext ctx_;
+  std::shared_ptr<monitor::proto::MonitorInfoBatch> request_;
+  grpc::ServerAsyncResponseWriter<monitor::proto::BackfillAck> responder_;
+  bool finishing_ = false;
+};
+
+// 一条 StreamMonitorInfo 推送流。连接、读、写、结束各用一个 tag，
+// 同一条流的所有事件都在同一个完成队列（同一个轮询线程）上处理，无需加锁；
+// 在途操作计数归零且流已结束时释放
+class AsyncIngestServer::StreamCall {
+ public:
+  StreamCall(AsyncIngestServer* owner, grpc::ServerCompletionQueue* cq)
+      : owner_(owner), cq_(cq), stream_(&ctx_) {
+    ++pending_;
+    owner_->service_->RequestStreamMonitorInfo(&ctx_, &stream_, cq_, cq_,
+                                               &connect_tag_);
+  }
+
+ private:
+  enum class Op { kConnect, kRead, kWrite, kFinish };
+
+  struct OpTag : public Operation {
+    OpTag(StreamCall* call, Op op) : call(call), op(op) {}
+    void Proceed(bool ok) override { call->OnEvent(op, ok); }
+    StreamCall* call;
+    Op op;
+  };
+
+  void OnEvent(Op op, bool ok) {
+    --pending_;
+    switch (op) {
+      case Op::kConnect:
+        if (ok) {
+          connected_ = true;
+          owner_->streams_opened_.fetch_add(1, std::memory_order_relaxed);
+          owner_->streams_active_.fetch_add(1, std::memory_order_relaxed);
+          owner_->RunIfActive([this] { new StreamCall(owner_, cq_); });
+          StartRead();
+        }
+        break;
+      case Op::kRead:
+        if (ok) {
+          OnMessage();
+          StartRead();
+        } else {
+          // 工作者关闭了写端，或连接已断开
+          read_done_ = true;
+        }
+        break;
+      case Op::kWrite:
+        writing_ = false;
+        if (!ok) {
+          write_failed_ = true;
+        } else if (ack_due_) {
+          SendAck();
+        }
+        break;
+      case Op::kFinish:
+        finished_ = true;
+        break;
+    }
+
+    // 结束前补发最后一个回执，工作者据此确认流上的全部上报都已送达
+    if (read_done_ && !writing_ && !finishing_ && received_ > acked_received_) {
+      SendAck();
+    }
+    if (read_done_ && !writing_ && !finishing_) {
+      finishing_ = true;
+      if (StartOp([this] { stream_.Finish(grpc::Status::OK, &finish_tag_); })) {
+        ++pending_;
+      }
+    }
+
+    if (pending_ == 0) {
+      if (connected_) {
+        owner_->streams_active_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      delete this;
+    }
+  }
+
+  void StartRead() {
+    request_ = NewMonitorInfo();
+    if (StartOp([this] { stream_.Read(request_.get(), &read_tag_); })) {
+      ++pending_;
+    } else {
+      read_done_ = true;
+    }
+  }
+
+  void OnMessage() {
+    IngestResult result = owner_->service_->Ingest(std::move(request_));
+    owner_->CountResult(result);
+    ++received_;
+    if (result == IngestResult::kRejected) {
+      ++rejected_;
+    }
+
+    // 被拒绝时立即回执，让工作者尽快退避；否则按间隔合并回执
+    auto now = std::chrono::steady_clock::now();
+    if (result == IngestResult::kRejected ||
+        now - last_ack_ >= owner_->options_.ack_interval) {
+      ack_due_ = true;
+      if (!writing_) SendAck();
+    }
+  }
+
+  void SendAck() {
+    if (write_failed_ || finishing_) return;
+    ack_.set_received(received_);
+    ack_.set_rejected(rejected_);
+    ack_.set_retry_after_ms(
+        rejected_ > rejected_at_last_ack_
+            ? static_cast<uint32_t>(owner_->service_->RetryAfterHint().count())
+            : 0);
+    if (StartOp([this] { stream_.Write(ack_, &write_tag_); })) {
+      ++pending_;
+      writing_ = true;
+      ack_due_ = false;
+      rejected_at_last_ack_ = rejected_;
+      acked_received_ = received_;
+      last_ack_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  template <typename F>
+  bool StartOp(F&& start) {
+    return owner_->RunIfActive(std::forward<F>(start));
+  }
+
+  AsyncIngestServer* owner_;
+  grpc::ServerCompletionQueue* cq_;
+  grpc::ServerContext ctx_;
+  grpc::ServerAsyncReaderWriter<monitor::proto::PushAck, monitor::proto::MonitorInfo> stream_;
+
+  OpTag connect_tag_{this, Op::kConnect};
+  OpTag read_tag_{this, Op::kRead};
+  OpTag write_tag_{this, Op::kWrite};
+  OpTag finish_tag_{this, Op::kFinish};
+
+  std::shared_ptr<monitor::proto::MonitorInfo> request_;
+  monitor::proto::PushAck ack_;
+
+  int pending_ = 0;  // 在途操作数
+  bool connected_ = false;
+  bool read_done_ = false;
+  bool writing_ = false;
+  bool write_failed_ = false;
+  bool ack_due_ = false;
+  bool finishing_ = false;
+  bool finished_ = false;
+
+  uint64_t received_ = 0;
+  uint64_t rejected_ = 0;
+  uint64_t rejected_at_last_ack_ = 0;
+  uint64_t acked_received_ = 0;
+  std::chrono::steady_clock::time_point last_ack_;
+};
+
+AsyncIngestServer::AsyncIngestServer(GrpcServerImpl* service,
+                                     const AsyncIngestOptions& options)
+    : service_(service), options_(options) {
+  options_.thread_count = std::max<size_t>(options_.thread_count, 1);
+  options_.calls_per_queue = std::max<size_t>(options_.calls_per_queue, 1);
+  options_.streams_per_queue = std::max<size_t>(options_.streams_per_queue, 1);
+}
+
+AsyncIngestServer::~AsyncIngestServer() { Shutdown(); }
+
+void AsyncIngestServer::AddCompletionQueues(grpc::ServerBuilder* builder) {
+  for (size_t i = 0; i < options_.thread_count; ++i) {
+    cqs_.push_back(builder->AddCompletionQueue());
+  }
+}
+
+void AsyncIngestServer::Start() {
+  if (started_) return;
+  started_ = true;
+  shutting_down_ = false;
+  for (auto& cq : cqs_) {
+    for (size_t i = 0; i < options_.calls_per_queue; ++i) {
+      new CallData(this, cq.get());
+    }
+    for (size_t i = 0; i < options_.streams_per_queue; ++i) {
+      new StreamCall(this, cq.get());
+    }
+    new BackfillCall(this, cq.get());
+  }
+  for (auto& cq : cqs_) {
+    threads_.emplace_back([this, q = cq.get()] { PollLoop(q); });
+  }
+}
+
+void AsyncIngestServer::Shutdown() {
+  if (!started_) return;
+  started_ = false;
+  {
+    std::lock_guard<std::mutex> lock(shutdown_mtx_);
+    shutting_down_ = true;
+  }
+  // Server::Shutdown 之后挂起的调用都会以 ok=false 返回，由 PollLoop 逐个释放
+  for (auto& cq : cqs_) {
+    cq->Shutdown();
+  }
+  for (auto& t : threads_) {
+    if (t.joinable()) t.join();
+  }
+  threads_.clear();
+}
+
+void AsyncIngestServer::PollLoop(grpc::ServerCompletionQueue* cq) {
+  void* tag = nullptr;
+  bool ok = false;
+  // Next 返回 false 表示队列已关闭且取空
+  while (cq->Next(&tag, &ok)) {
+    static_cast<Operation*>(tag)->Proceed(ok);
+  }
+}
+
+AsyncIngestStats AsyncIngestServer::GetStats() const {
+  AsyncIngestStats stats;
+  stats.calls = calls_.load(std::memory_order_relaxed);
+  stats.rejected = rejected_.load(std::memory_order_relaxed);
+  stats.invalid = invalid_.load(std::memory_order_relaxed);
+  stats.streams_opened = streams_opened_.load(std::memory_order_relaxed);
+  stats.streams_active = streams_active_.load(std::memory_order_relaxed);
+  stats.backfilled = backfilled_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace monitor
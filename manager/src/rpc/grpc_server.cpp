@@ -1,41 +1,72 @@
 #include "rpc/grpc_server.h"
 
-#include <iostream>
+#include <string>
 
 namespace monitor {
 
-::grpc::Status GrpcServerImpl::SetMonitorInfo(
-    ::grpc::ServerContext* context,
-    const ::monitor::proto::MonitorInfo* request,
-    ::google::protobuf::Empty* response) 
-{
-  if (!request) {
-    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Empty request");
+IngestResult GrpcServerImpl::Ingest(MonitorInfoPtr info) {
+  if (!info) {
+    return IngestResult::kInvalid;
   }
 
-  std::string hostname = request->name();
-  if (hostname.empty() && request->has_host_info()) {
-    hostname = request->host_info().hostname();
+  const std::string* hostname = &info->name();
+  if (hostname->empty() && info->has_host_info()) {
+    hostname = &info->host_info().hostname();
   }
 
-  if (hostname.empty()) {
-    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Missing hostname");
+  if (hostname->empty()) {
+    return IngestResult::kInvalid;
   }
 
-  // 存储数据
-  {
-    std::lock_guard<std::mutex> lock(mtx_);
-    host_data_[hostname] = {*request, std::chrono::system_clock::now()};
+  // 记录最新数据（只按主机名所在分段加锁），补传的历史样本不覆盖
+  if (!info->replayed()) {
+    HostDataShard& shard = ShardFor(*hostname);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    HostData& entry = shard.data[*hostname];
+    entry.info = info;
+    entry.timestamp = std::chrono::system_clock::now();
   }
 
-  std::cout << "Received monitor data from: " << hostname << std::endl;
+  // 调用回调函数；分片饱和时通知工作者退避，而不是继续堆积
+  if (callback_ && !callback_(std::move(info))) {
+    return IngestResult::kRejected;
+  }
+  return IngestResult::kAccepted;
+}
 
-  // 调用回调函数
-  if (callback_) {
-    callback_(*request);
+monitor::proto::BackfillAck GrpcServerImpl::IngestBackfill(
+    const std::shared_ptr<monitor::proto::MonitorInfoBatch>& batch) {
+  monitor::proto::BackfillAck ack;
+  uint32_t accepted = 0;
+  for (int i = 0; i < batch->items_size(); ++i) {
+    // 无论工作者是否标记，经补传接口到达的都是历史样本；
+    // HostManager 不会替换已接收的历史样本，队列满时拒绝，这里据此停止确认
+    batch->mutable_items(i)->set_replayed(true);
+    if (Ingest(BatchItem(batch, i)) == IngestResult::kRejected) {
+      ack.set_retry_after_ms(static_cast<uint32_t>(retry_after_.count()));
+      break;
+    }
+    // 不合法的样本重传也不会成功，同样计为已处理
+    ++accepted;
   }
+  ack.set_accepted(accepted);
+  return ack;
+}
 
-  return grpc::Status::OK;
+::grpc::Status GrpcServerImpl::HandleMonitorInfo(::grpc::ServerContext* context,
+                                                 MonitorInfoPtr info) {
+  switch (Ingest(std::move(info))) {
+    case IngestResult::kAccepted:
+      return grpc::Status::OK;
+    case IngestResult::kRejected:
+      context->AddTrailingMetadata(kRetryAfterMetadataKey,
+                                   std::to_string(retry_after_.count()));
+      return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                          "Manager overloaded, retry later");
+    case IngestResult::kInvalid:
+      break;
+  }
+  return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Missing hostname");
 }
 
 ::grpc::Status GrpcServerImpl::GetMonitorInfo(
@@ -43,23 +74,30 @@ namespace monitor {
     const ::google::protobuf::Empty* request,
     ::monitor::proto::MonitorInfo* response) {
   // 返回第一个主机的数据（或空）
-  std::lock_guard<std::mutex> lock(mtx_);
-  if (!host_data_.empty()) {
-    *response = host_data_.begin()->second.info;
-    
+  for (auto& shard : host_data_) {
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    if (!shard.data.empty()) {
+      *response = *shard.data.begin()->second.info;
+      break;
+    }
   }
   return grpc::Status::OK;
 }
 
 std::unordered_map<std::string, HostData> GrpcServerImpl::GetAllHostData() {
-  std::lock_guard<std::mutex> lock(mtx_);
-  return host_data_;
+  std::unordered_map<std::string, HostData> all;
+  for (auto& shard : host_data_) {
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    all.insert(shard.data.begin(), shard.data.end());
+  }
+  return all;
 }
 
 bool GrpcServerImpl::GetHostData(const std::string& hostname, HostData* data) {
-  std::lock_guard<std::mutex> lock(mtx_);
-  auto it = host_data_.find(hostname);
-  if (it != host_data_.end()) {
+  HostDataShard& shard = ShardFor(hostname);
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  auto it = shard.data.find(hostname);
+  if (it != shard.data.end()) {
     *data = it->second;
     return true;
   }
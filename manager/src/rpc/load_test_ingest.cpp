@@ -0,0 +1,257 @@
+/**
+ * SetMonitorInfo 接收压测程序
+ *
+ * 模拟大量工作者向一个管理者推送监控数据：每个连接一个线程、一个独立的 channel
+ * 和完成队列，按目标速率匀速发起异步调用，连接内最多 max_inflight 个在途请求。
+ * 结束后输出实际推送速率、OK / RESOURCE_EXHAUSTED / 其它错误的个数，
+ * 以及调用延迟的 p50 / p99 / max。
+ *
+ * 目标：单个管理者在固定线程数下稳定承受 20k pushes/s，例如
+ *   ./manager 0.0.0.0:50051 4
+ *   ./load_test_ingest localhost:50051 20000 30 16 2000
+ * 观察 rate 接近目标值、rejected 为 0、p99 稳定，同时用
+ *   ps -o nlwp -p $(pidof manager)
+ * 确认管理者线程数不随连接数增长。
+ *
+ * 编译（在 build 目录生成 proto 代码之后）:
+ *   g++ -O2 -std=c++17 -I<build>/proto -o load_test_ingest load_test_ingest.cpp \
+ *       <build>/proto/libmonitor_proto.a -lgrpc++ -lgrpc -lgpr -lprotobuf -lpthread
+ * 运行: ./load_test_ingest [address] [pushes_per_sec] [seconds] [connections] [hosts] [max_inflight]
+ */
+
+#include <grpcpp/grpcpp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "monitor_info.grpc.pb.h"
+#include "monitor_info.pb.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+  std::string address = "localhost:50051";
+  double rate = 20000;       // 所有连接合计的目标推送速率
+  int seconds = 10;
+  int connections = 8;
+  int hosts = 1000;          // 模拟的主机数，推送按主机轮转
+  int max_inflight = 256;    // 单个连接的在途请求上限
+};
+
+struct Result {
+  uint64_t sent = 0;
+  uint64_t ok = 0;
+  uint64_t rejected = 0;
+  uint64_t errors = 0;
+  uint64_t late = 0;         // 因在途请求已满而推迟发送的次数
+  std::vector<uint32_t> latency_us;
+};
+
+// 构造一条接近真实大小的上报：8 个 CPU、2 块网卡、1 块磁盘
+monitor::proto::MonitorInfo MakeMonitorInfo(const std::string& host) {
+  monitor::proto::MonitorInfo info;
+  info.set_name(host);
+  info.mutable_host_info()->set_hostname(host);
+  info.mutable_host_info()->set_ip_address("10.0.0.1");
+  info.mutable_cpu_load()->set_load_avg_1(1.5f);
+  info.mutable_cpu_load()->set_load_avg_3(1.2f);
+  info.mutable_cpu_load()->set_load_avg_15(0.9f);
+  for (int i = 0; i < 8; ++i) {
+    auto* cpu = info.add_cpu_stat();
+    cpu->set_cpu_name("cpu" + std::to_string(i));
+    cpu->set_cpu_percent(35.0f);
+    cpu->set_usr_percent(20.0f);
+    cpu->set_system_percent(10.0f);
+    cpu->set_idle_percent(65.0f);
+    auto* irq = info.add_soft_irq();
+    irq->set_cpu("cpu" + std::to_string(i));
+    irq->set_timer(100.0f);
+    irq->set_net_rx(50.0f);
+  }
+  auto* mem = info.mutable_mem_info();
+  mem->set_total(16384.0f);
+  mem->set_free(4096.0f);
+  mem->set_avail(8192.0f);
+  mem->set_used_percent(50.0f);
+  for (const char* name : {"eth0", "eth1"}) {
+    auto* net = info.add_net_info();
+    net->set_name(name);
+    net->set_send_rate(1024.0f);
+    net->set_rcv_rate(2048.0f);
+  }
+  auto* disk = info.add_disk_info();
+  disk->set_name("sda");
+  return info;
+}
+
+struct Call {
+  grpc::ClientContext ctx;
+  google::protobuf::Empty response;
+  grpc::Status status;
+  std::unique_ptr<grpc::ClientAsyncResponseReader<google::protobuf::Empty>> reader;
+  Clock::time_point start;
+};
+
+void RunConnection(const Config& config, int index, Clock::time_point end,
+                   Result* result) {
+  // 每个连接使用独立的子通道池，避免多个 channel 复用同一条 TCP 连接
+  grpc::ChannelArguments args;
+  args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  auto channel = grpc::CreateCustomChannel(
+      config.address, grpc::InsecureChannelCredentials(), args);
+  auto stub = monitor::proto::GrpcManager::NewStub(channel);
+  grpc::CompletionQueue cq;
+
+  // 本连接负责的主机预先构造好，发送时只做序列化
+  std::vector<monitor::proto::MonitorInfo> messages;
+  for (int h = index; h < config.hosts; h += config.connections) {
+    messages.push_back(MakeMonitorInfo("load-host-" + std::to_string(h)));
+  }
+  if (messages.empty()) {
+    messages.push_back(MakeMonitorInfo("load-host-" + std::to_string(index)));
+  }
+
+  const auto interval = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(config.connections / config.rate));
+  auto next_send = Clock::now();
+  size_t next_message = 0;
+  int inflight = 0;
+
+  auto complete = [&](void* tag) {
+    std::unique_ptr<Call> call(static_cast<Call*>(tag));
+    --inflight;
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  Clock::now() - call->start)
+                  .count();
+    result->latency_us.push_back(static_cast<uint32_t>(us));
+    if (call->status.ok()) {
+      ++result->ok;
+    } else if (call->status.error_code() == grpc::StatusCode::RESOURCE_EXHAUSTED) {
+      ++result->rejected;
+    } else {
+      ++result->errors;
+    }
+  };
+
+  while (Clock::now() < end || inflight > 0) {
+    auto now = Clock::now();
+    if (now < end && now >= next_send) {
+      if (inflight < config.max_inflight) {
+        auto* call = new Call;
+        call->start = now;
+        call->ctx.set_deadline(std::chrono::system_clock::now() +
+                               std::chrono::seconds(5));
+        call->reader = stub->AsyncSetMonitorInfo(
+            &call->ctx, messages[next_message], &cq);
+        call->reader->Finish(&call->response, &call->status, call);
+        next_message = (next_message + 1) % messages.size();
+        ++inflight;
+        ++result->sent;
+        next_send += interval;
+        continue;
+      }
+      ++result->late;
+    }
+
+    // 等待完成事件，最多等到下一次计划发送的时间（AsyncNext 只接受 system_clock）
+    void* tag = nullptr;
+    bool ok = false;
+    Clock::duration wait = (now < end && inflight < config.max_inflight)
+                               ? std::max(next_send - now, Clock::duration::zero())
+                               : std::chrono::milliseconds(100);
+    auto status = cq.AsyncNext(&tag, &ok, std::chrono::system_clock::now() + wait);
+    if (status == grpc::CompletionQueue::GOT_EVENT) {
+      complete(tag);
+      // 顺带取走已经就绪的事件
+      while (cq.AsyncNext(&tag, &ok, std::chrono::system_clock::now()) ==
+             grpc::CompletionQueue::GOT_EVENT) {
+        complete(tag);
+      }
+    } else if (status == grpc::CompletionQueue::SHUTDOWN) {
+      break;
+    }
+  }
+
+  cq.Shutdown();
+  void* tag = nullptr;
+  bool ok = false;
+  while (cq.Next(&tag, &ok)) {
+  }
+}
+
+uint32_t Percentile(std::vector<uint32_t>& values, double p) {
+  if (values.empty()) return 0;
+  size_t k = static_cast<size_t>(p * (values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + k, values.end());
+  return values[k];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Config config;
+  if (argc > 1) config.address = argv[1];
+  if (argc > 2) config.rate = std::atof(argv[2]);
+  if (argc > 3) config.seconds = std::atoi(argv[3]);
+  if (argc > 4) config.connections = std::atoi(argv[4]);
+  if (argc > 5) config.hosts = std::atoi(argv[5]);
+  if (argc > 6) config.max_inflight = std::atoi(argv[6]);
+  config.rate = std::max(config.rate, 1.0);
+  config.seconds = std::max(config.seconds, 1);
+  config.connections = std::max(config.connections, 1);
+  config.hosts = std::max(config.hosts, 1);
+  config.max_inflight = std::max(config.max_inflight, 1);
+
+  std::cout << "target: " << config.address << ", rate: " << config.rate
+            << " pushes/s, duration: " << config.seconds
+            << " s, connections: " << config.connections
+            << ", hosts: " << config.hosts
+            << ", max inflight/conn: " << config.max_inflight << std::endl;
+
+  std::vector<Result> results(config.connections);
+  std::vector<std::thread> threads;
+  auto start = Clock::now();
+  auto end = start + std::chrono::seconds(config.seconds);
+  for (int i = 0; i < config.connections; ++i) {
+    threads.emplace_back(RunConnection, std::cref(config), i, end, &results[i]);
+  }
+  for (auto& t : threads) t.join();
+  double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  Result total;
+  for (auto& r : results) {
+    total.sent += r.sent;
+    total.ok += r.ok;
+    total.rejected += r.rejected;
+    total.errors += r.errors;
+    total.late += r.late;
+    total.latency_us.insert(total.latency_us.end(), r.latency_us.begin(),
+                            r.latency_us.end());
+  }
+
+  std::cout << "sent: " << total.sent << ", ok: " << total.ok
+            << ", rejected: " << total.rejected << ", errors: " << total.errors
+            << ", throttled by inflight limit: " << total.late << std::endl;
+  std::cout << "rate: " << static_cast<uint64_t>(total.ok / elapsed)
+            << " ok pushes/s over " << elapsed << " s" << std::endl;
+  uint32_t p50 = Percentile(total.latency_us, 0.50);
+  uint32_t p99 = Percentile(total.latency_us, 0.99);
+  uint32_t max = total.latency_us.empty()
+                     ? 0
+                     : *std::max_element(total.latency_us.begin(),
+                                         total.latency_us.end());
+  std::cout << "latency us: p50 " << p50 << ", p99 " << p99 << ", max " << max
+            << std::endl;
+  return total.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,368 @@
+#include "storage/batch_writer.h"
+#include "storage/prepared_insert.h"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <iostream>
+
+namespace monitor {
+
+namespace {
+
+// ==========================================
+// 表结构定义（列顺序即写入顺序）
+// ==========================================
+const TableSchema kTableSchemas[] = {
+    // server_performance
+    {"server_performance",
+     nullptr,
+     {},
+     {"cpu_percent", "usr_percent", "system_percent", "nice_percent",
+      "idle_percent", "io_wait_percent", "irq_percent", "soft_irq_percent",
+      "load_avg_1", "load_avg_3", "load_avg_15",
+      "mem_used_percent", "total", "free", "avail",
+      "disk_util_percent", "send_rate", "rcv_rate", "score",
+      "cpu_percent_rate", "usr_percent_rate", "system_percent_rate",
+      "nice_percent_rate", "idle_percent_rate", "io_wait_percent_rate",
+      "irq_percent_rate", "soft_irq_percent_rate",
+      "load_avg_1_rate", "load_avg_3_rate", "load_avg_15_rate",
+      "mem_used_percent_rate", "total_rate", "free_rate", "avail_rate",
+      "disk_util_percent_rate", "send_rate_rate", "rcv_rate_rate",
+      "cpu_percent_min", "cpu_percent_max", "cpu_percent_avg", "cpu_percent_p95",
+      "disk_util_percent_min", "disk_util_percent_max",
+      "disk_util_percent_avg", "disk_util_percent_p95",
+      "send_rate_min", "send_rate_max", "send_rate_avg", "send_rate_p95",
+      "rcv_rate_min", "rcv_rate_max", "rcv_rate_avg", "rcv_rate_p95"}},
+    // server_net_detail
+    {"server_net_detail",
+     "net_name",
+     {"err_in", "err_out", "drop_in", "drop_out"},
+     {"rcv_bytes_rate", "rcv_packets_rate", "snd_bytes_rate", "snd_packets_rate",
+      "rcv_bytes_rate_rate", "rcv_packets_rate_rate",
+      "snd_bytes_rate_rate", "snd_packets_rate_rate",
+      "err_in_rate", "err_out_rate", "drop_in_rate", "drop_out_rate",
+      "rcv_bytes_rate_min", "rcv_bytes_rate_max",
+      "rcv_bytes_rate_avg", "rcv_bytes_rate_p95",
+      "rcv_packets_rate_min", "rcv_packets_rate_max",
+      "rcv_packets_rate_avg", "rcv_packets_rate_p95",
+      "snd_bytes_rate_min", "snd_bytes_rate_max",
+      "snd_bytes_rate_avg", "snd_bytes_rate_p95",
+      "snd_packets_rate_min", "snd_packets_rate_max",
+      "snd_packets_rate_avg", "snd_packets_rate_p95"}},
+    // server_softirq_detail
+    {"server_softirq_detail",
+     "cpu_name",
+     {"hi", "timer", "net_tx", "net_rx", "block",
+      "irq_poll", "tasklet", "sched", "hrtimer", "rcu"},
+     {"hi_rate", "timer_rate", "net_tx_rate", "net_rx_rate", "block_rate",
+      "irq_poll_rate", "tasklet_rate", "sched_rate", "hrtimer_rate", "rcu_rate",
+      "net_tx_min", "net_tx_max", "net_tx_avg", "net_tx_p95",
+      "net_rx_min", "net_rx_max", "net_rx_avg", "net_rx_p95"}},
+    // server_mem_detail
+    {"server_mem_detail",
+     nullptr,
+     {},
+     {"total", "free", "avail", "buffers", "cached", "swap_cached",
+      "active", "inactive", "active_anon", "inactive_anon",
+      "active_file", "inactive_file", "dirty", "writeback",
+      "anon_pages", "mapped", "kreclaimable", "sreclaimable", "sunreclaim",
+      "total_rate", "free_rate", "avail_rate", "buffers_rate", "cached_rate",
+      "swap_cached_rate", "active_rate", "inactive_rate",
+      "active_anon_rate", "inactive_anon_rate",
+      "active_file_rate", "inactive_file_rate", "dirty_rate", "writeback_rate",
+      "anon_pages_rate", "mapped_rate", "kreclaimable_rate",
+      "sreclaimable_rate", "sunreclaim_rate"}},
+    // server_disk_detail
+    {"server_disk_detail",
+     "disk_name",
+     {"reads", "writes", "sectors_read", "sectors_written",
+      "read_time_ms", "write_time_ms", "io_in_progress", "io_time_ms",
+      "weighted_io_time_ms"},
+     {"read_bytes_per_sec", "write_bytes_per_sec", "read_iops", "write_iops",
+      "avg_read_latency_ms", "avg_write_latency_ms", "util_percent",
+      "read_bytes_per_sec_rate", "write_bytes_per_sec_rate",
+      "read_iops_rate", "write_iops_rate",
+      "avg_read_latency_ms_rate", "avg_write_latency_ms_rate",
+      "util_percent_rate",
+      "read_bytes_per_sec_min", "read_bytes_per_sec_max",
+      "read_bytes_per_sec_avg", "read_bytes_per_sec_p95",
+      "write_bytes_per_sec_min", "write_bytes_per_sec_max",
+      "write_bytes_per_sec_avg", "write_bytes_per_sec_p95",
+      "util_percent_min", "util_percent_max",
+      "util_percent_avg", "util_percent_p95"}},
+};
+
+static_assert(sizeof(kTableSchemas) / sizeof(kTableSchemas[0]) ==
+                  static_cast<size_t>(StorageTable::kCount),
+              "table schema count mismatch");
+
+#ifdef ENABLE_MYSQL
+void AppendEscaped(MYSQL* conn, const std::string& value, std::string* out) {
+  size_t old_size = out->size();
+  out->resize(old_size + value.size() * 2 + 3);
+  char* dst = &(*out)[old_size];
+  *dst++ = '\'';
+  unsigned long n = mysql_real_escape_string(conn, dst, value.data(), value.size());
+  dst[n] = '\'';
+  out->resize(old_size + n + 2);
+}
+
+void AppendInt(int64_t value, std::string* out) {
+  char buf[24];
+  auto res = std::to_chars(buf, buf + sizeof(buf), value);
+  out->append(buf, res.ptr);
+}
+
+void AppendFloat(double value, std::string* out) {
+  char buf[32];
+  // 与 ostringstream 默认输出一致，保留 6 位有效数字
+  auto res = std::to_chars(buf, buf + sizeof(buf), value,
+                           std::chars_format::general, 6);
+  out->append(buf, res.ptr);
+}
+
+// 格式化时间戳，连续相同时间戳只格式化一次
+class TimeFormatter {
+ public:
+  const char* Format(std::time_t t) {
+    if (t != last_) {
+      std::tm tm_time;
+      localtime_r(&t, &tm_time);
+      std::strftime(buf_, sizeof(buf_), "%Y-%m-%d %H:%M:%S", &tm_time);
+      last_ = t;
+    }
+    return buf_;
+  }
+
+ private:
+  std::time_t last_ = -1;
+  char buf_[32] = {0};
+};
+
+// 将某张表的行拼接为一条或多条多行 INSERT，每条不超过 max_bytes
+void BuildInsertStatements(MYSQL* conn, const TableSchema& schema,
+                           const std::vector<StorageRow>& rows,
+                           size_t max_bytes,
+                           std::vector<std::string>* statements) {
+  const std::string prefix = BuildInsertPrefix(schema);
+  TimeFormatter time_fmt;
+
+  std::string sql;
+  for (const auto& row : rows) {
+    if (sql.empty()) {
+      sql.reserve(std::min<size_t>(max_bytes, 64 * 1024));
+      sql = prefix;
+    } else {
+      sql += ',';
+    }
+
+    sql += '(';
+    AppendEscaped(conn, row.server_name, &sql);
+    if (schema.sub_name_column) {
+      sql += ',';
+      AppendEscaped(conn, row.sub_name, &sql);
+    }
+    for (size_t i = 0; i < schema.int_columns.size(); ++i) {
+      sql += ',';
+      AppendInt(row.ints[i], &sql);
+    }
+    for (size_t i = 0; i < schema.float_columns.size(); ++i) {
+      sql += ',';
+      AppendFloat(row.floats[i], &sql);
+    }
+    sql += ",'";
+    sql += time_fmt.Format(row.timestamp);
+    sql += "')";
+
+    if (sql.size() >= max_bytes) {
+      statements->push_back(std::move(sql));
+      sql.clear();
+    }
+  }
+  if (!sql.empty()) {
+    statements->push_back(std::move(sql));
+  }
+}
+#endif
+
+}  // namespace
+
+const TableSchema& GetTableSchema(StorageTable table) {
+  return kTableSchemas[static_cast<size_t>(table)];
+}
+
+std::string BuildInsertPrefix(const TableSchema& schema) {
+  std::string sql = "INSERT INTO ";
+  sql += schema.table;
+  sql += " (`server_name`";
+  if (schema.sub_name_column) {
+    sql += ",`";
+    sql += schema.sub_name_column;
+    sql += '`';
+  }
+  for (const char* col : schema.int_columns) {
+    sql += ",`";
+    sql += col;
+    sql += '`';
+  }
+  for (const char* col : schema.float_columns) {
+    sql += ",`";
+    sql += col;
+    sql += '`';
+  }
+  sql += ",`timestamp`) VALUES ";
+  return sql;
+}
+
+void StorageRow::SetInts(std::initializer_list<int64_t> values) {
+  assert(values.size() == GetTableSchema(table).int_columns.size());
+  std::copy_n(values.begin(), std::min(values.size(), ints.size()), ints.begin());
+}
+
+void StorageRow::SetFloats(std::initializer_list<double> values) {
+  assert(values.size() == GetTableSchema(table).float_columns.size());
+  std::copy_n(values.begin(), std::min(values.size(), floats.size()),
+              floats.begin());
+}
+
+// ==========================================
+// MysqlBatchWriter
+// ==========================================
+MysqlBatchWriter::MysqlBatchWriter(MysqlConnPool* pool, size_t shard,
+                                   const BatchWriterOptions& options)
+    : pool_(pool), shard_(shard), options_(options) {
+  if (options_.max_rows < 1) options_.max_rows = 1;
+}
+
+MysqlBatchWriter::~MysqlBatchWriter() { Flush(); }
+
+#ifdef ENABLE_MYSQL
+bool MysqlBatchWriter::WriteText(MysqlConnPool::Handle& conn,
+                                 uint64_t* statements) {
+  std::vector<std::string> sqls;
+  for (size_t t = 0; t < rows_.size(); ++t) {
+    if (rows_[t].empty()) continue;
+    sqls.clear();
+    BuildInsertStatements(conn.get(),
+                          GetTableSchema(static_cast<StorageTable>(t)),
+                          rows_[t], options_.max_statement_bytes, &sqls);
+    for (const auto& sql : sqls) {
+      if (!conn.Query(sql)) {
+        return false;
+      }
+      ++*statements;
+    }
+  }
+  return true;
+}
+
+bool MysqlBatchWriter::WritePrepared(MysqlConnPool::Handle& conn,
+                                     uint64_t* statements) {
+  // 连接重建过，旧连接上预编译的语句已失效
+  if (!stmt_cache_ || stmt_cache_->conn_id() != conn.id()) {
+    stmt_cache_ = std::make_unique<PreparedInsertCache>(conn.get(), conn.id());
+  }
+
+  for (size_t t = 0; t < rows_.size(); ++t) {
+    if (rows_[t].empty()) continue;
+    unsigned int err = 0;
+    if (!stmt_cache_->Insert(static_cast<StorageTable>(t), rows_[t],
+                             statements, &err)) {
+      if (MysqlConnPool::IsConnectionError(err)) {
+        conn.MarkBroken();
+      }
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+void MysqlBatchWriter::Add(StorageRow row) {
+  if (pending_rows_ == 0) {
+    batch_start_ = Clock::now();
+  }
+  rows_[static_cast<size_t>(row.table)].push_back(std::move(row));
+  ++pending_rows_;
+
+  if (pending_rows_ >= options_.max_rows) {
+    Flush();
+  }
+}
+
+void MysqlBatchWriter::FlushIfDue() {
+  if (pending_rows_ > 0 && Clock::now() >= Deadline()) {
+    Flush();
+  }
+}
+
+MysqlBatchWriter::Clock::time_point MysqlBatchWriter::Deadline() const {
+  if (pending_rows_ == 0) {
+    return Clock::time_point::max();
+  }
+  return batch_start_ + options_.max_delay;
+}
+
+bool MysqlBatchWriter::Flush() {
+  if (pending_rows_ == 0) {
+    return true;
+  }
+
+  auto start = Clock::now();
+  size_t batch_rows = pending_rows_;
+  bool ok = false;
+
+  uint64_t statements = 0;
+#ifdef ENABLE_MYSQL
+  if (pool_) {
+    auto conn = pool_->Acquire(shard_);
+    if (conn) {
+      // 同一批次的所有表在一个事务内提交，只产生一次 fsync
+      ok = conn.Query("START TRANSACTION");
+      if (ok) {
+        ok = options_.mode == InsertMode::kPrepared
+                 ? WritePrepared(conn, &statements)
+                 : WriteText(conn, &statements);
+      }
+      if (ok) {
+        ok = conn.Query("COMMIT");
+      } else if (conn) {
+        conn.Query("ROLLBACK");
+      }
+    }
+  }
+#endif
+
+  // 无论成功与否都清空批次，避免数据库长时间不可用时无限堆积
+  for (auto& table_rows : rows_) {
+    table_rows.clear();
+  }
+  pending_rows_ = 0;
+
+  auto flush_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      Clock::now() - start)
+                      .count();
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  stats_.flush_count++;
+  stats_.total_flush_us += flush_us;
+  stats_.max_flush_us =
+      std::max<uint64_t>(stats_.max_flush_us, static_cast<uint64_t>(flush_us));
+  stats_.statements += statements;
+  stats_.last_batch_rows = batch_rows;
+  stats_.max_batch_rows = std::max<uint64_t>(stats_.max_batch_rows, batch_rows);
+  if (ok) {
+    stats_.rows_written += batch_rows;
+  } else {
+    stats_.failed_flushes++;
+    stats_.rows_dropped += batch_rows;
+  }
+  return ok;
+}
+
+BatchWriterStats MysqlBatchWriter::GetStats() const {
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  return stats_;
+}
+
+}  // namespace monitor
@@ -0,0 +1,239 @@
+#include "storage/mysql_conn_pool.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef ENABLE_MYSQL
+#include <mysql/errmsg.h>
+#endif
+
+namespace monitor {
+
+namespace {
+// 连接空闲超过该时间，使用前先 ping 一次
+constexpr auto kPingIdleThreshold = std::chrono::seconds(30);
+// 连接失败后，同一个 slot 的最小重试间隔，避免数据库宕机时每条消息都去建连
+constexpr auto kReconnectBackoff = std::chrono::seconds(1);
+}  // namespace
+
+// ==========================================
+// Handle
+// ==========================================
+#ifdef ENABLE_MYSQL
+MYSQL* MysqlConnPool::Handle::get() const {
+  return slot_ ? slot_->conn : nullptr;
+}
+#endif
+
+uint64_t MysqlConnPool::Handle::id() const {
+  return slot_ ? slot_->conn_id : 0;
+}
+
+MysqlConnPool::Handle::operator bool() const {
+#ifdef ENABLE_MYSQL
+  return slot_ && slot_->conn && !slot_->broken;
+#else
+  return false;
+#endif
+}
+
+bool MysqlConnPool::Handle::Query(const std::string& sql) {
+#ifdef ENABLE_MYSQL
+  if (!*this) return false;
+  if (mysql_real_query(slot_->conn, sql.data(), sql.size()) == 0) {
+    return true;
+  }
+  unsigned int err = mysql_errno(slot_->conn);
+  std::cerr << "MysqlConnPool: query failed (" << err
+            << "): " << mysql_error(slot_->conn) << std::endl;
+  if (IsConnectionError(err)) {
+    slot_->broken = true;
+  }
+  return false;
+#else
+  (void)sql;
+  return false;
+#endif
+}
+
+void MysqlConnPool::Handle::MarkBroken() {
+  if (slot_) slot_->broken = true;
+}
+
+void MysqlConnPool::Handle::Release() {
+  if (slot_) {
+    slot_->last_used = std::chrono::steady_clock::now();
+    slot_->mtx.unlock();
+  }
+  pool_ = nullptr;
+  slot_ = nullptr;
+}
+
+// ==========================================
+// MysqlConnPool
+// ==========================================
+MysqlConnPool::MysqlConnPool(const MysqlConfig& config, size_t shard_count,
+                             size_t conns_per_shard)
+    : config_(config),
+      shard_count_(std::max<size_t>(shard_count, 1)),
+      conns_per_shard_(std::max<size_t>(conns_per_shard, 1)) {
+  size_t total = shard_count_ * conns_per_shard_;
+  slots_.reserve(total);
+  for (size_t i = 0; i < total; ++i) {
+    slots_.push_back(std::make_unique<Slot>());
+  }
+
+#ifdef ENABLE_MYSQL
+  // mysql_library_init 不是线程安全的，必须在任何工作线程使用前调用
+  mysql_library_init(0, nullptr, nullptr);
+
+  // 启动时预先建立所有连接，热路径只做复用
+  size_t connected = 0;
+  for (auto& slot : slots_) {
+    std::lock_guard<std::mutex> lock(slot->mtx);
+    if (Connect(slot.get())) ++connected;
+  }
+  std::cout << "MysqlConnPool: " << connected << "/" << total
+            << " connections established (" << shard_count_ << " shards x "
+            << conns_per_shard_ << ")" << std::endl;
+#endif
+}
+
+MysqlConnPool::~MysqlConnPool() {
+  for (auto& slot : slots_) {
+    std::lock_guard<std::mutex> lock(slot->mtx);
+    Disconnect(slot.get());
+  }
+}
+
+MysqlConnPool::Handle MysqlConnPool::Acquire(size_t shard) {
+  auto start = std::chrono::steady_clock::now();
+  size_t base = (shard % shard_count_) * conns_per_shard_;
+
+  // 1. 先尝试该分片下任意一个空闲连接
+  Slot* slot = nullptr;
+  for (size_t i = 0; i < conns_per_shard_; ++i) {
+    Slot* candidate = slots_[base + i].get();
+    if (candidate->mtx.try_lock()) {
+      slot = candidate;
+      break;
+    }
+  }
+
+  // 2. 全部被占用时阻塞在第一个连接上
+  if (!slot) {
+    slot = slots_[base].get();
+    slot->mtx.lock();
+  }
+
+  auto wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  {
+    std::lock_guard<std::mutex> lock(stats_mtx_);
+    stats_.acquire_count++;
+    stats_.total_wait_us += wait_us;
+    stats_.max_wait_us =
+        std::max<uint64_t>(stats_.max_wait_us, static_cast<uint64_t>(wait_us));
+  }
+
+  // 连接不可用时仍返回句柄（用于归还锁），operator bool 为 false
+  EnsureConnected(slot);
+  return Handle(this, slot);
+}
+
+bool MysqlConnPool::IsConnectionError(unsigned int err) {
+#ifdef ENABLE_MYSQL
+  return err == CR_SERVER_GONE_ERROR || err == CR_SERVER_LOST ||
+         err == CR_CONN_HOST_ERROR || err == CR_CONNECTION_ERROR ||
+         err == CR_COMMANDS_OUT_OF_SYNC;
+#else
+  (void)err;
+  return false;
+#endif
+}
+
+MysqlPoolStats MysqlConnPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  return stats_;
+}
+
+bool MysqlConnPool::EnsureConnected(Slot* slot) {
+#ifdef ENABLE_MYSQL
+  auto now = std::chrono::steady_clock::now();
+
+  // 空闲较久的连接先 ping，服务端可能已经因 wait_timeout 断开
+  if (slot->conn && !slot->broken && now - slot->last_used > kPingIdleThreshold) {
+    if (mysql_ping(slot->conn) != 0) {
+      slot->broken = true;
+    }
+  }
+
+  if (slot->conn && !slot->broken) {
+    return true;
+  }
+
+  if (now < slot->next_retry) {
+    return false;
+  }
+
+  Disconnect(slot);
+  return Connect(slot);
+#else
+  (void)slot;
+  return false;
+#endif
+}
+
+bool MysqlConnPool::Connect(Slot* slot) {
+#ifdef ENABLE_MYSQL
+  MYSQL* conn = mysql_init(nullptr);
+  if (!conn) {
+    std::cerr << "MysqlConnPool: mysql_init failed" << std::endl;
+    return false;
+  }
+
+  unsigned int timeout = config_.connect_timeout_sec;
+  mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+
+  if (!mysql_real_connect(conn, config_.host.c_str(), config_.user.c_str(),
+                          config_.password.c_str(), config_.database.c_str(),
+                          config_.port, nullptr, 0)) {
+    std::cerr << "MysqlConnPool: mysql_real_connect failed: "
+              << mysql_error(conn) << std::endl;
+    mysql_close(conn);
+    slot->next_retry = std::chrono::steady_clock::now() + kReconnectBackoff;
+    std::lock_guard<std::mutex> lock(stats_mtx_);
+    stats_.connect_failures++;
+    return false;
+  }
+
+  mysql_set_character_set(conn, "utf8mb4");
+  slot->conn = conn;
+  slot->broken = false;
+  slot->last_used = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  slot->conn_id = next_conn_id_++;
+  if (slot->ever_connected) {
+    stats_.reconnect_count++;
+  }
+  slot->ever_connected = true;
+  return true;
+#else
+  (void)slot;
+  return false;
+#endif
+}
+
+void MysqlConnPool::Disconnect(Slot* slot) {
+#ifdef ENABLE_MYSQL
+  if (slot->conn) {
+    mysql_close(slot->conn);
+    slot->conn = nullptr;
+  }
+#endif
+  slot->broken = false;
+}
+
+}  // namespace monitor
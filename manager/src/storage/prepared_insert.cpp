@@ -0,0 +1,190 @@
+#include "storage/prepared_insert.h"
+
+#ifdef ENABLE_MYSQL
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+namespace monitor {
+
+namespace {
+
+// 生成 2^level 行的占位符语句
+std::string BuildPlaceholderSql(const TableSchema& schema, size_t rows) {
+  std::string group = "(?";
+  for (size_t i = 1; i < schema.ColumnCount(); ++i) {
+    group += ",?";
+  }
+  group += ')';
+
+  std::string sql = BuildInsertPrefix(schema);
+  sql.reserve(sql.size() + rows * (group.size() + 1));
+  for (size_t i = 0; i < rows; ++i) {
+    if (i > 0) sql += ',';
+    sql += group;
+  }
+  return sql;
+}
+
+void FillTime(std::time_t t, MYSQL_TIME* out) {
+  std::tm tm_time;
+  localtime_r(&t, &tm_time);
+  std::memset(out, 0, sizeof(*out));
+  out->year = tm_time.tm_year + 1900;
+  out->month = tm_time.tm_mon + 1;
+  out->day = tm_time.tm_mday;
+  out->hour = tm_time.tm_hour;
+  out->minute = tm_time.tm_min;
+  out->second = tm_time.tm_sec;
+  out->time_type = MYSQL_TIMESTAMP_DATETIME;
+}
+
+// 不大于 n 的最大 2 的幂对应的档位
+size_t FloorLevel(size_t n) {
+  size_t level = 0;
+  while ((size_t{2} << level) <= n) ++level;
+  return level;
+}
+
+}  // namespace
+
+PreparedInsertCache::PreparedInsertCache(MYSQL* conn, uint64_t conn_id)
+    : conn_(conn), conn_id_(conn_id) {}
+
+PreparedInsertCache::~PreparedInsertCache() {
+  // 连接已关闭时 libmysqlclient 会把语句与连接解绑，mysql_stmt_close 只释放内存
+  for (size_t t = 0; t < stmts_.size(); ++t) {
+    for (size_t level = 0; level < kLevels; ++level) {
+      CloseStatement(static_cast<StorageTable>(t), level);
+    }
+  }
+}
+
+bool PreparedInsertCache::Insert(StorageTable table,
+                                 const std::vector<StorageRow>& rows,
+                                 uint64_t* statements, unsigned int* err) {
+  const TableSchema& schema = GetTableSchema(table);
+  size_t begin = 0;
+  while (begin < rows.size()) {
+    size_t level = FloorLevel(
+        std::min(rows.size() - begin, kMaxRowsPerStatement));
+    size_t count = size_t{1} << level;
+
+    MYSQL_STMT* stmt = GetStatement(table, level, err);
+    if (!stmt) {
+      return false;
+    }
+    if (!Execute(stmt, schema, rows, begin, count, err)) {
+      // 语句可能已失效（如表结构变化），丢弃后下次重新预编译
+      CloseStatement(table, level);
+      return false;
+    }
+    ++*statements;
+    begin += count;
+  }
+  return true;
+}
+
+MYSQL_STMT* PreparedInsertCache::GetStatement(StorageTable table, size_t level,
+                                              unsigned int* err) {
+  MYSQL_STMT*& stmt = stmts_[static_cast<size_t>(table)][level];
+  if (stmt) {
+    return stmt;
+  }
+
+  stmt = mysql_stmt_init(conn_);
+  if (!stmt) {
+    *err = mysql_errno(conn_);
+    return nullptr;
+  }
+
+  std::string sql = BuildPlaceholderSql(GetTableSchema(table), size_t{1} << level);
+  if (mysql_stmt_prepare(stmt, sql.data(), sql.size()) != 0) {
+    *err = mysql_stmt_errno(stmt);
+    std::cerr << "PreparedInsertCache: prepare failed (" << *err
+              << "): " << mysql_stmt_error(stmt) << std::endl;
+    mysql_stmt_close(stmt);
+    stmt = nullptr;
+  }
+  return stmt;
+}
+
+void PreparedInsertCache::CloseStatement(StorageTable table, size_t level) {
+  MYSQL_STMT*& stmt = stmts_[static_cast<size_t>(table)][level];
+  if (stmt) {
+    mysql_stmt_close(stmt);
+    stmt = nullptr;
+  }
+}
+
+bool PreparedInsertCache::Execute(MYSQL_STMT* stmt, const TableSchema& schema,
+                                  const std::vector<StorageRow>& rows,
+                                  size_t begin, size_t count,
+                                  unsigned int* err) {
+  const size_t cols = schema.ColumnCount();
+  binds_.assign(count * cols, MYSQL_BIND{});
+  times_.resize(count);
+  lengths_.resize(count * 2);
+
+  std::time_t last_ts = -1;
+  MYSQL_BIND* bind = binds_.data();
+  for (size_t r = 0; r < count; ++r) {
+    // 只读绑定：libmysqlclient 不会修改输入参数缓冲区
+    StorageRow& row = const_cast<StorageRow&>(rows[begin + r]);
+
+    lengths_[r * 2] = row.server_name.size();
+    bind->buffer_type = MYSQL_TYPE_STRING;
+    bind->buffer = const_cast<char*>(row.server_name.data());
+    bind->buffer_length = row.server_name.size();
+    bind->length = &lengths_[r * 2];
+    ++bind;
+
+    if (schema.sub_name_column) {
+      lengths_[r * 2 + 1] = row.sub_name.size();
+      bind->buffer_type = MYSQL_TYPE_STRING;
+      bind->buffer = const_cast<char*>(row.sub_name.data());
+      bind->buffer_length = row.sub_name.size();
+      bind->length = &lengths_[r * 2 + 1];
+      ++bind;
+    }
+
+    for (size_t i = 0; i < schema.int_columns.size(); ++i) {
+      bind->buffer_type = MYSQL_TYPE_LONGLONG;
+      bind->buffer = &row.ints[i];
+      ++bind;
+    }
+
+    for (size_t i = 0; i < schema.float_columns.size(); ++i) {
+      bind->buffer_type = MYSQL_TYPE_DOUBLE;
+      bind->buffer = &row.floats[i];
+      ++bind;
+    }
+
+    // 同一批次的时间戳大多相同，只在变化时重新转换
+    if (r == 0 || row.timestamp != last_ts) {
+      FillTime(row.timestamp, &times_[r]);
+      last_ts = row.timestamp;
+    } else {
+      times_[r] = times_[r - 1];
+    }
+    bind->buffer_type = MYSQL_TYPE_DATETIME;
+    bind->buffer = &times_[r];
+    ++bind;
+  }
+
+  if (mysql_stmt_bind_param(stmt, binds_.data()) ||
+      mysql_stmt_execute(stmt) != 0) {
+    *err = mysql_stmt_errno(stmt);
+    std::cerr << "PreparedInsertCache: execute failed (" << *err
+              << "): " << mysql_stmt_error(stmt) << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace monitor
+
+#endif  // ENABLE_MYSQL
@@ -0,0 +1,130 @@
+#include "storage/storage_pipeline.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace monitor {
+
+namespace {
+uint64_t ElapsedUs(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - since)
+      .count();
+}
+}  // namespace
+
+StoragePipeline::StoragePipeline(MysqlConnPool* pool,
+                                 const StoragePipelineOptions& options)
+    : options_(options), queue_(std::max<size_t>(options.queue_capacity, 1)) {
+  if (options_.writer_count < 1) options_.writer_count = 1;
+  for (size_t i = 0; i < options_.writer_count; ++i) {
+    writers_.push_back(
+        std::make_unique<MysqlBatchWriter>(pool, i, options_.batch));
+  }
+}
+
+StoragePipeline::~StoragePipeline() { Stop(); }
+
+void StoragePipeline::Start() {
+  if (running_) return;
+  running_ = true;
+  for (size_t i = 0; i < writers_.size(); ++i) {
+    threads_.emplace_back([this, i] { WriterLoop(i); });
+  }
+}
+
+void StoragePipeline::Stop() {
+  if (!running_) return;
+  running_ = false;
+
+  queue_.Stop();
+  for (auto& t : threads_) {
+    if (t.joinable()) t.join();
+  }
+  threads_.clear();
+}
+
+bool StoragePipeline::Submit(std::vector<StorageRow> rows) {
+  if (rows.empty()) return true;
+
+  size_t row_count = rows.size();
+  auto start = std::chrono::steady_clock::now();
+  Batch batch{std::move(rows), start};
+
+  bool ok = true;
+  if (options_.overflow_policy == StorageOverflowPolicy::kBlock) {
+    ok = queue_.Push(std::move(batch));
+  } else if (!queue_.TryPush(std::move(batch))) {
+    // 快速路径失败后才进入限时等待，正常情况下不产生计时开销
+    batch.enqueue_time = std::chrono::steady_clock::now();
+    ok = options_.max_enqueue_wait.count() > 0 &&
+         queue_.PushFor(std::move(batch), options_.max_enqueue_wait);
+  }
+
+  uint64_t wait_us = ElapsedUs(start);
+  uint64_t depth = queue_.Size();
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  stats_.enqueue_wait.Record(wait_us);
+  stats_.queue_high_water = std::max(stats_.queue_high_water, depth);
+  if (ok) {
+    stats_.batches_enqueued++;
+  } else {
+    stats_.batches_dropped++;
+    stats_.rows_dropped += row_count;
+  }
+  return ok;
+}
+
+void StoragePipeline::WriterLoop(size_t index) {
+  MysqlBatchWriter& writer = *writers_[index];
+  Batch batch;
+
+  while (true) {
+    // 等待新批次，最多等到当前合并批次的提交截止时间
+    auto deadline = std::min(writer.Deadline(), std::chrono::steady_clock::now() +
+                                                    std::chrono::seconds(1));
+    if (queue_.PopUntil(batch, deadline)) {
+      uint64_t queued_us = ElapsedUs(batch.enqueue_time);
+      {
+        std::lock_guard<std::mutex> lock(stats_mtx_);
+        stats_.queue_latency.Record(queued_us);
+      }
+      for (auto& row : batch.rows) {
+        writer.Add(std::move(row));
+      }
+    } else if (!running_ && queue_.Empty()) {
+      break;
+    }
+    writer.FlushIfDue();
+  }
+
+  // 退出前提交剩余数据
+  writer.Flush();
+}
+
+StoragePipelineStats StoragePipeline::GetStats() const {
+  StoragePipelineStats stats;
+  {
+    std::lock_guard<std::mutex> lock(stats_mtx_);
+    stats = stats_;
+  }
+  stats.queue_depth = queue_.Size();
+
+  for (const auto& w : writers_) {
+    auto ws = w->GetStats();
+    stats.writer.flush_count += ws.flush_count;
+    stats.writer.failed_flushes += ws.failed_flushes;
+    stats.writer.rows_written += ws.rows_written;
+    stats.writer.rows_dropped += ws.rows_dropped;
+    stats.writer.statements += ws.statements;
+    stats.writer.last_batch_rows =
+        std::max(stats.writer.last_batch_rows, ws.last_batch_rows);
+    stats.writer.max_batch_rows =
+        std::max(stats.writer.max_batch_rows, ws.max_batch_rows);
+    stats.writer.total_flush_us += ws.total_flush_us;
+    stats.writer.max_flush_us = std::max(stats.writer.max_flush_us, ws.max_flush_us);
+  }
+  return stats;
+}
+
+}  // namespace monitor
@@ -0,0 +1,121 @@
+/**
+ * 分片接收队列基准测试程序
+ *
+ * 多个生产者线程（模拟 gRPC 线程）向同一个分片队列投递消息，
+ * 一个消费者线程出队，对比：
+ *   SafeQueue : mutex + condition_variable，每条消息一次 notify_one / Pop
+ *   MpscRing  : 无锁环形队列，PopBatch 批量出队，自旋后 futex 睡眠
+ * 输出总吞吐与单条消息的平均耗时。
+ *
+ * 编译: g++ -O2 -std=c++17 -I../../include -o bench_mpsc_ring bench_mpsc_ring.cpp -lpthread
+ * 运行: ./bench_mpsc_ring [producers] [messages_per_producer] [capacity]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/mpsc_ring.h"
+#include "utils/safe_queue.h"
+
+namespace {
+
+// 模拟一条上报消息：带少量堆内存，移动开销与真实消息接近
+struct Message {
+  uint64_t seq = 0;
+  std::string host;
+};
+
+constexpr size_t kBatch = 64;
+
+struct Result {
+  double seconds = 0;
+  uint64_t consumed = 0;
+};
+
+Result RunSafeQueue(int producers, uint64_t per_producer, size_t capacity) {
+  SafeQueue<Message> queue(capacity);
+  const uint64_t total = per_producer * producers;
+  Result result;
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread consumer([&] {
+    Message msg;
+    while (result.consumed < total && queue.Pop(msg)) {
+      ++result.consumed;
+    }
+  });
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (uint64_t i = 0; i < per_producer; ++i) {
+        queue.Push(Message{i, "host-" + std::to_string(p)});
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  consumer.join();
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
+
+Result RunMpscRing(int producers, uint64_t per_producer, size_t capacity) {
+  MpscRing<Message> ring(capacity, OverflowPolicy::kBlock);
+  const uint64_t total = per_producer * producers;
+  Result result;
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread consumer([&] {
+    std::vector<Message> batch(kBatch);
+    while (result.consumed < total) {
+      result.consumed +=
+          ring.PopBatch(batch.data(), batch.size(), std::chrono::milliseconds(100));
+    }
+  });
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (uint64_t i = 0; i < per_producer; ++i) {
+        ring.Offer(Message{i, "host-" + std::to_string(p)});
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  consumer.join();
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
+
+void Print(const char* name, const Result& r) {
+  std::cout << name << ": " << r.consumed << " msgs in " << r.seconds * 1000
+            << " ms, " << static_cast<uint64_t>(r.consumed / r.seconds)
+            << " msgs/s, " << r.seconds * 1e9 / r.consumed << " ns/msg"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int producers = argc > 1 ? std::atoi(argv[1]) : 8;
+  uint64_t per_producer = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+  size_t capacity = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1024;
+  if (producers < 1) producers = 1;
+
+  std::cout << "producers: " << producers << ", messages/producer: "
+            << per_producer << ", capacity: " << capacity << std::endl;
+
+  Print("SafeQueue", RunSafeQueue(producers, per_producer, capacity));
+  Print("MpscRing ", RunMpscRing(producers, per_producer, capacity));
+  return 0;
+}
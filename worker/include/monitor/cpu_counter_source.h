@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "monitor/monitor_structs.h"
+#include "utils/kmod_mapping.h"
+
+namespace monitor {
+
+/**
+ * per-CPU 原始计数的来源
+ *
+ * CpuStatMonitor 与 CpuSoftIrqMonitor 只依赖这里的原始计数与时间戳，
+ * 使用率和频率的计算与来源无关：
+ *   kmod   内核模块 /dev/monitor_stats 的常驻映射（seqlock 快照）
+ *   ebpf   cpu_stats.bpf.c：每个 CPU 上的 perf 事件程序写 PERCPU_ARRAY map
+ *   procfs /proc/stat 与 /proc/softirqs
+ *
+ * 不同来源的 CPU 时间单位不同（jiffies / 纳秒 / USER_HZ），只用于同一来源
+ * 前后两次的差值与比值，因此来源在构造时选定后不再切换。
+ *
+ * 非线程安全，只在采集线程中使用。
+ */
+class CpuCounterSource {
+ public:
+  enum class Backend { kAuto, kKmod, kEbpf, kProcfs };
+
+  virtual ~CpuCounterSource() = default;
+
+  virtual Backend backend() const = 0;
+
+  // 读取所有 CPU 的 CPU 时间；update_ns 与 stats 一一对应，为该 CPU 的数据
+  // 对应的 CLOCK_MONOTONIC 时间（eBPF 来源各 CPU 各自刷新，时间戳互不相同）
+  virtual bool ReadCpuStat(std::vector<struct cpu_stat>* stats,
+                           std::vector<uint64_t>* update_ns) = 0;
+
+  // 读取所有 CPU 的软中断累计次数，update_ns 同上
+  virtual bool ReadSoftIrq(std::vector<struct softirq_stat>* stats,
+                           std::vector<uint64_t>* update_ns) = 0;
+
+  static const char* BackendName(Backend backend);
+  // "auto" / "kmod" / "ebpf" / "procfs"，无法识别时返回 false
+  static bool ParseBackend(const std::string& name, Backend* backend);
+
+  /**
+   * 按 backend 创建来源
+   *
+   * kAuto 依次尝试 kmod（设备已映射）、ebpf（编译时启用且加载成功）、procfs；
+   * 指定的来源不可用时返回 nullptr。
+   *
+   * @param kmod   与 CpuLoadMonitor 共享的 /dev/monitor_stats 映射
+   * @param period CPU 计数的采样周期：kmod 来源按它设置模块的后台刷新间隔
+   *               （MONITOR_IOC_SET_REFRESH_MS），eBPF 来源按它设置 perf 事件的周期
+   */
+  static std::unique_ptr<CpuCounterSource> Create(
+      Backend backend, std::shared_ptr<KmodMapping> kmod,
+      std::chrono::milliseconds period = std::chrono::seconds(1));
+};
+
+#ifdef ENABLE_EBPF
+// 加载 cpu_stats.bpf.c 并在每个在线 CPU 上挂载周期为 period 的 perf 事件，
+// 失败时返回 nullptr
+std::unique_ptr<CpuCounterSource> CreateEbpfCpuCounterSource(
+    std::chrono::milliseconds period);
+#endif
+
+}  // namespace monitor
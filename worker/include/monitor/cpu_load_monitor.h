@@ -1,14 +1,18 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "monitor/monitor_inter.h"
+#include "monitor/monitor_structs.h"
 #include "monitor_info.pb.h"
+#include "utils/kmod_mapping.h"
 
 namespace monitor {
 class CpuLoadMonitor : public MonitorInter {
  public:
-  CpuLoadMonitor() {}
+  explicit CpuLoadMonitor(std::shared_ptr<KmodMapping> device);
   void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
   void Stop() override {}
 
@@ -16,6 +20,8 @@ class CpuLoadMonitor : public MonitorInter {
   float load_avg_1_;
   float load_avg_3_;
   float load_avg_15_;
+  std::shared_ptr<KmodMapping> device_;  // /dev/monitor_stats 的共享映射
+  std::vector<struct cpu_load> snapshot_;  // 本次读取的一致快照
 };
 
 }  // namespace monitor
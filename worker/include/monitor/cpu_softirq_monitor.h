@@ -1,10 +1,14 @@
 #pragma once
 
-#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "monitor/cpu_counter_source.h"
 #include "monitor/monitor_inter.h"
+#include "monitor/monitor_structs.h"
 #include "monitor_info.pb.h"
 
 namespace monitor {
@@ -21,16 +25,20 @@ class CpuSoftIrqMonitor : public MonitorInter {
     int64_t sched;
     int64_t hrtimer;
     int64_t rcu;
-    std::chrono::steady_clock::time_point timepoint;
+    uint64_t update_ns;                  // 内核更新这组计数的单调时间
+    monitor::proto::SoftIrq last_msg;    // 上一次算出的频率
   };
 
  public:
-  CpuSoftIrqMonitor() {}
+  explicit CpuSoftIrqMonitor(std::shared_ptr<CpuCounterSource> source);
   void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
   void Stop() override {}
 
  private:
   std::unordered_map<std::string, struct SoftIrq> cpu_softirqs_;
+  std::shared_ptr<CpuCounterSource> source_;  // 与 CPU 状态监控共享
+  std::vector<struct softirq_stat> snapshot_;  // 本次读取的一致快照
+  std::vector<uint64_t> snapshot_ns_;          // 与 snapshot_ 对应的更新时间
 };
 
 }  // namespace monitor
\ No newline at end of file
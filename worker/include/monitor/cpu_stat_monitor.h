@@ -1,34 +1,48 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
+#include "monitor/cpu_counter_source.h"
+#include "monitor/cpu_usage_calc.h"
 #include "monitor/monitor_inter.h"
+#include "monitor/monitor_structs.h"
 #include "monitor_info.pb.h"
 
 namespace monitor {
 class CpuStatMonitor : public MonitorInter {
-  struct CpuStat {
-    std::string cpu_name;
-    float user;
-    float system;
-    float idle;
-    float nice;
-    float io_wait;
-    float irq;
-    float soft_irq;
-    float steal;
-    float guest;
-    float guest_nice;
-  };
-
  public:
-  CpuStatMonitor() {}
+  explicit CpuStatMonitor(std::shared_ptr<CpuCounterSource> source);
   void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
   void Stop() override {}
 
  private:
-  std::unordered_map<std::string, struct CpuStat> cpu_stat_map_;
+  // 第 0 行为汇总 "cpu"，CPU n 为第 n + 1 行
+  static constexpr size_t kTotalRow = 0;
+
+  // 把本次读到的计数按 CPU 编号写入 curr_，返回 false 表示没有可用的行
+  bool LoadSnapshot();
+  void Resize(size_t rows);
+  void EmitRows(monitor::proto::MonitorInfo* monitor_info) const;
+
+  std::shared_ptr<CpuCounterSource> source_;  // 与软中断监控共享
+  std::vector<struct cpu_stat> snapshot_;     // 本次读取的各 CPU
+  std::vector<uint64_t> snapshot_ns_;         // 与 snapshot_ 对应的更新时间
+
+  // 按列存放的历史与结果（struct-of-arrays），下标为行号；只在 CPU 数增长时扩容
+  std::vector<uint64_t> prev_[kCpuTimeColumns];
+  std::vector<uint64_t> curr_[kCpuTimeColumns];
+  std::vector<uint64_t> delta_[kCpuTimeColumns];  // 各行最近一次刷新的增量
+  std::vector<float> percent_[kCpuPercentColumns];   // 各行最近一次的使用率
+  std::vector<float> computed_[kCpuPercentColumns];  // 本次算出的，只取刷新过的行
+  std::vector<uint64_t> update_ns_;  // 各行计数上一次刷新的时间
+  std::vector<uint8_t> present_;  // 本次采样中出现的行
+  std::vector<uint8_t> fresh_;    // 本次采样中刷新过的行（汇总行：任一 CPU 刷新过）
+  std::vector<uint8_t> seen_;     // 之前出现过、prev_ 中已有计数的行
+  std::vector<uint8_t> ready_;    // 上次计算时可以输出的行
+  size_t rows_ = 0;
 };
 
 }  // namespace monitor
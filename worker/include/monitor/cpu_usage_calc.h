@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace monitor {
+
+/**
+ * CPU 使用率的批量计算
+ *
+ * 输入为按列存放（struct-of-arrays）的两次 CPU 时间计数，每列下标相同的元素
+ * 属于同一行（同一个 CPU）；一次遍历算出所有行的各项百分比，同样按列输出。
+ *
+ * 每行：delta = curr - prev（计数回退时按 0 处理），total 为 8 列 delta 之和，
+ * busy = total - idle - iowait，百分比 = delta * 100 / total；total 为 0 时全为 0。
+ *
+ * x86-64 上运行时检测 AVX2，一次处理 4 行；其他情况走标量实现，两者结果一致。
+ */
+
+// 参与计算的 CPU 时间列，guest / guest_nice 已计入 user / nice，不单独统计
+enum CpuTimeColumn {
+  kCpuTimeUser,
+  kCpuTimeNice,
+  kCpuTimeSystem,
+  kCpuTimeIdle,
+  kCpuTimeIowait,
+  kCpuTimeIrq,
+  kCpuTimeSoftirq,
+  kCpuTimeSteal,
+  kCpuTimeColumns
+};
+
+// 输出的百分比列，与 proto CpuStat 的字段一一对应
+enum CpuPercentColumn {
+  kCpuPercentBusy,
+  kCpuPercentUser,
+  kCpuPercentSystem,
+  kCpuPercentNice,
+  kCpuPercentIdle,
+  kCpuPercentIowait,
+  kCpuPercentIrq,
+  kCpuPercentSoftirq,
+  kCpuPercentColumns
+};
+
+using CpuTimeColumns = const uint64_t* const[kCpuTimeColumns];
+using CpuPercentOutput = float* const[kCpuPercentColumns];
+
+// 按当前 CPU 选择的实现
+void ComputeCpuPercent(CpuTimeColumns curr, CpuTimeColumns prev, size_t rows,
+                       CpuPercentOutput percent);
+
+void ComputeCpuPercentScalar(CpuTimeColumns curr, CpuTimeColumns prev,
+                             size_t rows, CpuPercentOutput percent);
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MONITOR_HAVE_AVX2_KERNEL 1
+// 调用方需确认 CPU 支持 AVX2（CpuPercentImplName() 返回 "avx2"）
+void ComputeCpuPercentAvx2(CpuTimeColumns curr, CpuTimeColumns prev,
+                           size_t rows, CpuPercentOutput percent);
+#endif
+
+// ComputeCpuPercent 实际使用的实现："avx2" 或 "scalar"
+const char* CpuPercentImplName();
+
+}  // namespace monitor
@@ -1,18 +1,39 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
-#include <unordered_map>
 
 #include "monitor/monitor_inter.h"
 #include "monitor_info.pb.h"
+#include "utils/procfs_reader.h"
 
 namespace monitor {
 
 class DiskMonitor : public MonitorInter {
+  struct DiskSample {
+    uint64_t reads, writes, sectors_read, sectors_written;
+    uint64_t read_time_ms, write_time_ms, io_in_progress, io_time_ms,
+        weighted_io_time_ms;
+    std::chrono::steady_clock::time_point timepoint;
+  };
+
  public:
-  DiskMonitor() {}
+  DiskMonitor() : diskstats_("/proc/diskstats") {}
   void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
   void Stop() override {}
+  // 设备很多时读取 /proc/diskstats 本身就很慢，放到工作线程池
+  std::chrono::milliseconds Period() const override {
+    return std::chrono::seconds(5);
+  }
+  MonitorCost Cost() const override { return MonitorCost::kExpensive; }
+
+ private:
+  ProcfsReader diskstats_;
+  // 透明比较器：用 string_view 查找，只有新出现的磁盘才分配键
+  std::map<std::string, DiskSample, std::less<>> last_samples_;
 };
 
 }  // namespace monitor
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "monitor/monitor_inter.h"
+
+struct bpf_object;
+struct flow_key;
+struct flow_stats;
+
+namespace monitor {
+
+class TcHookManager;
+
+/**
+ * 基于 eBPF 的按流流量监控器（top talkers）
+ *
+ * flow_stats.bpf.c 在 TC ingress / egress 上按 (网卡, 协议, 本端, 对端)
+ * 在内核的 LRU per-CPU map 中累加流量。每次采集用
+ * bpf_map_lookup_and_delete_batch 把 map 整个读出并清空，读到的就是上次采集
+ * 以来的增量；再用 nth_element 取出字节数最大的前 top_n 条写入 flow_info。
+ * 用户空间的开销与流的条数成正比，与包数无关。
+ * 只挂载在以太网网卡（ARPHRD_ETHER）上，三层隧道设备上的流不统计。
+ */
+class FlowMonitor : public MonitorInter {
+ public:
+  explicit FlowMonitor(size_t top_n);
+  ~FlowMonitor() override;
+
+  void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
+  void Stop() override;
+  MonitorCost Cost() const override { return MonitorCost::kExpensive; }
+
+  bool IsLoaded() const { return loaded_; }
+
+ private:
+  struct Flow;
+
+  bool InitEbpf();
+  void CleanupEbpf();
+
+  // 读出并清空 map，按 CPU 求和后存入 flows_
+  bool DrainAll();
+  // bpf_map_lookup_and_delete_batch 分批读出；返回 0 或 -errno
+  int DrainBatch();
+  // 老内核（< 5.6）逐个 key 读出再删除
+  void DrainByKey();
+  void AddFlow(const struct flow_key& key, const struct flow_stats* per_cpu);
+
+  // 重新获取 ifindex -> 网卡名
+  void RefreshLinks();
+
+  size_t top_n_;
+
+  struct bpf_object* bpf_obj_ = nullptr;
+  int map_fd_ = -1;
+  uint32_t map_max_entries_ = 0;
+  size_t possible_cpus_ = 0;
+  bool batch_supported_ = true;
+  bool loaded_ = false;
+  std::unique_ptr<TcHookManager> tc_hooks_;
+
+  std::unordered_map<uint32_t, std::string> ifname_cache_;  // ifindex -> name
+  std::chrono::steady_clock::time_point last_link_refresh_;
+  // 网卡有增删时由 TcHookManager 的监听线程置位
+  std::atomic<bool> links_changed_{false};
+
+  // 批量读取的缓冲区：每个 key 对应 possible_cpus_ 个 value
+  std::vector<struct flow_key> batch_keys_;
+  std::vector<struct flow_stats> batch_values_;
+  // 本次读出的流（已按 CPU 求和）
+  std::vector<Flow> flows_;
+  std::chrono::steady_clock::time_point last_drain_;
+};
+
+}  // namespace monitor
@@ -23,6 +23,11 @@ class HostInfoMonitor : public MonitorInter {
 
   void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
   void Stop() override {}
+  // 主机名与 IP 很少变化，低频刷新；遍历网卡较慢，放到工作线程池
+  std::chrono::milliseconds Period() const override {
+    return std::chrono::minutes(5);
+  }
+  MonitorCost Cost() const override { return MonitorCost::kExpensive; }
 
  private:
   /**
@@ -39,10 +44,6 @@ class HostInfoMonitor : public MonitorInter {
    * @return IP 地址字符串
    */
   std::string GetPrimaryIpAddress();
-
-  std::string cached_hostname_;     // 缓存的主机名
-  std::string cached_ip_;           // 缓存的 IP 地址
-  bool info_cached_ = false;        // 是否已缓存（主机信息通常不变）
 };
 
 }  // namespace monitor
@@ -1,39 +1,44 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
-#include <unordered_map>
 
 #include "monitor/monitor_inter.h"
 #include "monitor_info.pb.h"
+#include "utils/procfs_reader.h"
 
 namespace monitor {
 class MemMonitor : public MonitorInter {
+  // 单位 KB，与 /proc/meminfo 一致
   struct MenInfo {
-    int64_t total;
-    int64_t free;
-    int64_t avail;
-    int64_t buffers;
-    int64_t cached;
-    int64_t swap_cached;
-    int64_t active;
-    int64_t in_active;
-    int64_t active_anon;
-    int64_t inactive_anon;
-    int64_t active_file;
-    int64_t inactive_file;
-    int64_t dirty;
-    int64_t writeback;
-    int64_t anon_pages;
-    int64_t mapped;
-    int64_t kReclaimable;
-    int64_t sReclaimable;
-    int64_t sUnreclaim;
+    uint64_t total;
+    uint64_t free;
+    uint64_t avail;
+    uint64_t buffers;
+    uint64_t cached;
+    uint64_t swap_cached;
+    uint64_t active;
+    uint64_t in_active;
+    uint64_t active_anon;
+    uint64_t inactive_anon;
+    uint64_t active_file;
+    uint64_t inactive_file;
+    uint64_t dirty;
+    uint64_t writeback;
+    uint64_t anon_pages;
+    uint64_t mapped;
+    uint64_t kReclaimable;
+    uint64_t sReclaimable;
+    uint64_t sUnreclaim;
   };
 
  public:
-  MemMonitor() {}
+  MemMonitor() : meminfo_("/proc/meminfo", 8 * 1024) {}
   void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
   void Stop() override {}
+
+ private:
+  ProcfsReader meminfo_;
 };
 
-}  // namespace monitor
\ No newline at end of file
+}  // namespace monitor
@@ -5,7 +5,10 @@
 #include <vector>
 
 #include "monitor/monitor_inter.h"
+#include "monitor/monitor_scheduler.h"
+#include "monitor/window_aggregator.h"
 #include "monitor_info.pb.h"
+#include "utils/kmod_mapping.h"
 
 namespace monitor {
 
@@ -14,12 +17,18 @@ class MetricCollector {
   MetricCollector();
   ~MetricCollector();
 
-  // 采集所有指标并填充到 MonitorInfo
+  // 用各监控项最近一次的采集结果填充 MonitorInfo，不等待正在进行的采集
   void CollectAll(monitor::proto::MonitorInfo* monitor_info);
 
  private:
   std::vector<std::unique_ptr<MonitorInter>> monitors_;
+  // /dev/monitor_stats 的映射，与 CPU 相关的三个监控项共享
+  std::shared_ptr<KmodMapping> kmod_stats_;
   std::string hostname_;
+  // 高频采样的核心指标在推送窗口内的统计
+  WindowAggregator aggregator_;
+  // 按各监控项的周期在后台采集；析构时先于 monitors_ 停止
+  std::unique_ptr<MonitorScheduler> scheduler_;
 };
 
 }  // namespace monitor
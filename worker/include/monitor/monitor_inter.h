@@ -1,15 +1,26 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 
 #include "monitor_info.pb.h"
 
 namespace monitor {
+
+// 采集开销：kCheap 在调度线程上依次执行，kExpensive 交给工作线程池并行执行
+enum class MonitorCost { kCheap, kExpensive };
+
 class MonitorInter {
  public:
   MonitorInter() {}
   virtual ~MonitorInter() {}
   virtual void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) = 0;
   virtual void Stop() = 0;
+
+  // 采集周期；推送时取各监控项最近一次的结果（见 MonitorScheduler）
+  virtual std::chrono::milliseconds Period() const {
+    return std::chrono::seconds(1);
+  }
+  virtual MonitorCost Cost() const { return MonitorCost::kCheap; }
 };
-}  // namespace monitor
\ No newline at end of file
+}  // namespace monitor
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "monitor/monitor_inter.h"
+#include "monitor_info.pb.h"
+
+namespace monitor {
+
+/**
+ * 监控项调度器
+ *
+ * 每个监控项按自己声明的 Period() 在 steady_clock 上的固定时刻表执行
+ * （落后时跳过错过的时刻，不补采）。Cost() 为 kCheap 的监控项在调度线程上
+ * 依次执行；kExpensive 的交给一个小的工作线程池，上一次尚未结束时本次跳过，
+ * 同一个监控项不会并发执行。
+ *
+ * 每次执行写入一份独立的 MonitorInfo，结束后替换该监控项的“最近结果”；
+ * MergeLatest 只合并这些结果，不等待正在执行的采集，慢的监控项
+ * （例如上千个 dm 设备的 /proc/diskstats）不会拖慢 CPU 等高频指标。
+ *
+ * 共享数据源（/dev/monitor_stats 映射、CpuCounterSource）的监控项都是
+ * kCheap，只在调度线程上访问，不需要额外加锁。
+ */
+class MonitorScheduler {
+ public:
+  explicit MonitorScheduler(size_t pool_threads);
+  ~MonitorScheduler();
+
+  MonitorScheduler(const MonitorScheduler&) = delete;
+  MonitorScheduler& operator=(const MonitorScheduler&) = delete;
+
+  // 注册监控项，须在 Start() 之前；监控项由调用方持有，须比调度器活得久
+  void Add(MonitorInter* monitor);
+  // 同上，用 period 代替监控项自己声明的 Period()
+  void Add(MonitorInter* monitor, std::chrono::milliseconds period);
+
+  // 每轮执行到期的 kCheap 监控项之前在调度线程上调用一次
+  void SetBeforeCheapRun(std::function<void()> hook);
+
+  // 每次执行结束后以本次结果调用，可能同时来自调度线程与工作线程，须线程安全
+  void SetResultObserver(
+      std::function<void(const monitor::proto::MonitorInfo&)> observer);
+
+  // 启动调度线程与工作线程，所有监控项立即执行第一次
+  void Start();
+  // 停止并等待正在执行的采集结束
+  void Stop();
+
+  // 把各监控项最近一次的结果合并到 monitor_info（线程安全）
+  void MergeLatest(monitor::proto::MonitorInfo* monitor_info) const;
+
+ private:
+  struct Entry {
+    MonitorInter* monitor = nullptr;
+    std::chrono::milliseconds period;
+    MonitorCost cost = MonitorCost::kCheap;
+    std::chrono::steady_clock::time_point next_run;
+    std::atomic<bool> running{false};  // kExpensive：已排队或正在执行
+
+    mutable std::mutex mtx;
+    monitor::proto::MonitorInfo latest;  // 最近一次执行的结果
+  };
+
+  void Loop();
+  void WorkerLoop();
+  void Run(Entry* entry);
+
+  std::vector<std::unique_ptr<Entry>> entries_;
+  std::function<void()> before_cheap_run_;
+  std::function<void(const monitor::proto::MonitorInfo&)> result_observer_;
+  size_t pool_threads_;
+
+  std::thread thread_;
+  std::mutex mtx_;
+  std::condition_variable cv_;  // 唤醒调度线程（停止时）
+  bool stopping_ = false;
+
+  std::vector<std::thread> workers_;
+  std::mutex queue_mtx_;
+  std::condition_variable queue_cv_;
+  std::deque<Entry*> queue_;  // 等待工作线程执行的 kExpensive 监控项
+  bool queue_closed_ = false;
+};
+
+}  // namespace monitor
@@ -1,51 +1,183 @@
 #pragma once
 
+#if defined(__KERNEL__)
+#include <linux/types.h>
+#include <linux/ioctl.h>
+#elif defined(__VMLINUX_H__)
+/* eBPF 程序：基础类型来自 vmlinux.h，同类型的 typedef 可以重复声明 */
+typedef __u32 uint32_t;
+typedef __u64 uint64_t;
+#else
 #include <stdint.h>
+#include <sys/ioctl.h>
+#endif
 
 /*
  * 内核模块与用户空间共享的数据结构定义
- * 这些结构体必须与内核模块中的定义保持一致
+ *
+ * 内核模块 worker/src/kmod/monitor_collector.c 与 eBPF 程序
+ * worker/src/ebpf/cpu_stats.bpf.c 直接包含本文件，
+ * 各方使用同一份定义，不再各自维护一份需要手工对齐的结构体。
  */
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * 字段表（X-macro）：X(字段名, 内核中的下标)
+ *
+ * 结构体由字段表展开生成；内核模块用同一张表展开填充代码，
+ * 增删字段只需要改这里。
+ */
+
+/*
+ * CPU 时间，下标为 kernel_cpustat.cpustat[] 的 CPUTIME_*。单位随来源不同：
+ * 内核模块为 jiffies，eBPF 为纳秒，/proc/stat 为 USER_HZ；用户空间只使用比值
+ */
+#define MONITOR_CPU_STAT_FIELDS(X)      \
+    X(user,       CPUTIME_USER)         \
+    X(nice,       CPUTIME_NICE)         \
+    X(system,     CPUTIME_SYSTEM)       \
+    X(idle,       CPUTIME_IDLE)         \
+    X(iowait,     CPUTIME_IOWAIT)       \
+    X(irq,        CPUTIME_IRQ)          \
+    X(softirq,    CPUTIME_SOFTIRQ)      \
+    X(steal,      CPUTIME_STEAL)        \
+    X(guest,      CPUTIME_GUEST)        \
+    X(guest_nice, CPUTIME_GUEST_NICE)
+
+/* 软中断累计次数，下标为 *_SOFTIRQ */
+#define MONITOR_SOFTIRQ_FIELDS(X)       \
+    X(hi,       HI_SOFTIRQ)             \
+    X(timer,    TIMER_SOFTIRQ)          \
+    X(net_tx,   NET_TX_SOFTIRQ)         \
+    X(net_rx,   NET_RX_SOFTIRQ)         \
+    X(block,    BLOCK_SOFTIRQ)          \
+    X(irq_poll, IRQ_POLL_SOFTIRQ)       \
+    X(tasklet,  TASKLET_SOFTIRQ)        \
+    X(sched,    SCHED_SOFTIRQ)          \
+    X(hrtimer,  HRTIMER_SOFTIRQ)        \
+    X(rcu,      RCU_SOFTIRQ)
+
+/*
+ * 平均负载，下标为内核 avenrun[]。保存原始定点数（低 CPU_LOAD_FSHIFT 位为小数），
+ * 用户空间除以 (1 << CPU_LOAD_FSHIFT) 得到浮点值；load_avg_3 实际是 5 分钟负载
+ */
+#define MONITOR_CPU_LOAD_FIELDS(X)      \
+    X(load_avg_1,  0)                   \
+    X(load_avg_3,  1)                   \
+    X(load_avg_15, 2)
+
+#define CPU_LOAD_FSHIFT  11
+
+#define MONITOR_DECLARE_FIELD(name, index) uint64_t name;
+
+/* CPU 使用率统计结构体 */
+struct cpu_stat {
+    char cpu_name[16];      /* CPU 名称，如 "cpu0" */
+    MONITOR_CPU_STAT_FIELDS(MONITOR_DECLARE_FIELD)
+};
+
 /* 软中断统计结构体 */
 struct softirq_stat {
     char cpu_name[16];      /* CPU 名称，如 "cpu0" */
-    uint64_t hi;            /* HI_SOFTIRQ - 高优先级软中断 */
-    uint64_t timer;         /* TIMER_SOFTIRQ - 定时器软中断 */
-    uint64_t net_tx;        /* NET_TX_SOFTIRQ - 网络发送软中断 */
-    uint64_t net_rx;        /* NET_RX_SOFTIRQ - 网络接收软中断 */
-    uint64_t block;         /* BLOCK_SOFTIRQ - 块设备软中断 */
-    uint64_t irq_poll;      /* IRQ_POLL_SOFTIRQ - 中断轮询软中断 */
-    uint64_t tasklet;       /* TASKLET_SOFTIRQ - tasklet 软中断 */
-    uint64_t sched;         /* SCHED_SOFTIRQ - 调度软中断 */
-    uint64_t hrtimer;       /* HRTIMER_SOFTIRQ - 高精度定时器软中断 */
-    uint64_t rcu;           /* RCU_SOFTIRQ - RCU 软中断 */
+    MONITOR_SOFTIRQ_FIELDS(MONITOR_DECLARE_FIELD)
 };
 
 /* CPU 负载统计结构体 */
 struct cpu_load {
-    float load_avg_1;       /* 1 分钟平均负载 */
-    float load_avg_3;       /* 5 分钟平均负载 (注：实际是 5 分钟) */
-    float load_avg_15;      /* 15 分钟平均负载 */
+    MONITOR_CPU_LOAD_FIELDS(MONITOR_DECLARE_FIELD)
 };
 
-/* CPU 使用率统计结构体 */
-struct cpu_stat {
-    char cpu_name[16];      /* CPU 名称 */
-    uint64_t user;          /* 用户态时间 */
-    uint64_t nice;          /* 低优先级用户态时间 */
-    uint64_t system;        /* 内核态时间 */
-    uint64_t idle;          /* 空闲时间 */
-    uint64_t iowait;        /* I/O 等待时间 */
-    uint64_t irq;           /* 硬中断时间 */
-    uint64_t softirq;       /* 软中断时间 */
-    uint64_t steal;         /* 虚拟化偷取时间 */
-    uint64_t guest;         /* 虚拟机运行时间 */
-    uint64_t guest_nice;    /* 低优先级虚拟机运行时间 */
+#undef MONITOR_DECLARE_FIELD
+
+/*
+ * 统一设备 /dev/monitor_stats 的共享内存布局
+ *
+ *   [0, 4096)          头页 struct monitor_shm_header
+ *   cpu_stat 块        struct cpu_stat    x MONITOR_SHM_MAX_CPUS
+ *   softirq 块         struct softirq_stat x MONITOR_SHM_MAX_CPUS
+ *   cpu_load 块        struct cpu_load    x 1
+ *
+ * 各块的偏移、条目大小、容量和有效条目数记录在头页的 blocks[] 中，
+ * 读者以头页为准并按映射大小做边界校验。
+ *
+ * 内核每次更新（后台定时器或 MONITOR_IOC_SNAPSHOT）一次遍历所有 CPU 填充
+ * 全部块，前后各把 seq 加一（seqlock）：读取前后 seq 相同且为偶数才是一致的
+ * 快照，否则重试。update_ns 为内核完成本次更新时的 ktime_get_ns()
+ * （CLOCK_MONOTONIC），用于按内核时间计算速率。
+ */
+#define MONITOR_DEVICE_PATH      "/dev/monitor_stats"
+#define MONITOR_SHM_MAGIC        0x4d535453u  /* "MSTS" */
+#define MONITOR_SHM_ABI_VERSION  2
+#define MONITOR_SHM_HEADER_SIZE  4096
+#define MONITOR_SHM_MAX_CPUS     256
+
+enum monitor_shm_block_id {
+    MONITOR_BLOCK_CPU_STAT = 0,
+    MONITOR_BLOCK_SOFTIRQ  = 1,
+    MONITOR_BLOCK_CPU_LOAD = 2,
+    MONITOR_BLOCK_COUNT
+};
+
+struct monitor_shm_block {
+    uint32_t offset;        /* 相对映射起始的偏移 */
+    uint32_t entry_size;    /* 单个条目的大小，用于校验结构体定义一致 */
+    uint32_t capacity;      /* 块内可容纳的条目数 */
+    uint32_t count;         /* 有效条目数，在 seqlock 保护下更新 */
+};
+
+struct monitor_shm_header {
+    uint32_t magic;         /* MONITOR_SHM_MAGIC */
+    uint32_t abi_version;   /* MONITOR_SHM_ABI_VERSION */
+    uint32_t seq;           /* seqlock 序号，奇数表示内核正在更新 */
+    uint32_t nr_cpus;       /* 本次更新覆盖的 CPU 数 */
+    uint64_t update_ns;     /* 最近一次更新的内核单调时间（纳秒） */
+    uint32_t total_size;    /* 各块合计的大小（含头页） */
+    uint32_t refresh_ms;    /* 后台定时刷新间隔，0 表示只在 SNAPSHOT 时刷新 */
+    struct monitor_shm_block blocks[MONITOR_BLOCK_COUNT];
+};
+
+#define MONITOR_SHM_CPU_STAT_OFFSET  MONITOR_SHM_HEADER_SIZE
+#define MONITOR_SHM_SOFTIRQ_OFFSET \
+    (MONITOR_SHM_CPU_STAT_OFFSET + sizeof(struct cpu_stat) * MONITOR_SHM_MAX_CPUS)
+#define MONITOR_SHM_CPU_LOAD_OFFSET \
+    (MONITOR_SHM_SOFTIRQ_OFFSET + sizeof(struct softirq_stat) * MONITOR_SHM_MAX_CPUS)
+#define MONITOR_SHM_SIZE \
+    (MONITOR_SHM_CPU_LOAD_OFFSET + sizeof(struct cpu_load))
+
+/*
+ * 设备 ioctl
+ *
+ * SNAPSHOT        立即在调用者上下文中刷新一次全部块，返回后读到的就是调用时刻的值；
+ *                 距上次刷新不足 MONITOR_SNAPSHOT_MIN_NS 时直接返回，不重复遍历
+ * SET_REFRESH_MS  设置后台定时刷新间隔（毫秒），0 关闭定时器；需要 CAP_SYS_ADMIN
+ * GET_REFRESH_MS  读取当前后台刷新间隔
+ */
+#define MONITOR_IOC_MAGIC           'M'
+#define MONITOR_IOC_SNAPSHOT        _IO(MONITOR_IOC_MAGIC, 1)
+#define MONITOR_IOC_SET_REFRESH_MS  _IOW(MONITOR_IOC_MAGIC, 2, uint32_t)
+#define MONITOR_IOC_GET_REFRESH_MS  _IOR(MONITOR_IOC_MAGIC, 3, uint32_t)
+
+#define MONITOR_SNAPSHOT_MIN_NS     1000000ull  /* 1 ms */
+#define MONITOR_REFRESH_MIN_MS      10
+
+/*
+ * eBPF 采集程序 per-CPU map（PERCPU_ARRAY，单个 key 0）的值
+ *
+ * 每个 CPU 上的 perf 事件程序只写自己 CPU 的那一份，update_ns 为写入时的
+ * bpf_ktime_get_ns()，为 0 表示该 CPU 尚未采样（离线或事件还没触发）。
+ * cpu_name 由用户空间按 CPU 编号填写；CPU 时间单位为纳秒。
+ */
+struct cpu_stat_sample {
+    uint64_t update_ns;
+    struct cpu_stat stat;
+};
+
+struct softirq_sample {
+    uint64_t update_ns;
+    struct softirq_stat stat;
 };
 
 #ifdef __cplusplus
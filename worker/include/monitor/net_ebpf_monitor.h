@@ -1,21 +1,26 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <chrono>
 #include <memory>
+#include <vector>
 
 #include "monitor/monitor_inter.h"
 
 struct bpf_object;
+struct net_stats;
 
 namespace monitor {
 
+class TcHookManager;
+
 /**
  * 基于 eBPF 的网络流量监控器
  * 
- * 使用 eBPF tracepoint 挂载到内核网络路径，
- * 实时统计每个网卡的收发流量。
+ * 在每个网卡的 TC ingress / egress 上挂载 eBPF 程序（由 TcHookManager
+ * 管理，之后新建的网卡自动挂载），实时统计每个网卡的收发流量。
  */
 class NetEbpfMonitor : public MonitorInter {
  public:
@@ -35,8 +40,15 @@ class NetEbpfMonitor : public MonitorInter {
   // 清理 eBPF 资源
   void CleanupEbpf();
   
-  // 根据 ifindex 获取网卡名称
-  std::string GetIfName(uint32_t ifindex);
+  // 读出 map 中所有网卡的计数（各 CPU 求和）到 keys_ / totals_
+  bool ReadAllStats();
+  // bpf_map_lookup_batch 一次取回整个 map；返回 0 或 -errno
+  int ReadBatch();
+  // 老内核（< 5.6）不支持批量读取时逐个 key 查找
+  bool ReadByKey();
+
+  // 重新获取 ifindex -> 网卡名，并清理已删除网卡在 BPF map 与 cache_ 中的条目
+  void RefreshLinks();
 
   // 上一次采集的数据，用于计算速率
   struct NetStatCache {
@@ -49,10 +61,24 @@ class NetEbpfMonitor : public MonitorInter {
 
   std::unordered_map<uint32_t, NetStatCache> cache_;  // key: ifindex
   std::unordered_map<uint32_t, std::string> ifname_cache_;  // ifindex -> name
-  std::vector<uint32_t> attached_ifindexes_;  // 已附加 TC hook 的网卡
+  std::chrono::steady_clock::time_point last_link_refresh_;
+  // 网卡有增删时由 TcHookManager 的监听线程置位
+  std::atomic<bool> links_changed_{false};
+  std::unique_ptr<TcHookManager> tc_hooks_;
   
   struct bpf_object* bpf_obj_ = nullptr;
   int map_fd_ = -1;
+  uint32_t map_max_entries_ = 0;
+  size_t possible_cpus_ = 0;
+  bool batch_supported_ = true;
+
+  // 批量读取的缓冲区：net_stats_map 是 PERCPU_HASH，每个 key 对应
+  // possible_cpus_ 个 value
+  std::vector<uint32_t> batch_keys_;
+  std::vector<struct net_stats> batch_values_;
+  // 本次读出的 ifindex 与对应的计数（已按 CPU 求和）
+  std::vector<uint32_t> keys_;
+  std::vector<struct net_stats> totals_;
   bool loaded_ = false;
   
   std::chrono::steady_clock::time_point last_update_;
@@ -1,16 +1,31 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
+#include <map>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "monitor/monitor_inter.h"
 #include "monitor_info.pb.h"
+#include "utils/procfs_reader.h"
+#include "utils/rtnetlink.h"
 
 namespace monitor {
+
+/**
+ * 只读内核网卡计数的网络流量监控器，数据路径上没有任何开销
+ *
+ * 两种计数来源：
+ *   kProcfs:  解析 /proc/net/dev 文本
+ *   kNetlink: 一次 RTM_GETSTATS dump 取回所有网卡的 IFLA_STATS_LINK_64
+ *             （struct rtnl_link_stats64），二进制解析，套接字与接收缓冲区复用
+ * 两者的计数相同（/proc/net/dev 本身由 rtnl_link_stats64 格式化而来）。
+ * 内核不支持 RTM_GETSTATS（< 4.7）时 kNetlink 自动退回 kProcfs。
+ */
 class NetMonitor : public MonitorInter {
   struct NetInfo {
-    std::string name;
     uint64_t rcv_bytes;
     uint64_t rcv_packets;
     uint64_t snd_bytes;
@@ -23,12 +38,44 @@ class NetMonitor : public MonitorInter {
   };
 
  public:
-  NetMonitor() {}
+  enum class Backend { kProcfs, kNetlink };
+
+  explicit NetMonitor(Backend backend = Backend::kProcfs);
   void UpdateOnce(monitor::proto::MonitorInfo* monitor_info) override;
   void Stop() override {}
 
+  // 实际使用的来源（kNetlink 不可用时为 kProcfs）
+  Backend backend() const { return backend_; }
+  static const char* BackendName(Backend backend);
+
+  // 一个网卡的累计计数，name 指向读取缓冲区或网卡名表
+  struct NetStat;
+
  private:
-  std::unordered_map<std::string, NetInfo> last_net_info_;
+  void UpdateFromProcfs(monitor::proto::MonitorInfo* monitor_info,
+                        std::chrono::steady_clock::time_point now);
+  // RTM_GETSTATS 失败返回 false
+  bool UpdateFromNetlink(monitor::proto::MonitorInfo* monitor_info,
+                         std::chrono::steady_clock::time_point now);
+  // 重新获取 ifindex -> 网卡名
+  bool RefreshLinkNames();
+  // 由累计计数算出速率写入 protobuf，并更新缓存
+  void Emit(const NetStat& stat, std::chrono::steady_clock::time_point now,
+            monitor::proto::MonitorInfo* monitor_info);
+  // 删除本次没有出现的接口的缓存，网卡频繁增删（容器 veth）时不会无限增长
+  void PruneLastNetInfo(std::chrono::steady_clock::time_point now);
+
+  Backend backend_;
+  ProcfsReader net_dev_;
+
+  RtnlSocket rtnl_;
+  std::unordered_map<uint32_t, std::string> link_names_;  // key: ifindex
+  std::chrono::steady_clock::time_point link_names_time_;
+  // 一次 dump 的结果：(ifindex, 计数)，复用容量
+  std::vector<std::pair<uint32_t, NetInfo>> link_stats_;
+
+  // 透明比较器：用 string_view 查找接口
+  std::map<std::string, NetInfo, std::less<>> last_net_info_;
 };
 
-}  // namespace monitor
\ No newline at end of file
+}  // namespace monitor
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "utils/rtnetlink.h"
+
+namespace monitor {
+
+/**
+ * 网卡 TC hook 的挂载与热插拔管理
+ *
+ * 把一对 TC 程序挂到所有网卡（lo 除外）clsact qdisc 的 ingress / egress 上，
+ * 并在后台线程监听 RTM_NEWLINK / RTM_DELLINK：新网卡出现时立即挂载，
+ * 网卡删除时（过滤器随设备一起销毁）移除记录。clsact 的创建与过滤器的挂载
+ * 全部通过 libbpf 的 bpf_tc_* 完成，不 fork tc 命令。
+ *
+ * 过滤器使用固定的 handle / priority 并带 BPF_TC_F_REPLACE，工作者异常退出后
+ * 残留的过滤器在下次启动时被替换而不是叠加；同一网卡上挂多组程序时
+ * 各用不同的 priority。clsact qdisc 可能由其他程序共用，
+ * 卸载时只摘掉自己的过滤器，不删除 qdisc。
+ *
+ * 线程安全。
+ */
+class TcHookManager {
+ public:
+  // 网卡挂载成功（added 为 true）或被删除时在监听线程上调用
+  using LinkCallback = std::function<void(uint32_t ifindex, bool added)>;
+  // 返回 false 的网卡不挂载（lo 始终不挂载）
+  using LinkFilter = std::function<bool(const LinkInfo& link)>;
+
+  // net_stats 的 TC 程序使用的 priority；选不常用的值，避免与其他程序冲突
+  static constexpr uint32_t kDefaultPriority = 0xc0de;
+
+  TcHookManager(int ingress_prog_fd, int egress_prog_fd,
+                uint32_t priority = kDefaultPriority,
+                LinkFilter filter = nullptr);
+  ~TcHookManager();
+
+  TcHookManager(const TcHookManager&) = delete;
+  TcHookManager& operator=(const TcHookManager&) = delete;
+
+  // 先订阅网卡通知再挂载当前所有网卡，然后启动监听线程；
+  // 订阅失败时返回 false（已有网卡仍会挂载，只是不处理之后新建的网卡）
+  bool Start(LinkCallback callback);
+  // 停止监听并摘掉所有过滤器
+  void Stop();
+
+  size_t AttachedCount() const;
+
+ private:
+  struct Filter {
+    bool attached = false;
+    uint32_t handle = 0;
+    uint32_t priority = 0;
+  };
+  struct Attachment {
+    Filter ingress;
+    Filter egress;
+  };
+
+  bool Accepts(const LinkInfo& link) const;
+  // 挂载当前所有网卡，并清除已不存在的网卡的记录
+  void Sync();
+  bool Attach(uint32_t ifindex, const std::string& name);
+  void Detach(uint32_t ifindex, const Attachment& attachment);
+  void Loop();
+  void HandleMessage(const struct nlmsghdr* nh);
+
+  int ingress_fd_;
+  int egress_fd_;
+  uint32_t priority_;
+  LinkFilter filter_;
+  LinkCallback callback_;
+
+  mutable std::mutex mtx_;
+  std::unordered_map<uint32_t, Attachment> attached_;  // key: ifindex
+
+  RtnlSocket listener_;
+  int stop_fd_ = -1;  // eventfd，唤醒监听线程退出
+  std::thread thread_;
+};
+
+}  // namespace monitor
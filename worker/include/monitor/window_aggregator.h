@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "monitor_info.pb.h"
+
+namespace monitor {
+
+/**
+ * 推送窗口内高频样本的统计
+ *
+ * 核心指标（CPU 使用率、软中断、网卡速率、磁盘吞吐与利用率）按
+ * MONITOR_SAMPLE_MS 高频采样，每次采样的结果经 Observe() 记入按
+ * （指标，CPU 名 / 网卡名 / 磁盘名）区分的序列；推送时 Fill() 把每个序列
+ * 窗口内的 min / max / mean / p95 / last 写入对应行的 *_agg 字段，
+ * 然后开始新的窗口。消息条数不变，突发尖峰也能体现在统计里。
+ * 标记为 stale 的行（计数来源尚未刷新、沿用上一次结果）不计入，
+ * 采样快于来源的刷新周期时统计不会被重复的样本稀释。
+ *
+ * 每个序列最多保留 kWindowCapacity 个样本，超出后覆盖最旧的，
+ * 内存不随推送间隔增长；窗口内没有再出现的序列（下线的 CPU、删除的网卡）
+ * 在下一次 Fill() 时丢弃。
+ *
+ * 线程安全：Observe() 可能同时来自调度线程与工作线程池。
+ */
+class WindowAggregator {
+ public:
+  // 100ms 采样、60 秒推送间隔时恰好不覆盖
+  static constexpr size_t kWindowCapacity = 600;
+
+  WindowAggregator();
+
+  // 记入一个监控项一次执行的结果
+  void Observe(const monitor::proto::MonitorInfo& sample);
+
+  // 为 monitor_info 中的各行填写窗口统计，并开始新的窗口
+  void Fill(monitor::proto::MonitorInfo* monitor_info);
+
+ private:
+  struct Series {
+    std::vector<float> samples;  // 环形缓冲，满了之后从 next 处覆盖
+    size_t next = 0;
+    float last = 0;
+  };
+  using SeriesMap = std::unordered_map<std::string, Series>;
+
+  void Add(int metric, const std::string& name, float value);
+  // 窗口内没有样本时返回 false
+  bool Take(int metric, const std::string& name,
+            monitor::proto::MetricAggregate* aggregate);
+
+  std::mutex mtx_;
+  std::vector<SeriesMap> series_;  // 下标为指标编号
+  std::vector<float> scratch_;     // 求 p95 时的工作区
+};
+
+}  // namespace monitor
@@ -1,23 +1,47 @@
 #pragma once
 
+#include <grpcpp/alarm.h>
 #include <grpcpp/grpcpp.h>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <string>
 #include <thread>
 
 #include "monitor/metric_collector.h"
 #include "monitor_info.grpc.pb.h"
 #include "monitor_info.pb.h"
+#include "rpc/push_spool.h"
+#include "rpc/sample_ring.h"
 
 namespace monitor {
 
 /**
  * 监控数据推送器
  * 
- * 每隔指定间隔（默认 10 秒）采集本机监控数据，
- * 并通过 gRPC 推送给管理者服务器。
+ * 每隔指定间隔（默认 10 秒）取一份本机监控数据的快照，
+ * 并通过 gRPC 推送给管理者服务器。各监控项由 MetricCollector 按自己的周期
+ * 在后台采集，快照取的是各自最近一次的结果。
+ *
+ * 采集与发送分属两个线程：采集线程按 steady_clock 上的固定时刻表采样
+ * （第 n 次采样在 start + n * interval，不受发送耗时影响），样本写入内存中的
+ * SampleRing；发送线程基于 CompletionQueue 异步地把环里的样本发出去，
+ * 管理者卡死或网络中断只会让样本在环里堆积，不会拖慢采集。
+ *
+ * 默认使用 StreamMonitorInfo 长连接：整个进程只维持一条流，每次上报只是流上的
+ * 一次异步 Write，回执在同一个完成队列上读取。建流与每次写出都有 deadline，
+ * 超时即取消这条流。流断开后按指数退避（加随机抖动）重连；管理者不支持流式
+ * 接口时退回带 deadline 的异步一元调用，失败同样按指数退避重试。
+ * 管理者过载时（一元调用返回 RESOURCE_EXHAUSTED，或回执带 retry_after_ms），
+ * 按其提示（加随机抖动）退避，期间样本留在环中，退避结束后按顺序发出。
+ *
+ * 与管理者断连期间的样本写入本地 spool（见 PushSpool）；流上已写出但尚未被
+ * 回执确认的样本在流断开时也转入 spool。连接恢复后，每次推送成功后以 gzip
+ * 压缩的 Backfill 批量补传。每条样本带采集时刻 collect_time_ms，
+ * 管理者按它入库，补传的数据落在正确的时间点。
  */
 class MonitorPusher {
  public:
@@ -25,30 +49,100 @@ class MonitorPusher {
    * 构造函数
    * @param manager_address 管理者服务器地址（如 "192.168.1.100:50051"）
    * @param interval_seconds 推送间隔（秒），默认 10 秒
+   * @param spool_options 断连期间本地落盘的目录与容量
    */
   explicit MonitorPusher(const std::string& manager_address,
-                         int interval_seconds = 10);
+                         int interval_seconds = 10,
+                         const PushSpoolOptions& spool_options = PushSpoolOptions());
   ~MonitorPusher();
 
-  // 启动推送线程
+  // 启动采集线程与发送线程
   void Start();
 
-  // 停止推送
+  // 停止推送：环中未发出的样本与未确认的样本写入 spool
   void Stop();
 
   // 获取管理者地址
   const std::string& GetManagerAddress() const { return manager_address_; }
 
  private:
-  void PushLoop();
-  bool PushOnce();
+  struct StreamCall;  // 一条推送流及其在途操作，定义见 .cpp
+  struct UnaryCall;   // 一次异步一元调用
+  struct BackfillCall;  // 一次异步补传
+
+  // 采集线程
+  void CollectLoop();
+  void CollectOnce(monitor::proto::MonitorInfo* info);
+  // 唤醒阻塞在完成队列上的发送线程
+  void WakeSender();
+
+  // 发送线程：处理完成事件，按状态发起建流 / 写出 / 一元调用
+  void SendLoop();
+  void Pump();
+  void HandleEvent(void* tag, bool ok);
+  void CheckDeadlines();
+
+  void OpenStream();
+  void WriteStream(monitor::proto::MonitorInfo* info);
+  void PostRead();
+  // 取消当前流；读端随之失败，进而调用 Finish
+  void BreakStream(const char* reason);
+  void FinishStream();
+  void MaybeRetireStream();
+  // 进程退出时半关闭写端，等待管理者处理完剩余上报
+  void CloseStreamGracefully();
+
+  void StartUnary(monitor::proto::MonitorInfo* info);
+  void OnUnaryDone();
+
+  // 发送失败后按指数退避（加随机抖动）推迟下一次建流 / 调用
+  void ScheduleRetry();
+
+  // 推送失败的样本落盘；连接恢复后批量补传
+  void Spool(const monitor::proto::MonitorInfo& info);
+  void SpoolRing();
+  // 发起一轮补传（已有补传在途时不做任何事），每批完成后在完成事件中接着发下一批
+  void Backfill();
+  void StartBackfill();
+  void OnBackfillDone();
+
+  // 一元调用被拒绝时计算退避时间
+  void BackOff(const grpc::ClientContext& context);
+  // 在 delay 的基础上加随机抖动，推迟下一次推送
+  void SetBackoff(std::chrono::milliseconds delay);
 
   std::string manager_address_;
   int interval_seconds_;
   std::atomic<bool> running_;
-  std::unique_ptr<std::thread> thread_;
+  std::atomic<bool> collecting_{false};  // 采集线程退出后发送线程才收尾
+  std::unique_ptr<std::thread> collect_thread_;
+  std::unique_ptr<std::thread> send_thread_;
   std::unique_ptr<MetricCollector> collector_;
   std::unique_ptr<monitor::proto::GrpcManager::Stub> stub_;
+
+  // 采集线程 -> 发送线程
+  SampleRing ring_;
+  grpc::CompletionQueue cq_;
+  grpc::Alarm wake_alarm_;
+  std::mutex wake_mtx_;
+  bool wake_pending_ = false;  // wake_alarm_ 已设置、尚未被发送线程取走
+
+  // 以下状态只由发送线程访问
+  std::unique_ptr<StreamCall> stream_;
+  std::unique_ptr<UnaryCall> unary_;
+  bool stream_supported_ = true;
+  int retry_attempts_ = 0;
+  std::chrono::steady_clock::time_point retry_at_;
+
+  std::unique_ptr<PushSpool> spool_;
+  bool backfill_supported_ = true;
+  std::unique_ptr<BackfillCall> backfill_;
+  int backfill_rounds_ = 0;  // 本轮已发出的补传批数
+
+  // 管理者过载退避：在 backoff_until_ 之前不再推送
+  std::chrono::steady_clock::time_point backoff_until_;
+  int consecutive_rejects_ = 0;
+  std::mt19937 rng_{std::random_device{}()};
 };
 
 }  // namespace monitor
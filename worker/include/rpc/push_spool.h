@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "monitor_info.pb.h"
+
+namespace monitor {
+
+struct PushSpoolOptions {
+  std::string dir = "/var/tmp/monitor_worker_spool";  // spool 目录，不存在时自动创建
+  uint64_t max_bytes = 64ull << 20;      // 所有段合计的上限，超出时丢弃最旧的段
+  uint64_t segment_bytes = 4ull << 20;   // 单个段文件的大小上限
+};
+
+/**
+ * 推送失败时的本地落盘队列
+ *
+ * 与管理者断连期间，序列化后的 MonitorInfo 以帧的形式追加写入段文件
+ * （O_APPEND，每帧带 CRC32），重连后由 MonitorPusher 批量补传。
+ *
+ * 目录结构：
+ *   spool-<seq>.log  段文件，seq 递增；写满 segment_bytes 后切换到新段
+ *   cursor           已补传位置 {seq, offset}，写临时文件后 rename 原子替换
+ *
+ * 帧格式：[magic u32][length u32][crc32 u32][payload]，主机字节序。
+ * 进程崩溃留下的半帧在 Open 时按 CRC 校验截断；总大小超过 max_bytes 时
+ * 整段删除最旧的数据。
+ *
+ * 非线程安全，只由发送线程使用。
+ */
+class PushSpool {
+ public:
+  // 读取位置：段序号 + 段内偏移
+  struct Cursor {
+    uint64_t seq = 0;
+    uint64_t offset = 0;
+  };
+
+  struct Record {
+    std::string payload;  // 序列化后的 MonitorInfo
+    Cursor end;           // 该帧之后的位置，补传成功后提交到这里
+  };
+
+  explicit PushSpool(const PushSpoolOptions& options = PushSpoolOptions());
+  ~PushSpool();
+
+  PushSpool(const PushSpool&) = delete;
+  PushSpool& operator=(const PushSpool&) = delete;
+
+  // 创建目录、扫描已有段、截断半帧、加载游标
+  bool Open();
+
+  // 追加一条样本
+  bool Append(const monitor::proto::MonitorInfo& info);
+  bool AppendPayload(const std::string& payload);
+
+  // 从游标处读取最多 max_records 条、合计约 max_bytes 的记录，不移动游标
+  std::vector<Record> Peek(size_t max_records, size_t max_bytes);
+
+  // 确认补传到 cursor（由 Peek 返回的 Record::end），持久化并回收读完的段
+  void Commit(const Cursor& cursor);
+
+  bool Empty() const;
+  uint64_t PendingBytes() const;
+  uint64_t DroppedBytes() const { return dropped_bytes_; }
+  uint64_t CorruptFrames() const { return corrupt_frames_; }
+
+ private:
+  struct Segment {
+    uint64_t seq;
+    uint64_t size;
+  };
+
+  std::string SegmentPath(uint64_t seq) const;
+  bool OpenWriteSegment(uint64_t seq);
+  // 校验段内所有帧，返回最后一个完整帧之后的偏移
+  uint64_t ValidLength(const std::string& path, uint64_t size);
+  void EnforceLimit();
+  void LoadCursor();
+  void SaveCursor();
+  void ReleaseConsumed();
+
+  PushSpoolOptions options_;
+  std::deque<Segment> segments_;
+  int write_fd_ = -1;
+  Cursor read_;
+  uint64_t total_bytes_ = 0;
+  uint64_t dropped_bytes_ = 0;
+  uint64_t corrupt_frames_ = 0;
+  bool opened_ = false;
+};
+
+}  // namespace monitor
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "monitor_info.pb.h"
+
+namespace monitor {
+
+/**
+ * 采集线程与发送线程之间的有界环形缓冲
+ *
+ * 单生产者（采集线程）/ 单消费者（发送线程）。环满时覆盖最旧的样本：
+ * 发送端卡住时宁可丢掉最旧的数据，也不能让采集线程阻塞、打乱采样节奏。
+ * 每个采集周期只有一次入队，互斥锁的开销可以忽略。
+ */
+class SampleRing {
+ public:
+  explicit SampleRing(size_t capacity);
+
+  // 追加一条样本；环满时覆盖最旧的一条并返回 false
+  bool Push(monitor::proto::MonitorInfo&& info);
+  // 发送失败、稍后重试的样本放回队头；环已满时放弃该样本并返回 false
+  bool PushFront(monitor::proto::MonitorInfo&& info);
+  // 取出最旧的一条样本，环为空时返回 false
+  bool Pop(monitor::proto::MonitorInfo* info);
+
+  size_t Size() const;
+  uint64_t Dropped() const;
+
+ private:
+  mutable std::mutex mtx_;
+  std::vector<monitor::proto::MonitorInfo> slots_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+  uint64_t dropped_ = 0;
+};
+
+}  // namespace monitor
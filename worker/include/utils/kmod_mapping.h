@@ -0,0 +1,121 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "monitor/monitor_structs.h"
+
+namespace monitor {
+
+/**
+ * 内核模块字符设备的常驻只读映射
+ *
+ * 构造时 open + mmap 一次，fd 与映射一起保留（用于 Ioctl），
+ * 之后每次采样只是普通的内存读取，不再有 open / mmap / munmap / close。
+ *
+ * 模块重新加载后设备节点会重建：Get() 每隔 kRevalidateInterval 才 stat 一次
+ * 设备路径，与映射时的 (st_rdev, st_ino) 比较，不一致或节点已消失就解除映射
+ * 并重新映射；设备不存在时每隔 kRetryInterval 重试一次 open，
+ * 模块未加载时也不会每次采样都产生系统调用。
+ *
+ * 注意映射期间模块引用计数不为 0（file_operations.owner），rmmod 会返回 EBUSY；
+ * 先卸载模块再启动工作者，或模块被强制卸载、节点被替换时由上面的校验重新映射。
+ *
+ * 非线程安全。/dev/monitor_stats 的映射由 MetricCollector 创建一个实例，
+ * CPU 状态 / 软中断 / 平均负载三个监控项共享，只在采集线程中使用。
+ */
+class KmodMapping {
+ public:
+  KmodMapping(const std::string& path, size_t size);
+  ~KmodMapping();
+
+  KmodMapping(const KmodMapping&) = delete;
+  KmodMapping& operator=(const KmodMapping&) = delete;
+
+  // 当前有效的映射起始地址；设备不存在或映射失败时返回 nullptr
+  const void* Get();
+
+  // 在映射对应的设备 fd 上发起 ioctl；尚未映射时返回 -1（errno 为 ENODEV）
+  int Ioctl(unsigned long request, void* arg = nullptr);
+
+  template <typename T>
+  const T* As() {
+    return static_cast<const T*>(Get());
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  bool Map();
+  void Unmap();
+  // 设备节点已消失或已不是映射时的那个节点
+  bool Stale() const;
+
+  std::string path_;
+  size_t size_;
+  void* addr_ = nullptr;
+  int fd_ = -1;
+  dev_t rdev_ = 0;
+  ino_t ino_ = 0;
+  std::chrono::steady_clock::time_point next_check_;
+};
+
+/**
+ * 从统一映射（/dev/monitor_stats）中读取一个数据块的一致快照
+ *
+ * 校验 magic / ABI 版本，以及头页中该块的条目大小和范围不超出映射后，
+ * 按 seqlock 协议拷贝有效条目：读取前后 seq 不同或为奇数（内核正在更新）时
+ * 重试。内核每次更新只需几微秒，重试次数用尽说明映射已不可用。
+ *
+ * @param base      映射起始地址（KmodMapping::Get()）
+ * @param map_size  映射大小（KmodMapping::size()）
+ * @param block     块编号 MONITOR_BLOCK_*
+ * @param entries   输出：有效条目
+ * @param update_ns 输出：内核完成本次更新的单调时间（纳秒）
+ */
+template <typename Entry>
+bool ReadMonitorBlock(const void* base, size_t map_size, int block,
+                      std::vector<Entry>* entries, uint64_t* update_ns) {
+  constexpr int kMaxAttempts = 100;
+  const auto* header = static_cast<const struct monitor_shm_header*>(base);
+  if (header->magic != MONITOR_SHM_MAGIC ||
+      header->abi_version != MONITOR_SHM_ABI_VERSION) {
+    return false;
+  }
+  const struct monitor_shm_block& desc = header->blocks[block];
+  if (desc.entry_size != sizeof(Entry) ||
+      desc.offset + static_cast<size_t>(desc.capacity) * sizeof(Entry) >
+          map_size) {
+    return false;
+  }
+  const auto* data = reinterpret_cast<const Entry*>(
+      static_cast<const char*>(base) + desc.offset);
+
+  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+    uint32_t seq = __atomic_load_n(&header->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    uint32_t count = std::min<uint32_t>(
+        __atomic_load_n(&desc.count, __ATOMIC_RELAXED), desc.capacity);
+    entries->assign(data, data + count);
+    uint64_t ns = __atomic_load_n(&header->update_ns, __ATOMIC_RELAXED);
+    // 数据读取不得越过第二次读取 seq
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&header->seq, __ATOMIC_RELAXED) == seq) {
+      *update_ns = ns;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace monitor
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace monitor {
+
+/**
+ * procfs 文本文件的常驻读取器
+ *
+ * 构造时 open 一次并保留 fd，每次 Read() 从偏移 0 开始 pread 整个文件到
+ * 固定缓冲区，之后用 NextLine / NextField 以 string_view 就地切分，
+ * 数值用 ParseUint 解析。稳态下每次采样没有堆分配，也没有 open / close。
+ *
+ * 缓冲区不够时按 2 倍扩容后接着读，只发生在前几次采样（或设备数增长之后）。
+ * NextLine 返回的 string_view 指向内部缓冲区，下一次 Read() 之后失效。
+ *
+ * 非线程安全，每个监控项持有自己的实例。
+ */
+class ProcfsReader {
+ public:
+  explicit ProcfsReader(const char* path, size_t initial_size = 16 * 1024);
+  ~ProcfsReader();
+
+  ProcfsReader(const ProcfsReader&) = delete;
+  ProcfsReader& operator=(const ProcfsReader&) = delete;
+
+  // 重新读取整个文件并把行游标放回开头；文件打不开或读取失败时返回 false
+  bool Read();
+
+  // 依次取出下一行（不含换行符），读完返回 false
+  bool NextLine(std::string_view* line);
+
+  // 最近一次 Read() 得到的全部内容
+  std::string_view contents() const {
+    return std::string_view(buf_.get(), len_);
+  }
+  size_t capacity() const { return cap_; }
+
+ private:
+  bool Open();
+
+  std::string path_;
+  int fd_ = -1;
+  std::unique_ptr<char[]> buf_;
+  size_t cap_ = 0;
+  size_t len_ = 0;
+  size_t pos_ = 0;
+};
+
+// 跳过空白取出下一个字段，并把 line 前移到字段之后；没有字段时返回 false
+inline bool NextField(std::string_view* line, std::string_view* field) {
+  auto is_space = [](char c) { return c == ' ' || c == '\t'; };
+  size_t begin = 0;
+  while (begin < line->size() && is_space((*line)[begin])) {
+    ++begin;
+  }
+  if (begin == line->size()) {
+    *line = std::string_view();
+    return false;
+  }
+  size_t end = begin;
+  while (end < line->size() && !is_space((*line)[end])) {
+    ++end;
+  }
+  *field = line->substr(begin, end - begin);
+  line->remove_prefix(end);
+  return true;
+}
+
+// 十进制无符号整数，整个字段都必须是数字
+template <typename T>
+inline bool ParseUint(std::string_view field, T* value) {
+  static_assert(std::is_unsigned<T>::value, "ParseUint needs an unsigned type");
+  const char* end = field.data() + field.size();
+  auto result = std::from_chars(field.data(), end, *value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+// 取下一个字段并解析为整数；字段缺失或格式错误时 value 置 0 并返回 false
+template <typename T>
+inline bool NextUint(std::string_view* line, T* value) {
+  std::string_view field;
+  if (NextField(line, &field) && ParseUint(field, value)) {
+    return true;
+  }
+  *value = 0;
+  return false;
+}
+
+/**
+ * 编译期构造的完美哈希键表
+ *
+ * 在编译期搜索一个种子，使 N 个键在 Slots 个槽位中互不冲突，查找时只需
+ * 一次哈希和一次 string_view 比较。返回键在构造数组中的下标，找不到返回 -1。
+ *
+ *   static constexpr std::string_view kKeys[] = {"MemTotal", "MemFree"};
+ *   static constexpr StaticKeyTable<2> kTable(kKeys);
+ *   int index = kTable.Find(key);
+ */
+template <size_t N, size_t Slots = 4 * N>
+class StaticKeyTable {
+  static_assert(N > 0 && Slots >= N, "StaticKeyTable needs Slots >= N > 0");
+
+ public:
+  constexpr explicit StaticKeyTable(const std::string_view (&keys)[N])
+      : keys_(), slots_(), seed_(0) {
+    for (size_t i = 0; i < N; ++i) {
+      keys_[i] = keys[i];
+    }
+    for (uint32_t seed = 1; seed < 4096; ++seed) {
+      if (TryBuild(seed)) {
+        seed_ = seed;
+        return;
+      }
+    }
+    // 常量求值时抛出即编译错误：键重复或槽位太少
+    throw std::logic_error("StaticKeyTable: no collision-free seed");
+  }
+
+  constexpr int Find(std::string_view key) const {
+    int index = slots_[Hash(key, seed_) % Slots];
+    return index >= 0 && keys_[index] == key ? index : -1;
+  }
+
+  static constexpr size_t size() { return N; }
+
+ private:
+  // FNV-1a，种子参与初始值
+  static constexpr uint32_t Hash(std::string_view key, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 16777619u);
+    for (char c : key) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 16777619u;
+    }
+    return h;
+  }
+
+  constexpr bool TryBuild(uint32_t seed) {
+    for (size_t s = 0; s < Slots; ++s) {
+      slots_[s] = -1;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      size_t slot = Hash(keys_[i], seed) % Slots;
+      if (slots_[slot] >= 0) {
+        return false;
+      }
+      slots_[slot] = static_cast<int>(i);
+    }
+    return true;
+  }
+
+  std::string_view keys_[N];
+  int slots_[Slots];
+  uint32_t seed_;
+};
+
+}  // namespace monitor
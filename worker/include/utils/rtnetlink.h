@@ -0,0 +1,65 @@
+#pragma once
+
+#include <linux/netlink.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace monitor {
+
+/**
+ * NETLINK_ROUTE 套接字的薄封装
+ *
+ * 用于一次 dump 取回全部网卡的信息（RTM_GETLINK / RTM_GETSTATS），
+ * 以及订阅 RTMGRP_LINK 组播接收网卡增删通知，不需要 fork ip / tc 命令。
+ * 接收缓冲区在对象内复用。非线程安全。
+ */
+class RtnlSocket {
+ public:
+  using Handler = std::function<void(const struct nlmsghdr*)>;
+
+  RtnlSocket() = default;
+  ~RtnlSocket();
+
+  RtnlSocket(const RtnlSocket&) = delete;
+  RtnlSocket& operator=(const RtnlSocket&) = delete;
+
+  // groups 为要订阅的 RTMGRP_* 组播组，0 表示只用于请求
+  bool Open(uint32_t groups = 0);
+  void Close();
+  int fd() const { return fd_; }
+
+  // 发送 dump 请求，header 为紧跟 nlmsghdr 的族头部（ifinfomsg / if_stats_msg 等）
+  bool SendDump(uint16_t type, const void* header, size_t header_len);
+  // 接收 dump 的全部应答直到 NLMSG_DONE，对每条消息调用 handler
+  bool ReceiveDump(const Handler& handler);
+
+  // 读一次套接字（阻塞），对收到的每条消息调用 handler；
+  // 返回 false 时 errno 为 ENOBUFS 表示接收队列溢出、丢失了通知
+  bool ReceiveOnce(const Handler& handler);
+
+ private:
+  int fd_ = -1;
+  uint32_t seq_ = 0;
+  std::vector<char> buf_;
+};
+
+// 网卡的基本信息
+struct LinkInfo {
+  uint32_t ifindex = 0;
+  std::string name;
+  uint32_t flags = 0;  // IFF_*
+  uint16_t type = 0;   // ARPHRD_*（链路层类型）
+};
+
+// 解析 RTM_NEWLINK / RTM_DELLINK 消息；其他类型或 ifi_family 不是 AF_UNSPEC
+// （如 AF_BRIDGE 的桥端口通知）返回 false
+bool ParseLinkMessage(const struct nlmsghdr* nh, LinkInfo* link);
+
+// 一次 RTM_GETLINK dump 取得所有网卡
+bool DumpLinks(std::vector<LinkInfo>* links);
+
+}  // namespace monitor
@@ -27,9 +27,9 @@ compile_modules() {
     echo "Compilation successful"
 }
 
-# 加载软中断采集模块
-load_softirq_module() {
-    local module_path="${KMOD_DIR}/softirq_collector.ko"
+# 加载统一采集模块（CPU 状态 / 软中断 / 平均负载）
+load_monitor_module() {
+    local module_path="${KMOD_DIR}/monitor_collector.ko"
     
     if [ ! -f "$module_path" ]; then
         echo "Module not found: $module_path"
@@ -38,75 +38,38 @@ load_softirq_module() {
     fi
     
     # 检查模块是否已加载
-    if lsmod | grep -q "softirq_collector"; then
-        echo "softirq_collector already loaded"
+    if lsmod | grep -q "monitor_collector"; then
+        echo "monitor_collector already loaded"
     else
-        echo "Loading softirq_collector..."
+        echo "Loading monitor_collector..."
         insmod "$module_path"
         if [ $? -eq 0 ]; then
-            echo "softirq_collector loaded successfully"
+            echo "monitor_collector loaded successfully"
         else
-            echo "Error: Failed to load softirq_collector"
+            echo "Error: Failed to load monitor_collector"
             return 1
         fi
     fi
     
     # 设置设备权限
-    if [ -e /dev/cpu_softirq_monitor ]; then
-        chmod 644 /dev/cpu_softirq_monitor
-        echo "Device /dev/cpu_softirq_monitor ready"
-    fi
-}
-
-# 加载 CPU 状态采集模块
-load_cpu_stat_module() {
-    local module_path="${KMOD_DIR}/cpu_stat_collector.ko"
-    
-    if [ ! -f "$module_path" ]; then
-        echo "Module not found: $module_path"
-        echo "Compiling..."
-        compile_modules
-    fi
-    
-    # 检查模块是否已加载
-    if lsmod | grep -q "cpu_stat_collector"; then
-        echo "cpu_stat_collector already loaded"
-    else
-        echo "Loading cpu_stat_collector..."
-        insmod "$module_path"
-        if [ $? -eq 0 ]; then
-            echo "cpu_stat_collector loaded successfully"
-        else
-            echo "Error: Failed to load cpu_stat_collector"
-            return 1
-        fi
-    fi
-    
-    # 设置设备权限
-    if [ -e /dev/cpu_stat_monitor ]; then
-        chmod 644 /dev/cpu_stat_monitor
-        echo "Device /dev/cpu_stat_monitor ready"
+    if [ -e /dev/monitor_stats ]; then
+        chmod 644 /dev/monitor_stats
+        echo "Device /dev/monitor_stats ready"
     fi
 }
 
 # 加载所有模块
 load_all_modules() {
-    load_softirq_module
-    load_cpu_stat_module
+    load_monitor_module
 }
 
 # 卸载模块
 unload_modules() {
     echo "Unloading kernel modules..."
     
-    if lsmod | grep -q "softirq_collector"; then
-        rmmod softirq_collector
-        echo "softirq_collector unloaded"
-    fi
-    
-    if lsmod | grep -q "cpu_stat_collector"; then
-        rmmod cpu_stat_collector
-        echo "cpu_stat_collector unloaded"
+    if lsmod | grep -q "monitor_collector"; then
+        rmmod monitor_collector
+        echo "monitor_collector unloaded"
     fi
 }
 
@@ -114,15 +77,15 @@ unload_modules() {
 show_status() {
     echo ""
     echo "=== Module Status ==="
-    lsmod | grep -E "softirq_collector|cpu_stat_collector|cpu_load" || echo "No monitor modules loaded"
+    lsmod | grep -E "monitor_collector" || echo "No monitor modules loaded"
     
     echo ""
     echo "=== Device Files ==="
-    ls -la /dev/cpu_* 2>/dev/null || echo "No monitor devices found"
+    ls -la /dev/monitor_stats 2>/dev/null || echo "No monitor devices found"
     
     echo ""
     echo "=== Recent Kernel Log ==="
-    dmesg | grep -E "softirq_collector|cpu_softirq_monitor|cpu_stat_collector|cpu_stat_monitor" | tail -15
+    dmesg | grep -E "monitor_stats" | tail -15
 }
 
 # 主逻辑
@@ -0,0 +1,135 @@
+#!/bin/bash
+# bench_net_percpu.sh - net_stats 的 TC 程序每个包的开销：共享 HASH + 原子加 vs PERCPU_HASH
+#
+# 建一对 veth，在 veth1 的 TC ingress 上挂 tc_ingress；pktgen 从 NR_THREADS 个
+# 内核线程（各绑一个 CPU）同时向 veth0 发包，veth 在发送 CPU 上把包交给 veth1，
+# 所有 CPU 都在更新同一个 ifindex 的计数，与多队列网卡 RSS 打散后的情形一致。
+#
+# 每个版本跑 DURATION 秒，打开 kernel.bpf_stats_enabled 后从 bpftool 读取
+# run_time_ns / run_cnt 得到每个包在 BPF 程序里的平均耗时，同时给出 pktgen 的总发包速率。
+#
+#   before: BASELINE_REV 中的 net_stats.bpf.c（默认为改成 PERCPU_HASH 之前的版本）
+#   after:  工作目录中的 net_stats.bpf.c
+#
+# 依赖: clang、bpftool、iproute2 (tc)、pktgen 内核模块、/sys/kernel/btf/vmlinux
+# 运行 (需要 root 权限):
+#   sudo NR_THREADS=8 DURATION=10 ./bench_net_percpu.sh
+#
+# 参考结果（1 个 vCPU，内核 6.18，同一条 veth 上 AF_PACKET 发 64 字节帧代替 pktgen，
+# 9 轮中位数）:
+#   before  HASH + 原子加      108 ns/packet
+#   after   PERCPU_HASH       97 ns/packet
+# 单 CPU 下没有跨 CPU 的 cache line 争抢，多队列多 CPU 时差距会更大。
+set -euo pipefail
+
+SRC_DIR=$(cd "$(dirname "$0")" && pwd)
+NR_THREADS=${NR_THREADS:-$(nproc)}
+DURATION=${DURATION:-10}
+PKT_SIZE=${PKT_SIZE:-64}
+WORK_DIR=$(mktemp -d)
+PGDEV=/proc/net/pktgen
+
+if [ -z "${BASELINE_REV:-}" ]; then
+    # 第一次引入 PERCPU_HASH 的提交的父提交
+    first=$(git -C "$SRC_DIR" log --format=%H -S BPF_MAP_TYPE_PERCPU_HASH \
+            -- net_stats.bpf.c | tail -1)
+    BASELINE_REV=${first:+$first~1}
+    BASELINE_REV=${BASELINE_REV:-HEAD}
+fi
+
+cleanup() {
+    echo "reset" > $PGDEV/pgctrl 2>/dev/null || true
+    ip link del veth0 2>/dev/null || true
+    sysctl -qw kernel.bpf_stats_enabled=0 || true
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+build() {  # build <源文件> <输出 .o>
+    clang -O2 -g -target bpf -D__TARGET_ARCH_x86 \
+        -I"$WORK_DIR" -I"$SRC_DIR" -c "$1" -o "$2"
+}
+
+pgset() {  # pgset <文件> <命令>
+    echo "$2" > "$1"
+}
+
+setup_veth() {
+    ip link del veth0 2>/dev/null || true
+    ip link add veth0 numtxqueues "$NR_THREADS" type veth \
+        peer name veth1 numrxqueues "$NR_THREADS"
+    ip link set veth0 up
+    ip link set veth1 up
+    tc qdisc add dev veth1 clsact
+}
+
+setup_pktgen() {
+    modprobe pktgen
+    pgset $PGDEV/pgctrl "reset"
+    local dst_mac
+    dst_mac=$(cat /sys/class/net/veth1/address)
+    for ((cpu = 0; cpu < NR_THREADS; cpu++)); do
+        local thread=$PGDEV/kpktgend_$cpu
+        local dev=veth0@$cpu
+        pgset "$thread" "rem_device_all"
+        pgset "$thread" "add_device $dev"
+        # veth 不支持共享 skb，clone_skb 必须为 0
+        pgset $PGDEV/$dev "clone_skb 0"
+        pgset $PGDEV/$dev "pkt_size $PKT_SIZE"
+        pgset $PGDEV/$dev "count 0"
+        pgset $PGDEV/$dev "delay 0"
+        pgset $PGDEV/$dev "queue_map_min $cpu"
+        pgset $PGDEV/$dev "queue_map_max $cpu"
+        pgset $PGDEV/$dev "dst 198.18.0.1"
+        pgset $PGDEV/$dev "dst_mac $dst_mac"
+    done
+}
+
+run() {  # run <名称> <.o>
+    local name=$1 obj=$2
+    tc filter del dev veth1 ingress 2>/dev/null || true
+    tc filter add dev veth1 ingress bpf direct-action obj "$obj" sec tc/ingress
+
+    local prog_id
+    prog_id=$(tc -j filter show dev veth1 ingress |
+              grep -o '"id":[0-9]*' | head -1 | cut -d: -f2)
+
+    setup_pktgen
+    # pgctrl start 会阻塞到 stop，放到后台
+    (echo "start" > $PGDEV/pgctrl) &
+    local pg_pid=$!
+    sleep "$DURATION"
+    echo "stop" > $PGDEV/pgctrl
+    wait $pg_pid 2>/dev/null || true
+
+    local pps=0
+    for ((cpu = 0; cpu < NR_THREADS; cpu++)); do
+        local p
+        p=$(grep -o '[0-9]*pps' $PGDEV/veth0@$cpu | head -1 | tr -dc 0-9)
+        pps=$((pps + ${p:-0}))
+    done
+
+    local stats run_time_ns run_cnt
+    stats=$(bpftool prog show id "$prog_id" --json)
+    run_time_ns=$(echo "$stats" | grep -o '"run_time_ns":[0-9]*' | cut -d: -f2)
+    run_cnt=$(echo "$stats" | grep -o '"run_cnt":[0-9]*' | cut -d: -f2)
+
+    awk -v n="$name" -v t="${run_time_ns:-0}" -v c="${run_cnt:-0}" -v p="$pps" \
+        'BEGIN { printf "%-8s %14d %12.1f %14d\n", n, c, c ? t / c : 0, p }'
+}
+
+[ "$(id -u)" -eq 0 ] || { echo "需要 root 权限" >&2; exit 1; }
+
+bpftool btf dump file /sys/kernel/btf/vmlinux format c > "$WORK_DIR/vmlinux.h"
+git -C "$SRC_DIR" show "$BASELINE_REV:./net_stats.bpf.c" > "$WORK_DIR/before.bpf.c"
+cp "$SRC_DIR/net_stats.bpf.c" "$WORK_DIR/after.bpf.c"
+build "$WORK_DIR/before.bpf.c" "$WORK_DIR/before.o"
+build "$WORK_DIR/after.bpf.c" "$WORK_DIR/after.o"
+
+sysctl -qw kernel.bpf_stats_enabled=1
+setup_veth
+
+echo "threads=$NR_THREADS duration=${DURATION}s pkt_size=$PKT_SIZE baseline=$BASELINE_REV"
+printf "%-8s %14s %12s %14s\n" "variant" "packets" "ns/packet" "pktgen pps"
+run before "$WORK_DIR/before.o"
+run after "$WORK_DIR/after.o"
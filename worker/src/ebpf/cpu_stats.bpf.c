@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * cpu_stats.bpf.c - 基于 perf 事件的 CPU 时间与软中断计数采集程序（CO-RE）
+ *
+ * 功能：
+ * 1. 用户空间在每个在线 CPU 上打开一个 PERF_COUNT_SW_CPU_CLOCK 采样事件，
+ *    周期到达时本程序在该 CPU 上运行
+ * 2. 通过 typed ksym 读取本 CPU 的 kernel_cpustat.cpustat[] 与 kstat.softirqs[]，
+ *    写入 PERCPU_ARRAY map 中属于本 CPU 的那一份，不需要原子操作
+ * 3. 用户空间一次 bpf_map_lookup_elem 取回所有 CPU 的值
+ *
+ * 与内核模块 monitor_collector 读取的是同一组内核计数，但不需要针对每个内核
+ * 重新编译，也不会污染内核（taint）。结构体与字段表来自 monitor_structs.h。
+ *
+ * NO_HZ 下 cpustat[CPUTIME_IDLE / IOWAIT] 不包含 tickless 空闲时间，
+ * 与 /proc/stat 一样优先使用 tick_cpu_sched 中的 idle_sleeptime / iowait_sleeptime。
+ * 采样中断会先结束当前空闲区间（tick_nohz_irq_enter），读到的值已是最新的。
+ */
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+
+#include "../../include/monitor/monitor_structs.h"
+
+#ifndef bpf_ksym_exists
+#define bpf_ksym_exists(sym) (!!(&(sym)))
+#endif
+
+extern struct kernel_cpustat kernel_cpustat __ksym;
+extern struct kernel_stat kstat __ksym;
+/* 静态 per-CPU 变量，未编入 BTF 的内核上为空，回退到 cpustat[] */
+extern struct tick_sched tick_cpu_sched __ksym __weak;
+
+/* 各 CPU 的 CPU 时间，单位纳秒 */
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct cpu_stat_sample);
+} cpu_stat_map SEC(".maps");
+
+/* 各 CPU 的软中断累计次数 */
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct softirq_sample);
+} softirq_map SEC(".maps");
+
+/* 按字段表展开的填充代码 */
+#define FILL_CPUTIME(name, index)  cs->stat.name = kcs->cpustat[index];
+#define FILL_SOFTIRQ(name, index)  sq->stat.name = ks->softirqs[index];
+
+SEC("perf_event")
+int sample_cpu_stats(struct bpf_perf_event_data *ctx)
+{
+    const struct kernel_cpustat *kcs;
+    const struct kernel_stat *ks;
+    struct cpu_stat_sample *cs;
+    struct softirq_sample *sq;
+    __u64 now = bpf_ktime_get_ns();
+    __u32 key = 0;
+
+    cs = bpf_map_lookup_elem(&cpu_stat_map, &key);
+    sq = bpf_map_lookup_elem(&softirq_map, &key);
+    if (!cs || !sq)
+        return 0;
+
+    kcs = bpf_this_cpu_ptr(&kernel_cpustat);
+    ks = bpf_this_cpu_ptr(&kstat);
+
+    MONITOR_CPU_STAT_FIELDS(FILL_CPUTIME)
+    if (bpf_ksym_exists(tick_cpu_sched)) {
+        const struct tick_sched *ts = bpf_this_cpu_ptr(&tick_cpu_sched);
+
+        /* 未启用 NO_HZ 时 idle_sleeptime 始终为 0，保留 cpustat[] 的值 */
+        if (ts->idle_sleeptime) {
+            cs->stat.idle = ts->idle_sleeptime;
+            cs->stat.iowait = ts->iowait_sleeptime;
+        }
+    }
+    cs->update_ns = now;
+
+    MONITOR_SOFTIRQ_FIELDS(FILL_SOFTIRQ)
+    sq->update_ns = now;
+
+    return 0;
+}
+
+char LICENSE[] SEC("license") = "GPL";
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * flow_stats.bpf.c - 基于 TC Hook 的按流流量统计程序
+ *
+ * 与 net_stats.bpf.c 挂在同样的 TC ingress / egress 上（不同的 priority，
+ * 两者都返回 TC_ACT_UNSPEC，让同一 hook 上后面的过滤器继续执行），
+ * 按 (网卡, 协议, 本端地址:端口, 对端地址:端口) 在内核中累加字节数与包数，
+ * 用户空间每个周期把整个 map 读出并删除（bpf_map_lookup_and_delete_batch），
+ * 取流量最大的前 N 条。聚合全部在内核完成，用户空间的开销只与流的条数有关，
+ * 与包数无关。
+ *
+ * 方向以本机为准：入方向包的目的地址、出方向包的源地址记为本端，
+ * 同一条连接的收发计入同一个 key。
+ *
+ * 只解析以太网上的 IPv4 / IPv6（不含 VLAN 与 IPv6 扩展头），用户空间只把它
+ * 挂在 ARPHRD_ETHER 网卡上；TCP / UDP 取端口，
+ * 其他协议端口记为 0；IPv4 地址以 IPv4-mapped IPv6（::ffff:a.b.c.d）存放。
+ */
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_endian.h>
+
+/* TC 返回值 */
+#define TC_ACT_UNSPEC   -1
+
+#define ETH_P_IP        0x0800
+#define ETH_P_IPV6      0x86DD
+#define IP_OFFSET       0x1FFF
+
+/* 流的 key - 与用户空间共享，填充字节必须清零 */
+struct flow_key {
+    __u8 local_addr[16];
+    __u8 remote_addr[16];
+    __u16 local_port;       /* 主机字节序 */
+    __u16 remote_port;
+    __u32 ifindex;
+    __u8 protocol;          /* IPPROTO_* */
+    __u8 pad[3];
+};
+
+/* 流的计数 - 与用户空间共享 */
+struct flow_stats {
+    __u64 rcv_bytes;
+    __u64 rcv_packets;
+    __u64 snd_bytes;
+    __u64 snd_packets;
+};
+
+/*
+ * BPF LRU Per-CPU Hash Map: key = flow_key, value = flow_stats
+ *
+ * 与 net_stats_map 一样每个 CPU 各有一份 value，数据包路径上只做普通加法；
+ * 条目数有上限，map 满时淘汰最久没有流量的流，不会无限增长，也不会因为
+ * map 满而漏掉新出现的大流量。用户空间每个周期读出后删除，map 中只保留
+ * 一个周期内活跃的流。内核内存约为 max_entries * 可能的 CPU 数 * 32 字节。
+ */
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_PERCPU_HASH);
+    __uint(max_entries, 8192);
+    __type(key, struct flow_key);
+    __type(value, struct flow_stats);
+} flow_stats_map SEC(".maps");
+
+static __always_inline void set_ipv4(__u8 *addr, __be32 ip)
+{
+    /* ::ffff:a.b.c.d，前 10 字节已由调用者清零 */
+    addr[10] = 0xff;
+    addr[11] = 0xff;
+    __builtin_memcpy(addr + 12, &ip, sizeof(ip));
+}
+
+/*
+ * 从包头解析出流的 key；不是以太网上的 IPv4 / IPv6 时返回 false
+ * TC 上 skb->data 在以太网设备的两个方向都指向以太网头；三层协议取
+ * skb->protocol（协议栈设置，VLAN 由硬件剥离时也是内层协议），不读 h_proto
+ */
+static __always_inline bool parse_flow(struct __sk_buff *skb, bool is_rx,
+                                       struct flow_key *key)
+{
+    void *data = (void *)(long)skb->data;
+    void *data_end = (void *)(long)skb->data_end;
+    struct ethhdr *eth = data;
+    __u8 *saddr_dst, *daddr_dst;
+    void *l4 = NULL;
+
+    if ((void *)(eth + 1) > data_end)
+        return false;
+
+    /* 入方向：对端是源；出方向：对端是目的 */
+    saddr_dst = is_rx ? key->remote_addr : key->local_addr;
+    daddr_dst = is_rx ? key->local_addr : key->remote_addr;
+
+    if (skb->protocol == bpf_htons(ETH_P_IP)) {
+        struct iphdr *iph = (void *)(eth + 1);
+
+        if ((void *)(iph + 1) > data_end || iph->ihl < 5)
+            return false;
+        key->protocol = iph->protocol;
+        set_ipv4(saddr_dst, iph->saddr);
+        set_ipv4(daddr_dst, iph->daddr);
+        /* 非首个分片没有 L4 头 */
+        if (!(iph->frag_off & bpf_htons(IP_OFFSET)))
+            l4 = (void *)iph + iph->ihl * 4;
+    } else if (skb->protocol == bpf_htons(ETH_P_IPV6)) {
+        struct ipv6hdr *ip6 = (void *)(eth + 1);
+
+        if ((void *)(ip6 + 1) > data_end)
+            return false;
+        key->protocol = ip6->nexthdr;
+        __builtin_memcpy(saddr_dst, &ip6->saddr, 16);
+        __builtin_memcpy(daddr_dst, &ip6->daddr, 16);
+        l4 = ip6 + 1;
+    } else {
+        return false;
+    }
+
+    if (l4 && (key->protocol == IPPROTO_TCP || key->protocol == IPPROTO_UDP)) {
+        /* TCP / UDP 头的前 4 字节都是源端口、目的端口；不在线性区时记为 0 */
+        __be16 *ports = l4;
+
+        if ((void *)(ports + 2) <= data_end) {
+            __u16 sport = bpf_ntohs(ports[0]);
+            __u16 dport = bpf_ntohs(ports[1]);
+
+            key->remote_port = is_rx ? sport : dport;
+            key->local_port = is_rx ? dport : sport;
+        }
+    }
+    return true;
+}
+
+/*
+ * 更新流的统计数据
+ * 与 net_stats.bpf.c 的 update_stats 相同：只访问本 CPU 的 value
+ */
+static __always_inline void update_flow(struct __sk_buff *skb, bool is_rx)
+{
+    struct flow_key key = {};
+    struct flow_stats zero = {};
+    struct flow_stats *stats;
+    __u32 len = skb->len;
+
+    if (skb->ifindex == 0 || len == 0)
+        return;
+    if (!parse_flow(skb, is_rx, &key))
+        return;
+    key.ifindex = skb->ifindex;
+
+    stats = bpf_map_lookup_elem(&flow_stats_map, &key);
+    if (!stats) {
+        /* 新的流：插入全 0 的条目后再查一次（map 满时淘汰最旧的流） */
+        bpf_map_update_elem(&flow_stats_map, &key, &zero, BPF_NOEXIST);
+        stats = bpf_map_lookup_elem(&flow_stats_map, &key);
+        if (!stats)
+            return;
+    }
+
+    if (is_rx) {
+        stats->rcv_bytes += len;
+        stats->rcv_packets++;
+    } else {
+        stats->snd_bytes += len;
+        stats->snd_packets++;
+    }
+}
+
+SEC("tc/ingress")
+int tc_flow_ingress(struct __sk_buff *skb)
+{
+    update_flow(skb, true);
+    return TC_ACT_UNSPEC;
+}
+
+SEC("tc/egress")
+int tc_flow_egress(struct __sk_buff *skb)
+{
+    update_flow(skb, false);
+    return TC_ACT_UNSPEC;
+}
+
+char LICENSE[] SEC("license") = "GPL";
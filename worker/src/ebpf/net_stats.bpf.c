@@ -5,7 +5,7 @@
  * 功能：
  * 1. 使用 TC (Traffic Control) hook 挂载到网络协议栈
  * 2. 在 ingress/egress 方向分别统计流量
- * 3. 通过 BPF map 将数据暴露给用户空间
+ * 3. 通过 BPF per-CPU map 将数据暴露给用户空间，由用户空间按 CPU 求和
  *
  * Hook 点：
  * - TC ingress: 入方向（接收）- 数据包进入协议栈时
@@ -18,8 +18,8 @@
  */
 //这段代码是一个挂载在 Linux 内核流量控制（TC）层的 eBPF 程序，
 // 它通过在网络接口的入口（Ingress）和出口（Egress）拦截数据包，
-// 利用原子操作实时统计每个网卡的接收与发送流量（包括字节数和包数），
-// 并将这些统计数据保存在内核 BPF 哈希映射中供用户空间程序读取，最后无损放行数据包。
+// 按 CPU 分别统计每个网卡的接收与发送流量（包括字节数和包数），
+// 并将这些统计数据保存在内核 BPF per-CPU 哈希映射中供用户空间程序读取，最后无损放行数据包。
 #include "vmlinux.h"
 #include <bpf/bpf_helpers.h>
 #include <bpf/bpf_endian.h>
@@ -37,48 +37,52 @@ struct net_stats {
     __u64 snd_packets;    /* 发送包数 */
 };
 
-/* 
- * BPF Hash Map: key = ifindex (网卡索引), value = net_stats
+/*
+ * BPF Per-CPU Hash Map: key = ifindex (网卡索引), value = net_stats
  * 使用 ifindex 作为 key，用户空间通过 if_indextoname() 转换为网卡名
+ *
+ * 每个 CPU 各有一份 value，数据包路径上只改本 CPU 的那一份，不需要原子操作，
+ * 多队列网卡的各个 CPU 之间也不会争抢同一条 cache line；
+ * 用户空间一次 bpf_map_lookup_elem 取回所有 CPU 的值再求和。
+ * ifindex 不连续且可能很大（容器里的 veth），因此用 HASH 而不是 ARRAY。
  */
 struct {
-    __uint(type, BPF_MAP_TYPE_HASH);
-    __uint(max_entries, 64);        /* 最多支持 64 个网卡 */
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, 1024);      /* 最多支持 1024 个网卡（含容器 veth） */
     __type(key, __u32);             /* ifindex */
     __type(value, struct net_stats);
 } net_stats_map SEC(".maps");
 
 /*
  * 更新网卡统计数据
- * 使用原子操作确保多 CPU 并发安全
+ * 只访问本 CPU 的 value，普通加法即可
  */
 static __always_inline void update_stats(__u32 ifindex, __u32 len, bool is_rx)
 {
     //告诉编译器（Clang/LLVM），在编译的时候，不要生成一个真正的函数调用指令（比如 call），
     // 而是直接把这个函数里的所有代码复制粘贴到调用它的地方（即 tc_ingress 和 tc_egress 函数内部）
+    struct net_stats zero = {};
     struct net_stats *stats;
-    struct net_stats new_stats = {};
 
     stats = bpf_map_lookup_elem(&net_stats_map, &ifindex);
     if (!stats) {
-        /* 首次看到此网卡，初始化统计 */
-        if (is_rx) {
-            new_stats.rcv_bytes = len;
-            new_stats.rcv_packets = 1;
-        } else {
-            new_stats.snd_bytes = len;
-            new_stats.snd_packets = 1;
-        }
-        bpf_map_update_elem(&net_stats_map, &ifindex, &new_stats, BPF_ANY);
+        /*
+         * 首次看到此网卡：插入全 0 的条目后再查一次。
+         * BPF_NOEXIST 保证多个 CPU 同时插入时只有一个成功，
+         * 其余的拿到已有条目，不会互相覆盖掉已经累加的计数。
+         */
+        bpf_map_update_elem(&net_stats_map, &ifindex, &zero, BPF_NOEXIST);
+        stats = bpf_map_lookup_elem(&net_stats_map, &ifindex);
+        if (!stats)
+            return;     /* map 已满 */
+    }
+
+    if (is_rx) {
+        stats->rcv_bytes += len;        //接收到的总字节数
+        stats->rcv_packets++;           //接收到的总包数
     } else {
-        /* 使用原子操作更新已有统计 */
-        if (is_rx) {
-            __sync_fetch_and_add(&stats->rcv_bytes, len);//接收到的总字节数
-            __sync_fetch_and_add(&stats->rcv_packets, 1);//接收到的总包数
-        } else {
-            __sync_fetch_and_add(&stats->snd_bytes, len);//发送的总字节数
-            __sync_fetch_and_add(&stats->snd_packets, 1);//发送的总包数
-        }
+        stats->snd_bytes += len;        //发送的总字节数
+        stats->snd_packets++;           //发送的总包数
     }
 }
 
@@ -96,12 +100,12 @@ int tc_ingress(struct __sk_buff *skb)
 
     /* 过滤无效数据 */
     if (ifindex == 0 || len == 0)
-        return TC_ACT_OK;
+        return TC_ACT_UNSPEC;
 
     update_stats(ifindex, len, true);
 
-    /* TC_ACT_OK: 继续正常处理，不影响数据包 */
-    return TC_ACT_OK;
+    /* TC_ACT_UNSPEC: 交给同一 hook 上的下一个过滤器（如 flow_stats），没有则正常放行 */
+    return TC_ACT_UNSPEC;
 }
 
 /*
@@ -117,12 +121,12 @@ int tc_egress(struct __sk_buff *skb)
 
     /* 过滤无效数据 */
     if (ifindex == 0 || len == 0)
-        return TC_ACT_OK;
+        return TC_ACT_UNSPEC;
 
     update_stats(ifindex, len, false);
 
-    /* TC_ACT_OK: 继续正常处理，不影响数据包 */
-    return TC_ACT_OK;
+    /* TC_ACT_UNSPEC: 交给同一 hook 上的下一个过滤器（如 flow_stats），没有则正常放行 */
+    return TC_ACT_UNSPEC;
 }
 
 char LICENSE[] SEC("license") = "GPL";
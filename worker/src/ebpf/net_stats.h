@@ -14,7 +14,11 @@ extern "C" {
 
 #include <stdint.h>
 
-/* 网络统计结构体 - 与 eBPF 程序共享 */
+/*
+ * 网络统计结构体 - 与 eBPF 程序共享
+ * net_stats_map 是 PERCPU_HASH，按 key 查找得到的是每个可能的 CPU 一份的数组
+ * （libbpf_num_possible_cpus() 个），需要求和
+ */
 struct net_stats {
     uint64_t rcv_bytes;      /* 接收字节数 */
     uint64_t rcv_packets;    /* 接收包数 */
@@ -26,7 +30,7 @@ struct net_stats {
 #define NET_STATS_MAP_NAME "net_stats_map"
 
 /* 最大网卡数量 */
-#define MAX_NET_DEVICES 64
+#define MAX_NET_DEVICES 1024
 
 #ifdef __cplusplus
 }
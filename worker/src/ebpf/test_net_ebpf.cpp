@@ -158,6 +158,8 @@ int main() {
     printf("Monitoring network traffic... Press Ctrl+C to stop.\n\n");
 
     int map_fd = bpf_map__fd(skel->maps.net_stats_map);
+    // PERCPU_HASH：每次查找取回每个可能的 CPU 一份
+    std::vector<struct net_stats> percpu(libbpf_num_possible_cpus());
 
     // 上一次的统计数据
     struct {
@@ -176,7 +178,14 @@ int main() {
         struct net_stats stats;
 
         while (bpf_map_get_next_key(map_fd, &key, &next_key) == 0) {
-            if (bpf_map_lookup_elem(map_fd, &next_key, &stats) == 0) {
+            if (bpf_map_lookup_elem(map_fd, &next_key, percpu.data()) == 0) {
+                stats = {};
+                for (const auto& cpu : percpu) {
+                    stats.rcv_bytes += cpu.rcv_bytes;
+                    stats.rcv_packets += cpu.rcv_packets;
+                    stats.snd_bytes += cpu.snd_bytes;
+                    stats.snd_packets += cpu.snd_packets;
+                }
                 char ifname[IF_NAMESIZE];
                 if (if_indextoname(next_key, ifname) != nullptr) {
                     // 计算速率 (2秒间隔)
@@ -0,0 +1,486 @@
+/*
+ * monitor_collector.c - CPU 状态 / 软中断 / 平均负载统一采集内核模块
+ *
+ * 功能：
+ * 1. 在内核空间分配一块共享内存：头页 + cpu_stat 块 + softirq 块 + cpu_load 块
+ * 2. 每次更新遍历一次 for_each_possible_cpu，同时填充
+ *    per_cpu(kstat_cpu, cpu).cpustat[] 与 kstat_softirqs_cpu()，再读取 avenrun[]
+ * 3. 注册字符设备 /dev/monitor_stats，通过一次 mmap 暴露给用户空间的三个监控项
+ * 4. 头页带 magic、ABI 版本、各块描述、seqlock 序号和更新时间，
+ *    用户空间按 seqlock 协议读取，不会读到两次更新混在一起的数据
+ * 5. 更新时机：
+ *    - MONITOR_IOC_SNAPSHOT：用户空间读取前发起，在调用者上下文中立即刷新，
+ *      读到的是调用时刻的值
+ *    - 后台高精度定时器：间隔由模块参数 refresh_ms 或 MONITOR_IOC_SET_REFRESH_MS
+ *      设置，0 关闭定时器，没有读者时内核不做任何工作
+ *
+ * 共享结构体与字段表定义在 worker/include/monitor/monitor_structs.h，
+ * 本模块与用户空间包含同一个头文件。
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/fs.h>
+#include <linux/cdev.h>
+#include <linux/device.h>
+#include <linux/mm.h>
+#include <linux/slab.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/interrupt.h>
+#include <linux/kernel_stat.h>
+#include <linux/cpumask.h>
+#include <linux/sched/loadavg.h>
+#include <linux/version.h>
+#include <linux/tick.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+#include <linux/capability.h>
+#include <linux/uaccess.h>
+#include <linux/moduleparam.h>
+#include <asm/io.h>
+
+#include "monitor_structs.h"
+
+#define DEVICE_NAME "monitor_stats"
+#define CLASS_NAME  "monitor_stats"
+
+/* 将纳秒转换为 jiffies（clock_t）- 内联实现 */
+static inline u64 nsec_to_jiffies(u64 nsec)
+{
+    return div_u64(nsec, NSEC_PER_SEC / HZ);
+}
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Monitor System");
+MODULE_DESCRIPTION("CPU, softirq and load statistics collector via mmap");
+MODULE_VERSION("2.1");
+
+/* 后台刷新间隔（毫秒），0 表示只在 SNAPSHOT 时刷新 */
+static unsigned int refresh_ms = 1000;
+module_param(refresh_ms, uint, 0444);
+MODULE_PARM_DESC(refresh_ms, "Background refresh interval in ms, 0 disables the timer (default 1000)");
+
+/* 全局变量 */
+static dev_t dev_num;
+static struct cdev monitor_cdev;
+static struct class *monitor_class;
+static struct device *monitor_device;
+
+static void *shm_base;                          /* 共享内存区域：头页 + 各数据块 */
+static struct monitor_shm_header *shm_header;   /* 头页 */
+static struct cpu_stat *cpu_stat_data;          /* cpu_stat 块 */
+static struct softirq_stat *softirq_data;       /* softirq 块 */
+static struct cpu_load *cpu_load_data;          /* cpu_load 块 */
+static unsigned long data_size;                 /* 共享内存区域大小 */
+
+static struct hrtimer update_timer;             /* 高精度定时器 */
+static ktime_t timer_interval;                  /* 定时器间隔 */
+
+/* 定时器回调（硬中断上下文）与 SNAPSHOT ioctl 都会写共享内存，写端互斥 */
+static DEFINE_SPINLOCK(update_lock);
+/* 串行化定时器的启停 */
+static DEFINE_MUTEX(timer_lock);
+
+/*
+ * seqlock 写端：调用者持有 update_lock
+ */
+static inline void shm_write_begin(void)
+{
+    WRITE_ONCE(shm_header->seq, shm_header->seq + 1);
+    smp_wmb();
+}
+
+static inline void shm_write_end(void)
+{
+    shm_header->update_ns = ktime_get_ns();
+    smp_wmb();
+    WRITE_ONCE(shm_header->seq, shm_header->seq + 1);
+}
+
+/*
+ * 获取 CPU 空闲时间
+ * 需要考虑 NO_HZ 模式下的空闲时间统计
+ */
+static u64 cpu_stat_get_idle_time(int cpu)
+{
+    u64 idle_time = get_cpu_idle_time_us(cpu, NULL);
+
+    if (idle_time == -1ULL) {
+        /* 回退到传统方式 */
+        return nsec_to_jiffies(kcpustat_cpu(cpu).cpustat[CPUTIME_IDLE]);
+    }
+    /* 转换微秒到 clock_t */
+    return usecs_to_jiffies(idle_time);
+}
+
+/*
+ * 获取 CPU I/O 等待时间
+ * 需要考虑 NO_HZ 模式下的 iowait 时间统计
+ */
+static u64 cpu_stat_get_iowait_time(int cpu)
+{
+    u64 iowait_time = get_cpu_iowait_time_us(cpu, NULL);
+
+    if (iowait_time == -1ULL) {
+        /* 回退到传统方式 */
+        return nsec_to_jiffies(kcpustat_cpu(cpu).cpustat[CPUTIME_IOWAIT]);
+    }
+    /* 转换微秒到 clock_t */
+    return usecs_to_jiffies(iowait_time);
+}
+
+/* 按字段表展开的填充代码 */
+#define FILL_CPUTIME(name, index)  st->name = nsec_to_jiffies(kcs->cpustat[index]);
+#define FILL_SOFTIRQ(name, index)  irq->name = kstat_softirqs_cpu(index, cpu);
+#define FILL_LOAD(name, index)     cpu_load_data->name = avenrun[index];
+
+/*
+ * 更新全部统计数据，调用者持有 update_lock
+ * 一次遍历所有 CPU，同时填充 cpu_stat 块与 softirq 块，最后读取平均负载
+ */
+static void update_stats_locked(void)
+{
+    int cpu;
+    int idx = 0;
+
+    shm_write_begin();
+
+    for_each_possible_cpu(cpu) {
+        struct kernel_cpustat *kcs;
+        struct cpu_stat *st;
+        struct softirq_stat *irq;
+
+        if (idx >= MONITOR_SHM_MAX_CPUS)
+            break;
+
+        kcs = &kcpustat_cpu(cpu);
+        st = &cpu_stat_data[idx];
+        irq = &softirq_data[idx];
+
+        snprintf(st->cpu_name, sizeof(st->cpu_name), "cpu%d", cpu);
+        memcpy(irq->cpu_name, st->cpu_name, sizeof(irq->cpu_name));
+
+        /* CPU 时间（纳秒转换为 jiffies），idle / iowait 需考虑 tickless 模式 */
+        MONITOR_CPU_STAT_FIELDS(FILL_CPUTIME)
+        st->idle = cpu_stat_get_idle_time(cpu);
+        st->iowait = cpu_stat_get_iowait_time(cpu);
+
+        /* 各类软中断计数 */
+        MONITOR_SOFTIRQ_FIELDS(FILL_SOFTIRQ)
+
+        idx++;
+    }
+
+    /* 平均负载，保持 avenrun 的定点格式 */
+    MONITOR_CPU_LOAD_FIELDS(FILL_LOAD)
+
+    shm_header->nr_cpus = idx;
+    shm_header->blocks[MONITOR_BLOCK_CPU_STAT].count = idx;
+    shm_header->blocks[MONITOR_BLOCK_SOFTIRQ].count = idx;
+    shm_header->blocks[MONITOR_BLOCK_CPU_LOAD].count = 1;
+
+    shm_write_end();
+}
+
+static void update_stats(void)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&update_lock, flags);
+    update_stats_locked();
+    spin_unlock_irqrestore(&update_lock, flags);
+}
+
+/*
+ * 按需刷新：多个读者在同一时刻发起时只遍历一次
+ */
+static void snapshot_stats(void)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&update_lock, flags);
+    if (ktime_get_ns() - shm_header->update_ns >= MONITOR_SNAPSHOT_MIN_NS)
+        update_stats_locked();
+    spin_unlock_irqrestore(&update_lock, flags);
+}
+
+/*
+ * 填充头页：magic、ABI 版本与各块描述，加载时写一次
+ */
+static void init_header(void)
+{
+    struct monitor_shm_block *blocks = shm_header->blocks;
+
+    shm_header->magic = MONITOR_SHM_MAGIC;
+    shm_header->abi_version = MONITOR_SHM_ABI_VERSION;
+    shm_header->total_size = MONITOR_SHM_SIZE;
+
+    blocks[MONITOR_BLOCK_CPU_STAT].offset = MONITOR_SHM_CPU_STAT_OFFSET;
+    blocks[MONITOR_BLOCK_CPU_STAT].entry_size = sizeof(struct cpu_stat);
+    blocks[MONITOR_BLOCK_CPU_STAT].capacity = MONITOR_SHM_MAX_CPUS;
+
+    blocks[MONITOR_BLOCK_SOFTIRQ].offset = MONITOR_SHM_SOFTIRQ_OFFSET;
+    blocks[MONITOR_BLOCK_SOFTIRQ].entry_size = sizeof(struct softirq_stat);
+    blocks[MONITOR_BLOCK_SOFTIRQ].capacity = MONITOR_SHM_MAX_CPUS;
+
+    blocks[MONITOR_BLOCK_CPU_LOAD].offset = MONITOR_SHM_CPU_LOAD_OFFSET;
+    blocks[MONITOR_BLOCK_CPU_LOAD].entry_size = sizeof(struct cpu_load);
+    blocks[MONITOR_BLOCK_CPU_LOAD].capacity = 1;
+
+    cpu_stat_data = (struct cpu_stat *)((char *)shm_base + MONITOR_SHM_CPU_STAT_OFFSET);
+    softirq_data = (struct softirq_stat *)((char *)shm_base + MONITOR_SHM_SOFTIRQ_OFFSET);
+    cpu_load_data = (struct cpu_load *)((char *)shm_base + MONITOR_SHM_CPU_LOAD_OFFSET);
+}
+
+/*
+ * 高精度定时器回调函数
+ * 每 refresh_ms 毫秒触发一次，更新全部统计数据
+ */
+static enum hrtimer_restart timer_callback(struct hrtimer *timer)
+{
+    update_stats();
+
+    /* 重新启动定时器 */
+    hrtimer_forward_now(timer, timer_interval);
+    return HRTIMER_RESTART;
+}
+
+/*
+ * 设置后台刷新间隔并重启定时器，调用者持有 timer_lock
+ * hrtimer_cancel 会等待正在执行的回调结束，之后才修改 timer_interval
+ */
+static void set_refresh_interval(unsigned int ms)
+{
+    hrtimer_cancel(&update_timer);
+    WRITE_ONCE(refresh_ms, ms);
+    WRITE_ONCE(shm_header->refresh_ms, ms);
+    if (ms) {
+        timer_interval = ms_to_ktime(ms);
+        hrtimer_start(&update_timer, timer_interval, HRTIMER_MODE_REL);
+    }
+}
+
+/*
+ * 设备打开回调
+ */
+static int monitor_open(struct inode *inode, struct file *file)
+{
+    pr_info("%s: device opened\n", DEVICE_NAME);
+    return 0;
+}
+
+/*
+ * 设备关闭回调
+ */
+static int monitor_release(struct inode *inode, struct file *file)
+{
+    pr_info("%s: device closed\n", DEVICE_NAME);
+    return 0;
+}
+
+/*
+ * mmap 回调 - 将内核数据映射到用户空间，虚拟空间到真实页框的映射
+ */
+static int monitor_mmap(struct file *file, struct vm_area_struct *vma)
+{
+    unsigned long size = vma->vm_end - vma->vm_start;
+    unsigned long pfn;
+    int ret;
+
+    /* 检查映射大小 */
+    if (size > data_size) {
+        pr_err("%s: mmap size %lu exceeds data size %lu\n",
+               DEVICE_NAME, size, data_size);
+        return -EINVAL;
+    }
+
+    /* 只支持从头页开始映射 */
+    if (vma->vm_pgoff != 0)
+        return -EINVAL;
+
+    /*
+     * 保持默认的可缓存属性：一致性由头页的 seqlock 保证，
+     * 不可缓存的映射会让用户空间的每次读取都直达内存
+     */
+    pfn = page_to_pfn(virt_to_page(shm_base));
+
+    /* 建立映射 */
+    ret = remap_pfn_range(vma, vma->vm_start, pfn, size, vma->vm_page_prot);
+    if (ret) {
+        pr_err("%s: remap_pfn_range failed: %d\n", DEVICE_NAME, ret);
+        return ret;
+    }
+
+    pr_info("%s: mmap successful, size=%lu\n", DEVICE_NAME, size);
+    return 0;
+}
+
+/*
+ * ioctl 回调 - 按需刷新与后台刷新间隔
+ */
+static long monitor_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+    u32 ms;
+
+    switch (cmd) {
+    case MONITOR_IOC_SNAPSHOT:
+        snapshot_stats();
+        return 0;
+
+    case MONITOR_IOC_SET_REFRESH_MS:
+        if (!capable(CAP_SYS_ADMIN))
+            return -EPERM;
+        if (get_user(ms, (u32 __user *)arg))
+            return -EFAULT;
+        if (ms && ms < MONITOR_REFRESH_MIN_MS)
+            return -EINVAL;
+        mutex_lock(&timer_lock);
+        set_refresh_interval(ms);
+        mutex_unlock(&timer_lock);
+        pr_info("%s: refresh interval set to %u ms\n", DEVICE_NAME, ms);
+        return 0;
+
+    case MONITOR_IOC_GET_REFRESH_MS:
+        ms = READ_ONCE(refresh_ms);
+        return put_user(ms, (u32 __user *)arg);
+
+    default:
+        return -ENOTTY;
+    }
+}
+
+/* 文件操作结构体 */
+static const struct file_operations monitor_fops = {
+    .owner          = THIS_MODULE,
+    .open           = monitor_open,
+    .release        = monitor_release,
+    .mmap           = monitor_mmap,
+    .unlocked_ioctl = monitor_ioctl,
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 5, 0)
+    .compat_ioctl   = compat_ptr_ioctl,
+#endif
+};
+
+/*
+ * 模块初始化
+ */
+static int __init monitor_collector_init(void)
+{
+    int ret;
+
+    /* 用户空间按 CPU_LOAD_FSHIFT 还原 avenrun 的定点数 */
+    BUILD_BUG_ON(CPU_LOAD_FSHIFT != FSHIFT);
+    BUILD_BUG_ON(sizeof(struct monitor_shm_header) > MONITOR_SHM_HEADER_SIZE);
+
+    pr_info("%s: initializing module, %u possible CPUs\n",
+            DEVICE_NAME, num_possible_cpus());
+
+    /* 分配共享内存（头页 + 各数据块）- 使用 PAGE_SIZE 对齐以支持 mmap */
+    data_size = PAGE_ALIGN(MONITOR_SHM_SIZE);
+    shm_base = (void *)__get_free_pages(GFP_KERNEL | __GFP_ZERO,
+                                        get_order(data_size));
+    if (!shm_base) {
+        pr_err("%s: failed to allocate memory\n", DEVICE_NAME);
+        return -ENOMEM;
+    }
+    shm_header = (struct monitor_shm_header *)shm_base;
+    init_header();
+
+    pr_info("%s: allocated %lu bytes for data\n", DEVICE_NAME, data_size);
+
+    /*
+     * 定时器与首份数据必须在设备节点出现之前就绪：cdev_add 之后即可能有
+     * open / mmap / ioctl（SET_REFRESH_MS 会 hrtimer_cancel / hrtimer_start）
+     */
+    hrtimer_init(&update_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    update_timer.function = timer_callback;
+
+    /* 首次更新数据，refresh_ms 为 0 时之后只在 SNAPSHOT 时更新 */
+    update_stats();
+
+    /* 启动定时器 */
+    if (refresh_ms && refresh_ms < MONITOR_REFRESH_MIN_MS)
+        refresh_ms = MONITOR_REFRESH_MIN_MS;
+    mutex_lock(&timer_lock);
+    set_refresh_interval(refresh_ms);
+    mutex_unlock(&timer_lock);
+
+    /* 分配设备号 */
+    ret = alloc_chrdev_region(&dev_num, 0, 1, DEVICE_NAME);
+    if (ret < 0) {
+        pr_err("%s: failed to allocate device number\n", DEVICE_NAME);
+        goto err_cancel_timer;
+    }
+
+    /* 初始化字符设备 */
+    cdev_init(&monitor_cdev, &monitor_fops);
+    monitor_cdev.owner = THIS_MODULE;
+
+    ret = cdev_add(&monitor_cdev, dev_num, 1);
+    if (ret < 0) {
+        pr_err("%s: failed to add cdev\n", DEVICE_NAME);
+        goto err_unregister;
+    }
+
+    /* 创建设备类 */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 4, 0)
+    monitor_class = class_create(CLASS_NAME);
+#else
+    monitor_class = class_create(THIS_MODULE, CLASS_NAME);
+#endif
+    if (IS_ERR(monitor_class)) {
+        pr_err("%s: failed to create class\n", DEVICE_NAME);
+        ret = PTR_ERR(monitor_class);
+        goto err_cdev_del;
+    }
+
+    /* 创建设备节点 */
+    monitor_device = device_create(monitor_class, NULL, dev_num, NULL, DEVICE_NAME);
+    if (IS_ERR(monitor_device)) {
+        pr_err("%s: failed to create device\n", DEVICE_NAME);
+        ret = PTR_ERR(monitor_device);
+        goto err_class_destroy;
+    }
+
+    pr_info("%s: module loaded successfully, refresh %u ms\n",
+            DEVICE_NAME, refresh_ms);
+    return 0;
+
+err_class_destroy:
+    class_destroy(monitor_class);
+err_cdev_del:
+    cdev_del(&monitor_cdev);
+err_unregister:
+    unregister_chrdev_region(dev_num, 1);
+err_cancel_timer:
+    hrtimer_cancel(&update_timer);
+    free_pages((unsigned long)shm_base, get_order(data_size));
+    return ret;
+}
+
+/*
+ * 模块卸载
+ */
+static void __exit monitor_collector_exit(void)
+{
+    pr_info("%s: unloading module\n", DEVICE_NAME);
+
+    /* 与初始化相反的顺序：先销毁设备，不再有新的 ioctl，再停止定时器 */
+    device_destroy(monitor_class, dev_num);
+    class_destroy(monitor_class);
+    cdev_del(&monitor_cdev);
+    unregister_chrdev_region(dev_num, 1);
+
+    /* 停止定时器 */
+    hrtimer_cancel(&update_timer);
+
+    /* 释放内存 */
+    free_pages((unsigned long)shm_base, get_order(data_size));
+
+    pr_info("%s: module unloaded\n", DEVICE_NAME);
+}
+
+module_init(monitor_collector_init);
+module_exit(monitor_collector_exit);
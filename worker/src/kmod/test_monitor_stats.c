@@ -0,0 +1,219 @@
+/*
+ * test_monitor_stats.c - 统一采集内核模块测试程序
+ *
+ * 一次映射 /dev/monitor_stats，每次读取前发起 MONITOR_IOC_SNAPSHOT，
+ * 再按 seqlock 协议读取 cpu_stat / softirq / cpu_load 三个数据块并打印。
+ * 给出 refresh_ms 时先用 MONITOR_IOC_SET_REFRESH_MS 设置后台刷新间隔（需 root），
+ * 0 表示关闭后台定时器，只在 SNAPSHOT 时刷新。
+ * 结构体定义与内核模块共用 monitor_structs.h。
+ *
+ * 编译: gcc -I../../include/monitor -o test_monitor_stats test_monitor_stats.c
+ * 运行: ./test_monitor_stats [count] [interval] [refresh_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "monitor_structs.h"
+
+static struct cpu_stat stats[MONITOR_SHM_MAX_CPUS];
+static struct softirq_stat softirqs[MONITOR_SHM_MAX_CPUS];
+static struct cpu_load load;
+
+/*
+ * 校验头页中某个块的描述，返回块起始地址，不合法时返回 NULL
+ */
+static const void *block_base(const void *base, size_t map_size, int id,
+                              size_t entry_size, uint32_t capacity)
+{
+    const struct monitor_shm_header *hdr = (const struct monitor_shm_header *)base;
+    const struct monitor_shm_block *blk = &hdr->blocks[id];
+
+    if (blk->entry_size != entry_size || blk->capacity > capacity ||
+        blk->offset + (size_t)blk->capacity * blk->entry_size > map_size) {
+        fprintf(stderr, "Unexpected block %d: offset=%u entry_size=%u capacity=%u\n",
+                id, blk->offset, blk->entry_size, blk->capacity);
+        return NULL;
+    }
+    return (const char *)base + blk->offset;
+}
+
+/*
+ * 按 seqlock 协议一次拷贝三个块：seq 为奇数或前后不一致时重试。
+ * 返回 CPU 数，失败返回 -1
+ */
+static int read_snapshot(const void *base, size_t map_size, uint64_t *update_ns)
+{
+    const struct monitor_shm_header *hdr = (const struct monitor_shm_header *)base;
+    const void *cpu_block, *irq_block, *load_block;
+    int attempt;
+
+    if (hdr->magic != MONITOR_SHM_MAGIC || hdr->abi_version != MONITOR_SHM_ABI_VERSION) {
+        fprintf(stderr, "Unexpected header: magic=0x%x abi=%u\n",
+                hdr->magic, hdr->abi_version);
+        return -1;
+    }
+    cpu_block = block_base(base, map_size, MONITOR_BLOCK_CPU_STAT,
+                           sizeof(struct cpu_stat), MONITOR_SHM_MAX_CPUS);
+    irq_block = block_base(base, map_size, MONITOR_BLOCK_SOFTIRQ,
+                           sizeof(struct softirq_stat), MONITOR_SHM_MAX_CPUS);
+    load_block = block_base(base, map_size, MONITOR_BLOCK_CPU_LOAD,
+                            sizeof(struct cpu_load), 1);
+    if (!cpu_block || !irq_block || !load_block)
+        return -1;
+
+    for (attempt = 0; attempt < 100; attempt++) {
+        uint32_t seq = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+        uint32_t n;
+
+        if (seq & 1)
+            continue;
+        n = __atomic_load_n(&hdr->nr_cpus, __ATOMIC_RELAXED);
+        if (n > MONITOR_SHM_MAX_CPUS)
+            n = MONITOR_SHM_MAX_CPUS;
+        memcpy(stats, cpu_block, n * sizeof(stats[0]));
+        memcpy(softirqs, irq_block, n * sizeof(softirqs[0]));
+        memcpy(&load, load_block, sizeof(load));
+        *update_ns = __atomic_load_n(&hdr->update_ns, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&hdr->seq, __ATOMIC_RELAXED) == seq)
+            return (int)n;
+    }
+    return -1;
+}
+
+static double load_to_double(uint64_t fixed)
+{
+    return (double)fixed / (1 << CPU_LOAD_FSHIFT);
+}
+
+int main(int argc, char *argv[])
+{
+    int fd;
+    void *addr;
+    size_t data_size = MONITOR_SHM_SIZE;
+    uint64_t update_ns, last_ns = 0;
+    int i, n;
+    int count = 5;  /* 默认采集 5 次 */
+    int interval = 1;  /* 默认间隔 1 秒 */
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        interval = atoi(argv[2]);
+    }
+
+    printf("=== Monitor Stats Test ===\n");
+    printf("Collecting %d samples with %d second interval\n\n", count, interval);
+
+    /* 打开设备 */
+    fd = open(MONITOR_DEVICE_PATH, O_RDONLY);
+    if (fd < 0) {
+        perror("Failed to open device");
+        printf("Make sure the kernel module is loaded:\n");
+        printf("  sudo insmod monitor_collector.ko\n");
+        return 1;
+    }
+
+    /* 映射共享内存，三个块共用这一个映射 */
+    addr = mmap(NULL, data_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        perror("Failed to mmap");
+        close(fd);
+        return 1;
+    }
+
+    /* 设置后台刷新间隔 */
+    if (argc > 3) {
+        uint32_t refresh_ms = (uint32_t)atoi(argv[3]);
+
+        if (ioctl(fd, MONITOR_IOC_SET_REFRESH_MS, &refresh_ms) != 0) {
+            perror("Failed to set refresh interval");
+        }
+    }
+    {
+        uint32_t refresh_ms = 0;
+
+        if (ioctl(fd, MONITOR_IOC_GET_REFRESH_MS, &refresh_ms) == 0) {
+            printf("Background refresh: %u ms%s\n\n", refresh_ms,
+                   refresh_ms ? "" : " (disabled, snapshot only)");
+        }
+    }
+
+    /* 采集数据 */
+    for (int sample = 0; sample < count; sample++) {
+        /* 读取前让内核刷新，拿到此刻的值 */
+        if (ioctl(fd, MONITOR_IOC_SNAPSHOT) != 0) {
+            perror("SNAPSHOT ioctl failed, reading timer-refreshed data");
+        }
+        n = read_snapshot(addr, data_size, &update_ns);
+        if (n < 0) {
+            printf("Failed to read a consistent snapshot\n");
+            break;
+        }
+        printf("--- Sample %d (kernel update at %llu ns, +%.3f s) ---\n", sample + 1,
+               (unsigned long long)update_ns,
+               last_ns ? (update_ns - last_ns) / 1e9 : 0.0);
+        last_ns = update_ns;
+
+        printf("load average: %.2f %.2f %.2f\n\n",
+               load_to_double(load.load_avg_1),
+               load_to_double(load.load_avg_3),
+               load_to_double(load.load_avg_15));
+
+        printf("%-8s %12s %12s %12s %12s %12s %12s %12s %12s\n",
+               "CPU", "user", "nice", "system", "idle", "iowait", "irq", "softirq", "steal");
+        printf("--------------------------------------------------------------------------------\n");
+        for (i = 0; i < n; i++) {
+            printf("%-8s %12lu %12lu %12lu %12lu %12lu %12lu %12lu %12lu\n",
+                   stats[i].cpu_name,
+                   (unsigned long)stats[i].user,
+                   (unsigned long)stats[i].nice,
+                   (unsigned long)stats[i].system,
+                   (unsigned long)stats[i].idle,
+                   (unsigned long)stats[i].iowait,
+                   (unsigned long)stats[i].irq,
+                   (unsigned long)stats[i].softirq,
+                   (unsigned long)stats[i].steal);
+        }
+
+        printf("\n%-8s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+               "CPU", "HI", "TIMER", "NET_TX", "NET_RX", "BLOCK",
+               "IRQ_POLL", "TASKLET", "SCHED", "HRTIMER", "RCU");
+        printf("--------------------------------------------------------------------------------\n");
+        for (i = 0; i < n; i++) {
+            printf("%-8s %10lu %10lu %10lu %10lu %10lu %10lu %10lu %10lu %10lu %10lu\n",
+                   softirqs[i].cpu_name,
+                   (unsigned long)softirqs[i].hi,
+                   (unsigned long)softirqs[i].timer,
+                   (unsigned long)softirqs[i].net_tx,
+                   (unsigned long)softirqs[i].net_rx,
+                   (unsigned long)softirqs[i].block,
+                   (unsigned long)softirqs[i].irq_poll,
+                   (unsigned long)softirqs[i].tasklet,
+                   (unsigned long)softirqs[i].sched,
+                   (unsigned long)softirqs[i].hrtimer,
+                   (unsigned long)softirqs[i].rcu);
+        }
+
+        printf("\nTotal CPUs: %d\n\n", n);
+
+        if (sample < count - 1) {
+            sleep(interval);
+        }
+    }
+
+    /* 清理 */
+    munmap(addr, data_size);
+    close(fd);
+
+    printf("Test completed.\n");
+    return 0;
+}
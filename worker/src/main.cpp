@@ -9,16 +9,32 @@ constexpr char kDefaultManagerAddress[] = "localhost:50051";
 constexpr int kDefaultPushInterval = 10;  // 秒
 
 void PrintUsage(const char* program) {
-  std::cout << "Usage: " << program << " <manager_address> [interval_seconds]"
-            << std::endl;
+  std::cout << "Usage: " << program
+            << " <manager_address> [interval_seconds] [spool_dir]" << std::endl;
   std::cout << "  manager_address: 管理者服务器地址 (如 192.168.1.100:50051)"
             << std::endl;
   std::cout << "  interval_seconds: 推送间隔秒数 (默认 10)" << std::endl;
+  std::cout << "  spool_dir: 断连期间样本的落盘目录 (默认 "
+            << monitor::PushSpoolOptions().dir << ")" << std::endl;
+  std::cout << "Environment:" << std::endl;
+  std::cout << "  MONITOR_CPU_BACKEND: CPU 时间与软中断计数来源 "
+               "auto|kmod|ebpf|procfs (默认 auto)"
+            << std::endl;
+  std::cout << "  MONITOR_NET_BACKEND: 网卡流量计数来源 "
+               "auto|ebpf|netlink|procfs (默认 auto)"
+            << std::endl;
+  std::cout << "  MONITOR_FLOW_TOP_N: 每次上报流量最大的流数，需 eBPF；"
+               "逐包统计，有数据路径开销 (默认 0，不统计)"
+            << std::endl;
+  std::cout << "  MONITOR_SAMPLE_MS: CPU / 软中断 / 网络 / 磁盘的采样周期，"
+               "推送时附带窗口内 min/max/mean/p95 (默认各自的周期，最小 10)"
+            << std::endl;
 }
 
 int main(int argc, char* argv[]) {
   std::string manager_address = kDefaultManagerAddress;
   int interval_seconds = kDefaultPushInterval;
+  monitor::PushSpoolOptions spool_options;
 
   // 解析命令行参数
   if (argc > 1) {
@@ -30,13 +46,17 @@ int main(int argc, char* argv[]) {
       interval_seconds = kDefaultPushInterval;
     }
   }
+  if (argc > 3) {
+    spool_options.dir = argv[3];
+  }
 
   std::cout << "Starting Monitor Server (Push Mode)..." << std::endl;
   std::cout << "Manager address: " << manager_address << std::endl;
   std::cout << "Push interval: " << interval_seconds << " seconds" << std::endl;
+  std::cout << "Spool dir: " << spool_options.dir << std::endl;
 
   // 创建并启动推送器
-  monitor::MonitorPusher pusher(manager_address, interval_seconds);
+  monitor::MonitorPusher pusher(manager_address, interval_seconds, spool_options);
   
   pusher.Start();
 
@@ -0,0 +1,110 @@
+/**
+ * CPU 计数来源的采集开销对比
+ *
+ * 对每个可用的来源（kmod / ebpf / procfs）连续读取 CPU 时间与软中断计数，
+ * 输出单轮（ReadCpuStat + ReadSoftIrq）的平均耗时与 p99。kmod 额外给出
+ * 每轮先发 MONITOR_IOC_SNAPSHOT 的耗时，与工作者实际的采集方式一致。
+ *
+ * 编译（在 build 目录生成 proto 代码之后；启用 eBPF 时另加
+ * -DENABLE_EBPF=1 cpu_counter_source_ebpf.cpp -lbpf -lelf -lz）:
+ *   g++ -O2 -std=c++17 -I../../include -o bench_cpu_sources bench_cpu_sources.cpp \
+ *       cpu_counter_source.cpp ../utils/kmod_mapping.cpp ../utils/procfs_reader.cpp
+ * 运行: sudo ./bench_cpu_sources [rounds]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "monitor/cpu_counter_source.h"
+#include "monitor/monitor_structs.h"
+#include "utils/kmod_mapping.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Backend = monitor::CpuCounterSource::Backend;
+
+struct Result {
+  double mean_ns = 0;
+  uint64_t p99_ns = 0;
+  size_t cpus = 0;
+  int failures = 0;
+};
+
+Result Run(monitor::CpuCounterSource* source, monitor::KmodMapping* snapshot,
+           int rounds) {
+  std::vector<struct cpu_stat> stats;
+  std::vector<struct softirq_stat> softirqs;
+  std::vector<uint64_t> samples;
+  samples.reserve(rounds);
+  Result result;
+  std::vector<uint64_t> update_ns;
+
+  for (int i = 0; i < rounds; ++i) {
+    auto start = Clock::now();
+    if (snapshot) {
+      snapshot->Ioctl(MONITOR_IOC_SNAPSHOT);
+    }
+    bool ok = source->ReadCpuStat(&stats, &update_ns) &&
+              source->ReadSoftIrq(&softirqs, &update_ns);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  Clock::now() - start)
+                  .count();
+    if (!ok) {
+      ++result.failures;
+      continue;
+    }
+    samples.push_back(static_cast<uint64_t>(ns));
+  }
+
+  result.cpus = stats.size();
+  if (samples.empty()) return result;
+  uint64_t sum = 0;
+  for (uint64_t ns : samples) sum += ns;
+  result.mean_ns = static_cast<double>(sum) / samples.size();
+  size_t k = static_cast<size_t>(0.99 * (samples.size() - 1));
+  std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+  result.p99_ns = samples[k];
+  return result;
+}
+
+void Print(const char* name, const Result& r) {
+  std::cout << name << ": cpus " << r.cpus << ", mean "
+            << static_cast<uint64_t>(r.mean_ns) << " ns, p99 " << r.p99_ns
+            << " ns";
+  if (r.failures) std::cout << ", failed reads " << r.failures;
+  std::cout << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10000;
+  auto kmod = std::make_shared<monitor::KmodMapping>(MONITOR_DEVICE_PATH,
+                                                     MONITOR_SHM_SIZE);
+  std::cout << "rounds: " << rounds << std::endl;
+
+  for (Backend backend : {Backend::kKmod, Backend::kEbpf, Backend::kProcfs}) {
+    const char* name = monitor::CpuCounterSource::BackendName(backend);
+    auto source = monitor::CpuCounterSource::Create(backend, kmod);
+    if (!source) {
+      std::cout << name << ": unavailable" << std::endl;
+      continue;
+    }
+    if (backend == Backend::kEbpf) {
+      // perf 事件首次触发之前 map 为空
+      std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    }
+    Print(name, Run(source.get(), nullptr, rounds));
+    if (backend == Backend::kKmod) {
+      Print("kmod+snapshot", Run(source.get(), kmod.get(), rounds));
+    }
+  }
+  return 0;
+}
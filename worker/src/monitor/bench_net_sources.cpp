@@ -0,0 +1,111 @@
+/**
+ * NetMonitor 两种计数来源的采集开销对比
+ *
+ * 可选先建 N 对 veth（nsb*，模拟网卡很多的网关 / 容器宿主机），然后对
+ * procfs（解析 /proc/net/dev）与 netlink（一次 RTM_GETSTATS dump）各连续
+ * 调用 UpdateOnce，输出单轮的平均耗时与 p99，并核对两者得到的网卡集合一致。
+ * 结束时删除创建的 veth。
+ *
+ * 编译（在 build 目录生成 proto 代码之后）:
+ *   g++ -O2 -std=c++17 -I../../include -I<proto 生成目录> -o bench_net_sources \
+ *       bench_net_sources.cpp net_monitor.cpp ../utils/procfs_reader.cpp \
+ *       ../utils/rtnetlink.cpp <proto 库> -lprotobuf
+ * 运行: sudo ./bench_net_sources [rounds，默认 2000] [veth 对数，默认 0]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "monitor/net_monitor.h"
+#include "monitor_info.pb.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Backend = monitor::NetMonitor::Backend;
+
+struct Result {
+  double mean_ns = 0;
+  uint64_t p99_ns = 0;
+  std::set<std::string> links;
+};
+
+Result Run(Backend backend, int rounds) {
+  monitor::NetMonitor net(backend);
+  if (net.backend() != backend) {
+    std::cerr << monitor::NetMonitor::BackendName(backend) << " unavailable"
+              << std::endl;
+  }
+  monitor::proto::MonitorInfo info;
+  std::vector<uint64_t> samples;
+  samples.reserve(rounds);
+
+  for (int i = 0; i < rounds; ++i) {
+    info.clear_net_info();
+    auto start = Clock::now();
+    net.UpdateOnce(&info);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  Clock::now() - start)
+                  .count();
+    samples.push_back(static_cast<uint64_t>(ns));
+  }
+
+  Result result;
+  for (const auto& net_info : info.net_info()) {
+    result.links.insert(net_info.name());
+  }
+  uint64_t sum = 0;
+  for (uint64_t ns : samples) sum += ns;
+  result.mean_ns = static_cast<double>(sum) / samples.size();
+  size_t k = static_cast<size_t>(0.99 * (samples.size() - 1));
+  std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+  result.p99_ns = samples[k];
+  return result;
+}
+
+void Print(const char* name, const Result& r) {
+  std::cout << name << ": links " << r.links.size() << ", mean "
+            << static_cast<uint64_t>(r.mean_ns) << " ns, p99 " << r.p99_ns
+            << " ns" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+  int pairs = argc > 2 ? atoi(argv[2]) : 0;
+  if (rounds <= 0) rounds = 2000;
+
+  for (int i = 0; i < pairs; ++i) {
+    std::string cmd = "ip link add nsb" + std::to_string(i) +
+                      "a type veth peer name nsb" + std::to_string(i) + "b";
+    if (system(cmd.c_str()) != 0) {
+      std::cerr << "failed: " << cmd << std::endl;
+      pairs = i;
+      break;
+    }
+  }
+
+  Result procfs = Run(Backend::kProcfs, rounds);
+  Result netlink = Run(Backend::kNetlink, rounds);
+  Print("procfs ", procfs);
+  Print("netlink", netlink);
+  bool same = procfs.links == netlink.links;
+  if (!same) {
+    std::cerr << "link sets differ" << std::endl;
+  }
+
+  for (int i = 0; i < pairs; ++i) {
+    std::string cmd = "ip link del nsb" + std::to_string(i) + "a";
+    if (system(cmd.c_str()) != 0) {
+      std::cerr << "failed: " << cmd << std::endl;
+    }
+  }
+  return same ? 0 : 1;
+}
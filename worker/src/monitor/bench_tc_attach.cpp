@@ -0,0 +1,142 @@
+/**
+ * TC hook 挂载耗时对比：每个网卡 fork 一次 tc 命令 vs TcHookManager
+ *
+ * 先建 N 对 veth（2N 个网卡，模拟容器宿主机），然后分别计时：
+ *   legacy: 与原 NetEbpfMonitor::InitEbpf 相同，每个网卡
+ *           system("tc qdisc add dev X clsact") 后再 bpf_tc_hook_create + 两次 bpf_tc_attach
+ *   netlink: TcHookManager::Start，一次 RTM_GETLINK dump，全部经 libbpf / netlink 完成
+ *            （同时挂到宿主机原有的网卡上，退出时只摘掉自己的过滤器）
+ * 两轮之间摘掉过滤器并删除 clsact，保证起点相同。结束时删除创建的 veth。
+ *
+ * 编译（先生成 net_stats.skel.h）:
+ *   g++ -O2 -std=c++17 -I../../include -o bench_tc_attach bench_tc_attach.cpp \
+ *       tc_hook_manager.cpp ../utils/rtnetlink.cpp -lbpf -lelf -lz -lpthread
+ * 运行: sudo ./bench_tc_attach [veth 对数，默认 250]
+ *
+ * 参考结果（250 对 veth + 3 个宿主机网卡，libbpf 1.1.2，内核 6.18，4 次运行）:
+ *   legacy  500 个网卡  2.1 - 3.0 s
+ *   netlink 503 个网卡  25 - 38 ms
+ */
+
+#include <bpf/libbpf.h>
+#include <net/if.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "monitor/net_stats.skel.h"
+#include "monitor/tc_hook_manager.h"
+#include "utils/rtnetlink.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// 本程序创建的 veth（tcb*），只在它们上面创建 / 删除 clsact
+std::vector<monitor::LinkInfo> BenchLinks() {
+  std::vector<monitor::LinkInfo> links;
+  monitor::DumpLinks(&links);
+  std::vector<monitor::LinkInfo> result;
+  for (auto& link : links) {
+    if (link.name.compare(0, 3, "tcb") == 0) result.push_back(std::move(link));
+  }
+  return result;
+}
+
+// 删除这些网卡上的 clsact（连同其上的过滤器）
+void DestroyClsact(const std::vector<monitor::LinkInfo>& links) {
+  for (const auto& link : links) {
+    LIBBPF_OPTS(bpf_tc_hook, hook,
+        .ifindex = static_cast<int>(link.ifindex),
+        .attach_point = static_cast<enum bpf_tc_attach_point>(
+            BPF_TC_INGRESS | BPF_TC_EGRESS),
+    );
+    bpf_tc_hook_destroy(&hook);
+  }
+}
+
+size_t LegacyAttach(const std::vector<monitor::LinkInfo>& links,
+                    int ingress_fd, int egress_fd) {
+  size_t attached = 0;
+  for (const auto& link : links) {
+    std::string cmd = "tc qdisc add dev " + link.name + " clsact 2>/dev/null";
+    if (system(cmd.c_str()) < 0) continue;
+
+    LIBBPF_OPTS(bpf_tc_hook, hook,
+        .ifindex = static_cast<int>(link.ifindex),
+        .attach_point = BPF_TC_INGRESS,
+    );
+    int err = bpf_tc_hook_create(&hook);
+    if (err && err != -EEXIST) continue;
+    LIBBPF_OPTS(bpf_tc_opts, opts_in, .prog_fd = ingress_fd);
+    if (bpf_tc_attach(&hook, &opts_in) == 0) ++attached;
+    hook.attach_point = BPF_TC_EGRESS;
+    LIBBPF_OPTS(bpf_tc_opts, opts_eg, .prog_fd = egress_fd);
+    bpf_tc_attach(&hook, &opts_eg);
+  }
+  return attached;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int pairs = argc > 1 ? atoi(argv[1]) : 250;
+
+  struct net_stats_bpf* skel = net_stats_bpf__open_and_load();
+  if (!skel) {
+    fprintf(stderr, "failed to load net_stats BPF program\n");
+    return 1;
+  }
+  int ingress_fd = bpf_program__fd(skel->progs.tc_ingress);
+  int egress_fd = bpf_program__fd(skel->progs.tc_egress);
+
+  printf("creating %d veth pairs...\n", pairs);
+  for (int i = 0; i < pairs; ++i) {
+    std::string cmd = "ip link add tcb" + std::to_string(i) +
+                      "a type veth peer name tcb" + std::to_string(i) + "b";
+    if (system(cmd.c_str()) != 0) {
+      fprintf(stderr, "failed: %s\n", cmd.c_str());
+      pairs = i;
+      break;
+    }
+  }
+  auto links = BenchLinks();
+  DestroyClsact(links);
+
+  auto start = Clock::now();
+  size_t legacy = LegacyAttach(links, ingress_fd, egress_fd);
+  double legacy_ms = ElapsedMs(start);
+  DestroyClsact(links);
+
+  double netlink_ms;
+  size_t netlink;
+  {
+    monitor::TcHookManager hooks(ingress_fd, egress_fd);
+    start = Clock::now();
+    hooks.Start(nullptr);
+    netlink_ms = ElapsedMs(start);
+    netlink = hooks.AttachedCount();
+  }
+  DestroyClsact(links);
+
+  printf("%-8s %12s %10s\n", "method", "interfaces", "ms");
+  printf("%-8s %12zu %10.1f\n", "legacy", legacy, legacy_ms);
+  printf("%-8s %12zu %10.1f\n", "netlink", netlink, netlink_ms);
+
+  for (int i = 0; i < pairs; ++i) {
+    std::string cmd = "ip link del tcb" + std::to_string(i) + "a";
+    if (system(cmd.c_str()) != 0) {
+      fprintf(stderr, "failed: %s\n", cmd.c_str());
+    }
+  }
+  net_stats_bpf__destroy(skel);
+  return 0;
+}
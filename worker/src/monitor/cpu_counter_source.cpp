@@ -0,0 +1,214 @@
+#include "monitor/cpu_counter_source.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+#include "utils/procfs_reader.h"
+
+namespace monitor {
+
+namespace {
+
+uint64_t MonotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// 复制并转为小写："CPU0" -> "cpu0"，"NET_RX" -> "net_rx"
+template <size_t Size>
+std::string_view CopyLower(char (&dst)[Size], std::string_view src) {
+  size_t size = std::min(src.size(), Size - 1);
+  for (size_t i = 0; i < size; ++i) {
+    char c = src[i];
+    dst[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+  }
+  dst[size] = '\0';
+  return std::string_view(dst, size);
+}
+
+// 软中断名（字段表中的字段名）到 softirq_stat 成员
+#define SOFTIRQ_KEY(name, index) #name,
+constexpr std::string_view kSoftirqKeys[] = {
+    MONITOR_SOFTIRQ_FIELDS(SOFTIRQ_KEY)};
+#undef SOFTIRQ_KEY
+#define SOFTIRQ_MEMBER(name, index) &softirq_stat::name,
+constexpr uint64_t softirq_stat::*kSoftirqMembers[] = {
+    MONITOR_SOFTIRQ_FIELDS(SOFTIRQ_MEMBER)};
+#undef SOFTIRQ_MEMBER
+constexpr StaticKeyTable<std::size(kSoftirqKeys)> kSoftirqKeyTable(
+    kSoftirqKeys);
+
+// 内核模块：/dev/monitor_stats 的 cpu_stat 块与 softirq 块
+class KmodCpuCounterSource : public CpuCounterSource {
+ public:
+  explicit KmodCpuCounterSource(std::shared_ptr<KmodMapping> device)
+      : device_(std::move(device)) {}
+
+  Backend backend() const override { return Backend::kKmod; }
+
+  bool ReadCpuStat(std::vector<struct cpu_stat>* stats,
+                   std::vector<uint64_t>* update_ns) override {
+    return Read(MONITOR_BLOCK_CPU_STAT, stats, update_ns);
+  }
+
+  bool ReadSoftIrq(std::vector<struct softirq_stat>* stats,
+                   std::vector<uint64_t>* update_ns) override {
+    return Read(MONITOR_BLOCK_SOFTIRQ, stats, update_ns);
+  }
+
+ private:
+  // 模块一次刷新所有 CPU，各 CPU 的时间戳相同
+  template <typename Entry>
+  bool Read(uint32_t block, std::vector<Entry>* stats,
+            std::vector<uint64_t>* update_ns) {
+    const void* base = device_->Get();
+    uint64_t ns = 0;
+    if (!base || !ReadMonitorBlock(base, device_->size(), block, stats, &ns)) {
+      return false;
+    }
+    update_ns->assign(stats->size(), ns);
+    return true;
+  }
+
+  std::shared_ptr<KmodMapping> device_;
+};
+
+// 后备方案：/proc/stat 与 /proc/softirqs，时间戳取读取时刻
+class ProcfsCpuCounterSource : public CpuCounterSource {
+ public:
+  ProcfsCpuCounterSource()
+      : stat_("/proc/stat"), softirqs_("/proc/softirqs") {}
+
+  Backend backend() const override { return Backend::kProcfs; }
+
+  bool ReadCpuStat(std::vector<struct cpu_stat>* stats,
+                   std::vector<uint64_t>* update_ns) override {
+    stats->clear();
+    if (!stat_.Read()) {
+      return false;
+    }
+    std::string_view line;
+    std::string_view name;
+    while (stat_.NextLine(&line)) {
+      // cpuN user nice system idle iowait irq softirq steal guest guest_nice；
+      // 汇总行 "cpu" 由 CpuStatMonitor 统一计算
+      if (!NextField(&line, &name) || name.size() <= 3 ||
+          name.substr(0, 3) != "cpu") {
+        continue;
+      }
+      struct cpu_stat stat = {};
+      CopyLower(stat.cpu_name, name);
+#define PARSE_FIELD(name, index) NextUint(&line, &stat.name);
+      MONITOR_CPU_STAT_FIELDS(PARSE_FIELD)
+#undef PARSE_FIELD
+      stats->push_back(stat);
+    }
+    update_ns->assign(stats->size(), MonotonicNs());
+    return !stats->empty();
+  }
+
+  bool ReadSoftIrq(std::vector<struct softirq_stat>* stats,
+                   std::vector<uint64_t>* update_ns) override {
+    stats->clear();
+    // 第一行为各列的 CPU 名（CPU0 CPU1 ...），之后每行一种软中断
+    std::string_view line;
+    std::string_view field;
+    if (!softirqs_.Read() || !softirqs_.NextLine(&line)) {
+      return false;
+    }
+    while (NextField(&line, &field)) {
+      struct softirq_stat stat = {};
+      CopyLower(stat.cpu_name, field);
+      stats->push_back(stat);
+    }
+
+    char label_buf[32];
+    while (softirqs_.NextLine(&line)) {
+      // "NET_RX:" -> "net_rx"，与字段表中的字段名一致
+      if (!NextField(&line, &field)) continue;
+      if (field.back() == ':') field.remove_suffix(1);
+      int index = kSoftirqKeyTable.Find(CopyLower(label_buf, field));
+      if (index < 0) continue;
+      uint64_t softirq_stat::*member = kSoftirqMembers[index];
+      for (auto& stat : *stats) {
+        if (!NextUint(&line, &(stat.*member))) break;
+      }
+    }
+    update_ns->assign(stats->size(), MonotonicNs());
+    return !stats->empty();
+  }
+
+ private:
+  ProcfsReader stat_;
+  ProcfsReader softirqs_;
+};
+
+}  // namespace
+
+const char* CpuCounterSource::BackendName(Backend backend) {
+  switch (backend) {
+    case Backend::kAuto:
+      return "auto";
+    case Backend::kKmod:
+      return "kmod";
+    case Backend::kEbpf:
+      return "ebpf";
+    case Backend::kProcfs:
+      return "procfs";
+  }
+  return "unknown";
+}
+
+bool CpuCounterSource::ParseBackend(const std::string& name, Backend* backend) {
+  for (Backend b : {Backend::kAuto, Backend::kKmod, Backend::kEbpf,
+                    Backend::kProcfs}) {
+    if (name == BackendName(b)) {
+      *backend = b;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::unique_ptr<CpuCounterSource> CpuCounterSource::Create(
+    Backend backend, std::shared_ptr<KmodMapping> kmod,
+    std::chrono::milliseconds period) {
+  bool is_auto = backend == Backend::kAuto;
+
+  if (backend == Backend::kKmod || is_auto) {
+    if (kmod && kmod->Get()) {
+      // 模块的后台刷新间隔与采样周期一致，否则多数采样读到的是同一份计数；
+      // 需要 CAP_SYS_ADMIN，失败时沿用模块当前的间隔
+      uint32_t refresh_ms = static_cast<uint32_t>(
+          std::max<int64_t>(period.count(), MONITOR_REFRESH_MIN_MS));
+      if (kmod->Ioctl(MONITOR_IOC_SET_REFRESH_MS, &refresh_ms) != 0) {
+        std::cerr << "CpuCounterSource: cannot set kmod refresh interval to "
+                  << refresh_ms << " ms: " << strerror(errno) << std::endl;
+      }
+      return std::make_unique<KmodCpuCounterSource>(std::move(kmod));
+    }
+    if (!is_auto) return nullptr;
+  }
+
+  if (backend == Backend::kEbpf || is_auto) {
+#ifdef ENABLE_EBPF
+    if (auto source = CreateEbpfCpuCounterSource(period)) {
+      return source;
+    }
+#endif
+    if (!is_auto) return nullptr;
+  }
+
+  return std::make_unique<ProcfsCpuCounterSource>();
+}
+
+}  // namespace monitor
@@ -0,0 +1,157 @@
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "monitor/cpu_counter_source.h"
+
+// 包含生成的 skeleton 头文件
+#include "monitor/cpu_stats.skel.h"
+
+namespace monitor {
+
+namespace {
+
+int OpenCpuClockEvent(int cpu, uint64_t period_ns) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_SOFTWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_SW_CPU_CLOCK;
+  attr.sample_period = period_ns;  // cpu-clock 的周期单位为纳秒
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, -1, cpu, -1,
+                                  PERF_FLAG_FD_CLOEXEC));
+}
+
+/**
+ * eBPF 来源：cpu_stats.bpf.c 挂在每个在线 CPU 的 cpu-clock 采样事件上，
+ * 周期性地把本 CPU 的 kernel_cpustat / kstat 写入 PERCPU_ARRAY。
+ * 读取时一次 bpf_map_lookup_elem 取回全部 CPU 的值。
+ *
+ * 只覆盖加载时在线的 CPU；之后上线的 CPU 没有事件，其条目保持 update_ns 为 0
+ * 而被跳过。
+ */
+class EbpfCpuCounterSource : public CpuCounterSource {
+ public:
+  explicit EbpfCpuCounterSource(std::chrono::milliseconds period)
+      : period_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(period)
+                       .count()) {}
+
+  ~EbpfCpuCounterSource() override {
+    for (struct bpf_link* link : links_) {
+      bpf_link__destroy(link);  // 同时关闭 perf 事件 fd
+    }
+    if (skel_) {
+      cpu_stats_bpf__destroy(skel_);
+    }
+  }
+
+  bool Init() {
+    skel_ = cpu_stats_bpf__open_and_load();
+    if (!skel_) {
+      std::cerr << "CpuCounterSource: failed to load cpu_stats BPF program"
+                << std::endl;
+      return false;
+    }
+
+    int possible = libbpf_num_possible_cpus();
+    if (possible <= 0) {
+      return false;
+    }
+    cpu_samples_.resize(possible);
+    softirq_samples_.resize(possible);
+
+    for (int cpu = 0; cpu < possible; ++cpu) {
+      int fd = OpenCpuClockEvent(cpu, period_ns_);
+      if (fd < 0) {
+        // 离线 CPU 返回 ENODEV，跳过
+        if (errno != ENODEV) {
+          std::cerr << "CpuCounterSource: perf_event_open on cpu" << cpu
+                    << " failed: " << strerror(errno) << std::endl;
+        }
+        continue;
+      }
+      struct bpf_link* link = bpf_program__attach_perf_event(
+          skel_->progs.sample_cpu_stats, fd);
+      if (!link) {
+        close(fd);
+        continue;
+      }
+      links_.push_back(link);
+    }
+    if (links_.empty()) {
+      std::cerr << "CpuCounterSource: no perf events attached" << std::endl;
+      return false;
+    }
+
+    cpu_stat_fd_ = bpf_map__fd(skel_->maps.cpu_stat_map);
+    softirq_fd_ = bpf_map__fd(skel_->maps.softirq_map);
+    return cpu_stat_fd_ >= 0 && softirq_fd_ >= 0;
+  }
+
+  Backend backend() const override { return Backend::kEbpf; }
+
+  bool ReadCpuStat(std::vector<struct cpu_stat>* stats,
+                   std::vector<uint64_t>* update_ns) override {
+    return Collect(cpu_stat_fd_, &cpu_samples_, stats, update_ns);
+  }
+
+  bool ReadSoftIrq(std::vector<struct softirq_stat>* stats,
+                   std::vector<uint64_t>* update_ns) override {
+    return Collect(softirq_fd_, &softirq_samples_, stats, update_ns);
+  }
+
+ private:
+  // 取回 per-CPU 值，跳过尚未采样的 CPU；各 CPU 的 perf 事件相位不同，
+  // 时间戳按 CPU 分别返回，由调用者判断哪些 CPU 在两次读取之间刷新过
+  template <typename Sample, typename Stat>
+  static bool Collect(int map_fd, std::vector<Sample>* samples,
+                      std::vector<Stat>* stats,
+                      std::vector<uint64_t>* update_ns) {
+    uint32_t key = 0;
+    if (bpf_map_lookup_elem(map_fd, &key, samples->data()) != 0) {
+      return false;
+    }
+    stats->clear();
+    update_ns->clear();
+    for (size_t cpu = 0; cpu < samples->size(); ++cpu) {
+      const Sample& sample = (*samples)[cpu];
+      if (sample.update_ns == 0) continue;
+      stats->push_back(sample.stat);
+      snprintf(stats->back().cpu_name, sizeof(stats->back().cpu_name),
+               "cpu%zu", cpu);
+      update_ns->push_back(sample.update_ns);
+    }
+    return !stats->empty();
+  }
+
+  uint64_t period_ns_;  // perf 事件的周期，与 CPU 计数的采样周期一致
+  struct cpu_stats_bpf* skel_ = nullptr;
+  std::vector<struct bpf_link*> links_;
+  int cpu_stat_fd_ = -1;
+  int softirq_fd_ = -1;
+  // PERCPU_ARRAY 的查找结果，每个可能的 CPU 一份（值大小已是 8 字节对齐）
+  std::vector<struct cpu_stat_sample> cpu_samples_;
+  std::vector<struct softirq_sample> softirq_samples_;
+};
+
+}  // namespace
+
+std::unique_ptr<CpuCounterSource> CreateEbpfCpuCounterSource(
+    std::chrono::milliseconds period) {
+  auto source = std::make_unique<EbpfCpuCounterSource>(period);
+  if (!source->Init()) {
+    return nullptr;
+  }
+  return source;
+}
+
+}  // namespace monitor
@@ -2,11 +2,9 @@
 #include "monitor/monitor_structs.h"
 #include "monitor_info.grpc.pb.h"
 #include "monitor_info.pb.h"
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <unistd.h>
 #include <cstring>
 #include <cstdio>
+#include <utility>
 
 namespace monitor {
 
@@ -20,26 +18,27 @@ static bool ReadLoadFromProc(float* load1, float* load3, float* load15) {
     return ret == 3;
 }
 
-void CpuLoadMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
-    // 首先尝试从内核模块读取
-    int fd = open("/dev/cpu_load_monitor", O_RDONLY);
-    if (fd >= 0) {
-        size_t load_size = sizeof(struct cpu_load);
-        void* addr = mmap(nullptr, load_size, PROT_READ, MAP_SHARED, fd, 0);
-        if (addr != MAP_FAILED) {
-            struct cpu_load info;
-            memcpy(&info, addr, load_size);
+// 内核 avenrun 定点数转浮点
+static float LoadToFloat(uint64_t fixed) {
+    return static_cast<float>(fixed) / (1 << CPU_LOAD_FSHIFT);
+}
 
-            auto cpu_load_msg = monitor_info->mutable_cpu_load();
-            cpu_load_msg->set_load_avg_1(info.load_avg_1);
-            cpu_load_msg->set_load_avg_3(info.load_avg_3);
-            cpu_load_msg->set_load_avg_15(info.load_avg_15);
+CpuLoadMonitor::CpuLoadMonitor(std::shared_ptr<KmodMapping> device)
+    : device_(std::move(device)) {}
 
-            munmap(addr, load_size);
-            close(fd);
-            return;
-        }
-        close(fd);
+void CpuLoadMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
+    // 首先尝试从内核模块读取（映射常驻，模块未加载时按间隔重试）
+    uint64_t update_ns = 0;
+    const void* base = device_->Get();
+    if (base && ReadMonitorBlock(base, device_->size(), MONITOR_BLOCK_CPU_LOAD,
+                                 &snapshot_, &update_ns) &&
+        !snapshot_.empty()) {
+        const struct cpu_load& info = snapshot_.front();
+        auto cpu_load_msg = monitor_info->mutable_cpu_load();
+        cpu_load_msg->set_load_avg_1(LoadToFloat(info.load_avg_1));
+        cpu_load_msg->set_load_avg_3(LoadToFloat(info.load_avg_3));
+        cpu_load_msg->set_load_avg_15(LoadToFloat(info.load_avg_15));
+        return;
     }
     
     // 后备方案：从 /proc/loadavg 读取
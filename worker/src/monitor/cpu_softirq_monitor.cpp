@@ -1,136 +1,99 @@
 #include "monitor/cpu_softirq_monitor.h"
 
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <unistd.h>
-
-#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <utility>
 
 #include "monitor/monitor_structs.h"
 
 namespace monitor {
 
-// 设备路径
-static const char* DEVICE_PATH = "/dev/cpu_softirq_monitor";
-
-// 最大 CPU 数量（与内核模块一致）
-static const size_t MAX_CPUS = 256;
+CpuSoftIrqMonitor::CpuSoftIrqMonitor(std::shared_ptr<CpuCounterSource> source)
+    : source_(std::move(source)) {}
 
 void CpuSoftIrqMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
-  // 打开设备文件
-  int fd = open(DEVICE_PATH, O_RDONLY);
-  if (fd < 0) {
-    // 设备不存在，可能内核模块未加载
-    // 静默失败，不输出错误信息
+  // 从选定的来源取一份一致的各 CPU 计数；snapshot_ns_ 是各 CPU 计数对应的时刻
+  // 来源暂不可用（如内核模块被卸载）时静默跳过
+  if (!source_->ReadSoftIrq(&snapshot_, &snapshot_ns_)) {
     return;
   }
 
-  // 计算映射大小
-  size_t map_size = sizeof(struct softirq_stat) * MAX_CPUS;
-
-  // 映射内核内存到用户空间
-  void* addr = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
-  if (addr == MAP_FAILED) {
-    close(fd);
-    return;
-  }
-
-  struct softirq_stat* stats = static_cast<struct softirq_stat*>(addr);
-  auto now = std::chrono::steady_clock::now();
-
   // 遍历所有 CPU 的软中断统计数据
-  for (size_t i = 0; i < MAX_CPUS; ++i) {
-    // 检查是否到达数据末尾
-    if (stats[i].cpu_name[0] == '\0') {
-      break;
-    }
-
-    std::string cpu_name(stats[i].cpu_name);
+  for (size_t i = 0; i < snapshot_.size(); ++i) {
+    const struct softirq_stat& stat = snapshot_[i];
+    const uint64_t update_ns = snapshot_ns_[i];
+    std::string cpu_name(stat.cpu_name);
 
     // 查找之前的采样数据
     auto it = cpu_softirqs_.find(cpu_name);
 
     // 创建 protobuf 消息
     auto* softirq_msg = monitor_info->add_soft_irq();
+
+    if (it != cpu_softirqs_.end() && it->second.update_ns == update_ns) {
+      // 来源尚未更新这个 CPU（采样快于内核定时刷新，或 eBPF 各 CPU 的 perf
+      // 事件还没轮到它），沿用它上一次算出的频率
+      *softirq_msg = it->second.last_msg;
+      softirq_msg->set_stale(true);
+      continue;
+    }
     softirq_msg->set_cpu(cpu_name);
 
     if (it != cpu_softirqs_.end()) {
-      // 计算时间差（秒）
-      auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          now - it->second.timepoint)
-                          .count();
-      double seconds = duration / 1000.0;
-
-      if (seconds > 0) {
-        // 计算每秒的软中断频率
-        softirq_msg->set_hi(
-            static_cast<int64_t>((stats[i].hi - it->second.hi) / seconds));
-        softirq_msg->set_timer(
-            static_cast<int64_t>((stats[i].timer - it->second.timer) / seconds));
-        softirq_msg->set_net_tx(
-            static_cast<int64_t>((stats[i].net_tx - it->second.net_tx) / seconds));
-        softirq_msg->set_net_rx(
-            static_cast<int64_t>((stats[i].net_rx - it->second.net_rx) / seconds));
-        softirq_msg->set_block(
-            static_cast<int64_t>((stats[i].block - it->second.block) / seconds));
-        softirq_msg->set_irq_poll(
-            static_cast<int64_t>((stats[i].irq_poll - it->second.irq_poll) / seconds));
-        softirq_msg->set_tasklet(
-            static_cast<int64_t>((stats[i].tasklet - it->second.tasklet) / seconds));
-        softirq_msg->set_sched(
-            static_cast<int64_t>((stats[i].sched - it->second.sched) / seconds));
-        softirq_msg->set_hrtimer(
-            static_cast<int64_t>((stats[i].hrtimer - it->second.hrtimer) / seconds));
-        softirq_msg->set_rcu(
-            static_cast<int64_t>((stats[i].rcu - it->second.rcu) / seconds));
-      } else {
-        // 时间差为 0，使用原始值
-        softirq_msg->set_hi(stats[i].hi);
-        softirq_msg->set_timer(stats[i].timer);
-        softirq_msg->set_net_tx(stats[i].net_tx);
-        softirq_msg->set_net_rx(stats[i].net_rx);
-        softirq_msg->set_block(stats[i].block);
-        softirq_msg->set_irq_poll(stats[i].irq_poll);
-        softirq_msg->set_tasklet(stats[i].tasklet);
-        softirq_msg->set_sched(stats[i].sched);
-        softirq_msg->set_hrtimer(stats[i].hrtimer);
-        softirq_msg->set_rcu(stats[i].rcu);
-      }
+      // 按两次更新的时间差计算（秒），内核来源不受采集线程调度抖动影响
+      double seconds = (update_ns - it->second.update_ns) / 1e9;
+
+      // 计算每秒的软中断频率
+      softirq_msg->set_hi(
+          static_cast<int64_t>((stat.hi - it->second.hi) / seconds));
+      softirq_msg->set_timer(
+          static_cast<int64_t>((stat.timer - it->second.timer) / seconds));
+      softirq_msg->set_net_tx(
+          static_cast<int64_t>((stat.net_tx - it->second.net_tx) / seconds));
+      softirq_msg->set_net_rx(
+          static_cast<int64_t>((stat.net_rx - it->second.net_rx) / seconds));
+      softirq_msg->set_block(
+          static_cast<int64_t>((stat.block - it->second.block) / seconds));
+      softirq_msg->set_irq_poll(
+          static_cast<int64_t>((stat.irq_poll - it->second.irq_poll) / seconds));
+      softirq_msg->set_tasklet(
+          static_cast<int64_t>((stat.tasklet - it->second.tasklet) / seconds));
+      softirq_msg->set_sched(
+          static_cast<int64_t>((stat.sched - it->second.sched) / seconds));
+      softirq_msg->set_hrtimer(
+          static_cast<int64_t>((stat.hrtimer - it->second.hrtimer) / seconds));
+      softirq_msg->set_rcu(
+          static_cast<int64_t>((stat.rcu - it->second.rcu) / seconds));
     } else {
       // 首次采集，使用原始累计值
-      softirq_msg->set_hi(stats[i].hi);
-      softirq_msg->set_timer(stats[i].timer);
-      softirq_msg->set_net_tx(stats[i].net_tx);
-      softirq_msg->set_net_rx(stats[i].net_rx);
-      softirq_msg->set_block(stats[i].block);
-      softirq_msg->set_irq_poll(stats[i].irq_poll);
-      softirq_msg->set_tasklet(stats[i].tasklet);
-      softirq_msg->set_sched(stats[i].sched);
-      softirq_msg->set_hrtimer(stats[i].hrtimer);
-      softirq_msg->set_rcu(stats[i].rcu);
+      softirq_msg->set_hi(stat.hi);
+      softirq_msg->set_timer(stat.timer);
+      softirq_msg->set_net_tx(stat.net_tx);
+      softirq_msg->set_net_rx(stat.net_rx);
+      softirq_msg->set_block(stat.block);
+      softirq_msg->set_irq_poll(stat.irq_poll);
+      softirq_msg->set_tasklet(stat.tasklet);
+      softirq_msg->set_sched(stat.sched);
+      softirq_msg->set_hrtimer(stat.hrtimer);
+      softirq_msg->set_rcu(stat.rcu);
     }
 
     // 保存当前采样数据用于下次计算
     SoftIrq& cached = cpu_softirqs_[cpu_name];
     cached.cpu_name = cpu_name;
-    cached.hi = stats[i].hi;
-    cached.timer = stats[i].timer;
-    cached.net_tx = stats[i].net_tx;
-    cached.net_rx = stats[i].net_rx;
-    cached.block = stats[i].block;
-    cached.irq_poll = stats[i].irq_poll;
-    cached.tasklet = stats[i].tasklet;
-    cached.sched = stats[i].sched;
-    cached.hrtimer = stats[i].hrtimer;
-    cached.rcu = stats[i].rcu;
-    cached.timepoint = now;
+    cached.hi = stat.hi;
+    cached.timer = stat.timer;
+    cached.net_tx = stat.net_tx;
+    cached.net_rx = stat.net_rx;
+    cached.block = stat.block;
+    cached.irq_poll = stat.irq_poll;
+    cached.tasklet = stat.tasklet;
+    cached.sched = stat.sched;
+    cached.hrtimer = stat.hrtimer;
+    cached.rcu = stat.rcu;
+    cached.update_ns = update_ns;
+    cached.last_msg = *softirq_msg;
   }
-
-  // 解除映射并关闭文件
-  munmap(addr, map_size);
-  close(fd);
 }
 
 }  // namespace monitor
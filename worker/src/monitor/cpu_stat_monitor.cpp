@@ -1,102 +1,179 @@
 #include "monitor/cpu_stat_monitor.h"
 #include "monitor/monitor_structs.h"
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
 #include <cstring>
+#include <system_error>
+#include <utility>
 #include "monitor_info.grpc.pb.h"
 #include "monitor_info.pb.h"
 
 namespace monitor {
+
+namespace {
+
+// CPU 编号上限，防止异常的名字导致按编号扩容时分配过多内存
+constexpr size_t kMaxCpuId = 65535;
+
+// "cpu12" -> 12
+bool ParseCpuId(const char* name, size_t* id) {
+    if (strncmp(name, "cpu", 3) != 0) return false;
+    const char* begin = name + 3;
+    const char* end = begin + strnlen(begin, sizeof(cpu_stat::cpu_name) - 3);
+    auto result = std::from_chars(begin, end, *id);
+    return begin != end && result.ec == std::errc() && result.ptr == end &&
+           *id <= kMaxCpuId;
+}
+
+}  // namespace
+
+CpuStatMonitor::CpuStatMonitor(std::shared_ptr<CpuCounterSource> source)
+    : source_(std::move(source)) {
+    Resize(1);
+}
+
+void CpuStatMonitor::Resize(size_t rows) {
+    for (auto& column : prev_) column.resize(rows, 0);
+    for (auto& column : curr_) column.resize(rows, 0);
+    for (auto& column : delta_) column.resize(rows, 0);
+    for (auto& column : percent_) column.resize(rows, 0);
+    for (auto& column : computed_) column.resize(rows, 0);
+    update_ns_.resize(rows, 0);
+    present_.resize(rows, 0);
+    fresh_.resize(rows, 0);
+    seen_.resize(rows, 0);
+    ready_.resize(rows, 0);
+    rows_ = rows;
+}
+
+bool CpuStatMonitor::LoadSnapshot() {
+    // 本次没有出现（离线）或没有刷新过的行保持上一次的计数，差值为 0
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+        std::copy(prev_[c].begin(), prev_[c].end(), curr_[c].begin());
+    }
+    std::fill(present_.begin(), present_.end(), 0);
+    std::fill(fresh_.begin(), fresh_.end(), 0);
+
+    // 汇总行 "cpu"：管理者以 cpu_stat(0) 作为整机使用率，其余行数作为核数。
+    // 汇总计数在上一次的基础上累加各在线 CPU 最近一个周期的增量，而不是直接
+    // 累加当前在线 CPU 的累计计数：CPU 下线 / 上线（或首次出现）时集合变化，
+    // 直接求和会让汇总计数整体跳变，算出的整机使用率出现尖峰甚至倒退。
+    // 本次没有刷新的 CPU 计入它上一个周期的增量，汇总不会只反映刚好刷新的几个
+    uint64_t total[kCpuTimeColumns];
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+        total[c] = prev_[c][kTotalRow];
+    }
+    bool any = false;
+    bool any_fresh = false;
+    for (size_t i = 0; i < snapshot_.size(); ++i) {
+        const struct cpu_stat& stat = snapshot_[i];
+        size_t id;
+        if (!ParseCpuId(stat.cpu_name, &id)) continue;
+        size_t row = id + 1;
+        if (row >= rows_) Resize(row + 1);
+        present_[row] = 1;
+        any = true;
+
+        // 来源尚未刷新这个 CPU（采样快于内核定时刷新，或 eBPF 各 CPU 的 perf
+        // 事件还没轮到它）：沿用它上一次的计数与使用率
+        if (snapshot_ns_[i] == update_ns_[row]) {
+            for (int c = 0; c < kCpuTimeColumns; ++c) {
+                total[c] += delta_[c][row];
+            }
+            continue;
+        }
+        update_ns_[row] = snapshot_ns_[i];
+        fresh_[row] = 1;
+        any_fresh = true;
+
+        const uint64_t values[kCpuTimeColumns] = {
+            stat.user, stat.nice, stat.system,  stat.idle,
+            stat.iowait, stat.irq, stat.softirq, stat.steal,
+        };
+        for (int c = 0; c < kCpuTimeColumns; ++c) {
+            // 第一次出现的 CPU 没有上一次的计数，本次不计入汇总
+            delta_[c][row] = seen_[row] && values[c] > prev_[c][row]
+                                 ? values[c] - prev_[c][row]
+                                 : 0;
+            total[c] += delta_[c][row];
+            curr_[c][row] = values[c];
+        }
+    }
+    if (!any) return false;
+
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+        curr_[c][kTotalRow] = total[c];
+    }
+    present_[kTotalRow] = 1;
+    fresh_[kTotalRow] = any_fresh;
+    return true;
+}
+
 void CpuStatMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
-    int fd = open("/dev/cpu_stat_monitor", O_RDONLY);
-    if (fd < 0) return;
-
-    size_t stat_count = 128; // 假设最多128个CPU
-    size_t stat_size = sizeof(struct cpu_stat) * stat_count;
-    void* addr = mmap(nullptr, stat_size, PROT_READ, MAP_SHARED, fd, 0);
-    //代码中使用mmap()直接将内核态设备数据映射到当前进程的虚拟地址空间，
-    //仅需一次数据拷贝（内核态数据到映射内存区域），且映射完成后进程可直接访问该内存，无需再进行数据迁移。
-    if (addr == MAP_FAILED) {
-        close(fd);
+    // 从选定的来源（内核模块 / eBPF / procfs）取一份一致的各 CPU 计数
+    if (!source_->ReadCpuStat(&snapshot_, &snapshot_ns_)) return;
+    if (!LoadSnapshot()) return;
+
+    // 没有任何 CPU 刷新过：差值全为 0，沿用上一次算出的使用率
+    if (!fresh_[kTotalRow]) {
+        EmitRows(monitor_info);
         return;
     }
 
-    struct cpu_stat* stats = static_cast<struct cpu_stat*>(addr);
-    for (size_t i = 0; i < stat_count; ++i) {
-        if (stats[i].cpu_name[0] == '\0') break;
-        auto it = cpu_stat_map_.find(stats[i].cpu_name);
-        if (it != cpu_stat_map_.end()) {
-          struct CpuStat old = it->second;
-          auto cpu_stat_msg = monitor_info->add_cpu_stat();
-          float new_cpu_total_time = stats[i].user + stats[i].system +
-                                     stats[i].idle + stats[i].nice +
-                                     stats[i].iowait + stats[i].irq +
-                                     stats[i].softirq + stats[i].steal;
-          float old_cpu_total_time = old.user + old.system + old.idle + old.nice +
-                                     old.io_wait + old.irq + old.soft_irq +
-                                     old.steal;
-          float new_cpu_busy_time = stats[i].user + stats[i].system +
-                                  stats[i].nice + stats[i].irq +
-                                  stats[i].softirq + stats[i].steal;
-          float old_cpu_busy_time = old.user + old.system + old.nice + old.irq +
-                                  old.soft_irq + old.steal;
-
-          float cpu_percent = (new_cpu_busy_time - old_cpu_busy_time) /
-                              (new_cpu_total_time - old_cpu_total_time) * 100.00;
-          float cpu_user_percent = (stats[i].user - old.user) /
-                                   (new_cpu_total_time - old_cpu_total_time) *
-                                   100.00;
-          float cpu_system_percent = (stats[i].system - old.system) /
-                                     (new_cpu_total_time - old_cpu_total_time) *
-                                     100.00;
-          float cpu_nice_percent = (stats[i].nice - old.nice) /
-                                   (new_cpu_total_time - old_cpu_total_time) *
-                                   100.00;
-          float cpu_idle_percent = (stats[i].idle - old.idle) /
-                                   (new_cpu_total_time - old_cpu_total_time) *
-                                   100.00;
-          float cpu_io_wait_percent = (stats[i].iowait - old.io_wait) /
-                                      (new_cpu_total_time - old_cpu_total_time) *
-                                      100.00;
-          float cpu_irq_percent = (stats[i].irq - old.irq) /
-                                  (new_cpu_total_time - old_cpu_total_time) *
-                                  100.00;
-          float cpu_soft_irq_percent = (stats[i].softirq - old.soft_irq) /
-                                       (new_cpu_total_time - old_cpu_total_time) *
-                                       100.00;
-          cpu_stat_msg->set_cpu_name(stats[i].cpu_name);
-          cpu_stat_msg->set_cpu_percent(cpu_percent);
-          cpu_stat_msg->set_usr_percent(cpu_user_percent);
-          cpu_stat_msg->set_system_percent(cpu_system_percent);
-          cpu_stat_msg->set_nice_percent(cpu_nice_percent);
-          cpu_stat_msg->set_idle_percent(cpu_idle_percent);
-          cpu_stat_msg->set_io_wait_percent(cpu_io_wait_percent);
-          cpu_stat_msg->set_irq_percent(cpu_irq_percent);
-          cpu_stat_msg->set_soft_irq_percent(cpu_soft_irq_percent);
+    // 所有行的差值与百分比一次算完（AVX2 或标量）
+    const uint64_t* curr[kCpuTimeColumns];
+    const uint64_t* prev[kCpuTimeColumns];
+    float* percent[kCpuPercentColumns];
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+        curr[c] = curr_[c].data();
+        prev[c] = prev_[c].data();
+    }
+    for (int p = 0; p < kCpuPercentColumns; ++p) {
+        percent[p] = computed_[p].data();
+    }
+    ComputeCpuPercent(curr, prev, rows_, percent);
+
+    // 只有刷新过的行采用新算出的使用率；其余在线的行保留上一次的结果
+    for (size_t row = 0; row < rows_; ++row) {
+        if (fresh_[row]) {
+            for (int p = 0; p < kCpuPercentColumns; ++p) {
+                percent_[p][row] = computed_[p][row];
+            }
+            ready_[row] = seen_[row];
+        } else {
+            ready_[row] = present_[row] && ready_[row];
+        }
+        seen_[row] |= fresh_[row];
+    }
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+        prev_[c].swap(curr_[c]);
+    }
+    EmitRows(monitor_info);
+}
+
+void CpuStatMonitor::EmitRows(monitor::proto::MonitorInfo* monitor_info) const {
+    auto* rows = monitor_info->mutable_cpu_stat();
+    rows->Reserve(rows->size() + static_cast<int>(rows_));
+    char name[sizeof(cpu_stat::cpu_name)];
+    for (size_t row = 0; row < rows_; ++row) {
+        if (!ready_[row]) continue;
+        if (row == kTotalRow) {
+            snprintf(name, sizeof(name), "cpu");
+        } else {
+            snprintf(name, sizeof(name), "cpu%zu", row - 1);
         }
-        // 将内核结构体数据转换为内部 CpuStat 结构体
-        CpuStat& cached = cpu_stat_map_[stats[i].cpu_name];
-        cached.cpu_name = stats[i].cpu_name;
-        cached.user = stats[i].user;
-        cached.nice = stats[i].nice;
-        cached.system = stats[i].system;
-        cached.idle = stats[i].idle;
-        cached.io_wait = stats[i].iowait;
-        cached.irq = stats[i].irq;
-        cached.soft_irq = stats[i].softirq;
-        cached.steal = stats[i].steal;
-        cached.guest = stats[i].guest;
-        cached.guest_nice = stats[i].guest_nice;
+        auto* cpu_stat_msg = rows->Add();
+        cpu_stat_msg->set_cpu_name(name);
+        cpu_stat_msg->set_cpu_percent(percent_[kCpuPercentBusy][row]);
+        cpu_stat_msg->set_usr_percent(percent_[kCpuPercentUser][row]);
+        cpu_stat_msg->set_system_percent(percent_[kCpuPercentSystem][row]);
+        cpu_stat_msg->set_nice_percent(percent_[kCpuPercentNice][row]);
+        cpu_stat_msg->set_idle_percent(percent_[kCpuPercentIdle][row]);
+        cpu_stat_msg->set_io_wait_percent(percent_[kCpuPercentIowait][row]);
+        cpu_stat_msg->set_irq_percent(percent_[kCpuPercentIrq][row]);
+        cpu_stat_msg->set_soft_irq_percent(percent_[kCpuPercentSoftirq][row]);
+        cpu_stat_msg->set_stale(!fresh_[row]);
     }
-//先通过monitor_info指针创建并获取一个新的cpu_stat子消息句柄cpu_stat_msg，
-//再分别计算当前stats[i]和历史old对应的 CPU 总运行时间、忙碌时间，
-//以及 CPU 整体使用率和用户态、系统态、空闲态等各类细分状态的使用率，
-//最后将 CPU 名称和所有计算得到的使用率数据通过cpu_stat_msg的set_xxx()系列方法
-//填充到这个新创建的cpu_stat子消息中，完成单条 CPU 状态消息的构造与数据赋值。
-    munmap(addr, stat_size);
-    close(fd);
-    return;
-    
 }
-}  // namespace monitor
\ No newline at end of file
+}  // namespace monitor
@@ -0,0 +1,132 @@
+#include "monitor/cpu_usage_calc.h"
+
+#ifdef MONITOR_HAVE_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+namespace monitor {
+
+namespace {
+
+// 差值上限 2^52 - 1：AVX2 没有 64 位整数到 double 的转换指令，
+// 用 2^52 魔数转换，两种实现都先截断到这个范围，结果完全一致
+constexpr int64_t kMaxDelta = (int64_t{1} << 52) - 1;
+
+// 各百分比列对应的时间列，kCpuPercentBusy 单独计算
+constexpr int kPercentSource[kCpuPercentColumns] = {
+    -1,
+    kCpuTimeUser,
+    kCpuTimeSystem,
+    kCpuTimeNice,
+    kCpuTimeIdle,
+    kCpuTimeIowait,
+    kCpuTimeIrq,
+    kCpuTimeSoftirq,
+};
+
+inline double Delta(uint64_t now, uint64_t before) {
+  int64_t delta = static_cast<int64_t>(now - before);
+  if (delta < 0) delta = 0;
+  if (delta > kMaxDelta) delta = kMaxDelta;
+  return static_cast<double>(delta);
+}
+
+void ScalarRows(CpuTimeColumns curr, CpuTimeColumns prev, size_t begin,
+                size_t end, CpuPercentOutput percent) {
+  for (size_t row = begin; row < end; ++row) {
+    double delta[kCpuTimeColumns];
+    double total = 0;
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+      delta[c] = Delta(curr[c][row], prev[c][row]);
+      total += delta[c];
+    }
+    double busy = total - delta[kCpuTimeIdle] - delta[kCpuTimeIowait];
+    double scale = total > 0 ? 100.0 / total : 0.0;
+
+    percent[kCpuPercentBusy][row] = static_cast<float>(busy * scale);
+    for (int p = kCpuPercentUser; p < kCpuPercentColumns; ++p) {
+      percent[p][row] = static_cast<float>(delta[kPercentSource[p]] * scale);
+    }
+  }
+}
+
+#ifdef MONITOR_HAVE_AVX2_KERNEL
+bool CpuHasAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+const bool kUseAvx2 = CpuHasAvx2();
+#endif
+
+}  // namespace
+
+void ComputeCpuPercentScalar(CpuTimeColumns curr, CpuTimeColumns prev,
+                             size_t rows, CpuPercentOutput percent) {
+  ScalarRows(curr, prev, 0, rows, percent);
+}
+
+#ifdef MONITOR_HAVE_AVX2_KERNEL
+__attribute__((target("avx2"))) void ComputeCpuPercentAvx2(
+    CpuTimeColumns curr, CpuTimeColumns prev, size_t rows,
+    CpuPercentOutput percent) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max_delta = _mm256_set1_epi64x(kMaxDelta);
+  // x | 0x4330000000000000 的位模式即 double(2^52 + x)
+  const __m256i magic_bits = _mm256_set1_epi64x(0x4330000000000000LL);
+  const __m256d magic = _mm256_set1_pd(4503599627370496.0);  // 2^52
+  const __m256d hundred = _mm256_set1_pd(100.0);
+  const __m256d zero_pd = _mm256_setzero_pd();
+
+  size_t row = 0;
+  for (; row + 4 <= rows; row += 4) {
+    __m256d delta[kCpuTimeColumns];
+    __m256d total = zero_pd;
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+      __m256i now = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(curr[c] + row));
+      __m256i before = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(prev[c] + row));
+      __m256i d = _mm256_sub_epi64(now, before);
+      d = _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, d), d);
+      d = _mm256_blendv_epi8(d, max_delta, _mm256_cmpgt_epi64(d, max_delta));
+      delta[c] = _mm256_sub_pd(
+          _mm256_castsi256_pd(_mm256_or_si256(d, magic_bits)), magic);
+      total = _mm256_add_pd(total, delta[c]);
+    }
+    __m256d busy = _mm256_sub_pd(
+        _mm256_sub_pd(total, delta[kCpuTimeIdle]), delta[kCpuTimeIowait]);
+    __m256d scale = _mm256_and_pd(_mm256_div_pd(hundred, total),
+                                  _mm256_cmp_pd(total, zero_pd, _CMP_GT_OQ));
+
+    _mm_storeu_ps(percent[kCpuPercentBusy] + row,
+                  _mm256_cvtpd_ps(_mm256_mul_pd(busy, scale)));
+    for (int p = kCpuPercentUser; p < kCpuPercentColumns; ++p) {
+      _mm_storeu_ps(
+          percent[p] + row,
+          _mm256_cvtpd_ps(_mm256_mul_pd(delta[kPercentSource[p]], scale)));
+    }
+  }
+  ScalarRows(curr, prev, row, rows, percent);
+}
+#endif
+
+void ComputeCpuPercent(CpuTimeColumns curr, CpuTimeColumns prev, size_t rows,
+                       CpuPercentOutput percent) {
+#ifdef MONITOR_HAVE_AVX2_KERNEL
+  if (kUseAvx2) {
+    ComputeCpuPercentAvx2(curr, prev, rows, percent);
+    return;
+  }
+#endif
+  ScalarRows(curr, prev, 0, rows, percent);
+}
+
+const char* CpuPercentImplName() {
+#ifdef MONITOR_HAVE_AVX2_KERNEL
+  if (kUseAvx2) return "avx2";
+#endif
+  return "scalar";
+}
+
+}  // namespace monitor
@@ -1,41 +1,43 @@
 #include "monitor/disk_monitor.h"
 
-#include <ctime>
-#include <fstream>
-#include <map>
-#include <sstream>
-#include <string>
+#include <iterator>
+#include <string_view>
 
 namespace monitor {
 
-struct DiskSample {
-  uint64_t reads, writes, sectors_read, sectors_written;
-  uint64_t read_time_ms, write_time_ms, io_in_progress, io_time_ms,
-      weighted_io_time_ms;
-};
-
-static std::map<std::string, DiskSample> last_samples;
-static std::map<std::string, double> last_time;
-
 void DiskMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
-  std::ifstream ifs("/proc/diskstats");
-  std::string line;
-  double now = ::time(nullptr);
+  if (!diskstats_.Read()) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
 
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    int major, minor;
-    std::string name;
+  std::string_view line;
+  while (diskstats_.NextLine(&line)) {
+    // major minor name reads merged ... 只取下面用到的列
+    std::string_view name;
+    uint64_t major, minor, skip;
     DiskSample curr{};
-    iss >> major >> minor >> name >> curr.reads >> curr.writes >>
-        curr.sectors_read >> curr.sectors_written >> curr.read_time_ms >>
-        curr.write_time_ms >> curr.io_in_progress >> curr.io_time_ms >>
-        curr.weighted_io_time_ms;
-    if (name.find("loop") == 0 || name.find("ram") == 0)
+    if (!NextUint(&line, &major) || !NextUint(&line, &minor) ||
+        !NextField(&line, &name)) {
+      continue;
+    }
+    if (name.substr(0, 4) == "loop" || name.substr(0, 3) == "ram")
       continue;  // 跳过虚拟盘
+    NextUint(&line, &curr.reads);
+    NextUint(&line, &skip);  // reads merged
+    NextUint(&line, &curr.sectors_read);
+    NextUint(&line, &curr.read_time_ms);
+    NextUint(&line, &curr.writes);
+    NextUint(&line, &skip);  // writes merged
+    NextUint(&line, &curr.sectors_written);
+    NextUint(&line, &curr.write_time_ms);
+    NextUint(&line, &curr.io_in_progress);
+    NextUint(&line, &curr.io_time_ms);
+    NextUint(&line, &curr.weighted_io_time_ms);
+    curr.timepoint = now;
 
     auto* disk = monitor_info->add_disk_info();
-    disk->set_name(name);
+    disk->set_name(name.data(), name.size());
     disk->set_reads(curr.reads);
     disk->set_writes(curr.writes);
     disk->set_sectors_read(curr.sectors_read);
@@ -47,9 +49,12 @@ void DiskMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
     disk->set_weighted_io_time_ms(curr.weighted_io_time_ms);
 
     // 速率/变化率计算
-    auto it = last_samples.find(name);
-    double dt = now - last_time[name];
-    if (it != last_samples.end() && dt > 0) {
+    auto it = last_samples_.find(name);
+    double dt = 0;
+    if (it != last_samples_.end()) {
+      dt = std::chrono::duration<double>(now - it->second.timepoint).count();
+    }
+    if (it != last_samples_.end() && dt > 0) {
       const auto& last = it->second;
       double read_ios = curr.reads - last.reads;
       double write_ios = curr.writes - last.writes;
@@ -75,8 +80,16 @@ void DiskMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
       disk->set_avg_write_latency_ms(0);
       disk->set_util_percent(0);
     }
-    last_samples[name] = curr;
-    last_time[name] = now;
+    if (it != last_samples_.end()) {
+      it->second = curr;
+    } else {
+      last_samples_.emplace(std::string(name), curr);
+    }
+  }
+
+  // 本次输出过的磁盘时间戳都是 now，其余是已移除的设备（nbd、容器卷等）
+  for (auto it = last_samples_.begin(); it != last_samples_.end();) {
+    it = it->second.timepoint == now ? std::next(it) : last_samples_.erase(it);
   }
 }
 
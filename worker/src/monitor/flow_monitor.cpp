@@ -0,0 +1,281 @@
+#include "monitor/flow_monitor.h"
+
+#include <arpa/inet.h>
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <net/if_arp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "monitor/tc_hook_manager.h"
+#include "monitor_info.pb.h"
+#include "utils/rtnetlink.h"
+
+// 包含生成的 skeleton 头文件
+#include "monitor/flow_stats.skel.h"
+
+// 共享数据结构，与 flow_stats.bpf.c 一致
+extern "C" {
+struct flow_key {
+  uint8_t local_addr[16];
+  uint8_t remote_addr[16];
+  uint16_t local_port;
+  uint16_t remote_port;
+  uint32_t ifindex;
+  uint8_t protocol;
+  uint8_t pad[3];
+};
+
+struct flow_stats {
+  uint64_t rcv_bytes;
+  uint64_t rcv_packets;
+  uint64_t snd_bytes;
+  uint64_t snd_packets;
+};
+}
+
+namespace monitor {
+
+namespace {
+// 排在 net_stats 的过滤器之后执行（priority 越小越先执行）
+constexpr uint32_t kFlowTcPriority = TcHookManager::kDefaultPriority + 1;
+// 每次批量读取的条数；哈希表按桶读取，一个桶的条目数不能超过它
+constexpr uint32_t kBatchSize = 256;
+// 网卡列表的刷新周期，兜底发现被删除或 ifindex 被复用的网卡
+constexpr std::chrono::seconds kLinkRefreshInterval(30);
+
+// IPv4 以 ::ffff:a.b.c.d 存放
+std::string FormatAddr(const uint8_t* addr) {
+  static const uint8_t kV4Prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+  char buf[INET6_ADDRSTRLEN];
+  bool v4 = memcmp(addr, kV4Prefix, sizeof(kV4Prefix)) == 0;
+  if (!inet_ntop(v4 ? AF_INET : AF_INET6, v4 ? addr + 12 : addr, buf,
+                 sizeof(buf))) {
+    return std::string();
+  }
+  return buf;
+}
+}  // namespace
+
+struct FlowMonitor::Flow {
+  struct flow_key key;
+  struct flow_stats stats;
+  uint64_t total_bytes;
+};
+
+FlowMonitor::FlowMonitor(size_t top_n) : top_n_(top_n) {
+  loaded_ = InitEbpf();
+  if (!loaded_) {
+    std::cerr << "FlowMonitor: failed to load eBPF program, "
+              << "per-flow stats disabled" << std::endl;
+  }
+}
+
+FlowMonitor::~FlowMonitor() {
+  CleanupEbpf();
+}
+
+bool FlowMonitor::InitEbpf() {
+  struct flow_stats_bpf* skel = flow_stats_bpf__open_and_load();
+  if (!skel) {
+    return false;
+  }
+
+  int possible_cpus = libbpf_num_possible_cpus();
+  if (possible_cpus <= 0) {
+    std::cerr << "FlowMonitor: failed to get possible CPU count" << std::endl;
+    flow_stats_bpf__destroy(skel);
+    return false;
+  }
+  possible_cpus_ = possible_cpus;
+  map_fd_ = bpf_map__fd(skel->maps.flow_stats_map);
+  map_max_entries_ = bpf_map__max_entries(skel->maps.flow_stats_map);
+  batch_keys_.resize(kBatchSize);
+  batch_values_.resize(static_cast<size_t>(kBatchSize) * possible_cpus_);
+  flows_.reserve(map_max_entries_);
+  bpf_obj_ = reinterpret_cast<struct bpf_object*>(skel);
+
+  // flow_stats 按以太网头解析；tun / wireguard / ipip 等三层设备上 skb->data
+  // 直接指向 IP 头，不挂载
+  tc_hooks_ = std::make_unique<TcHookManager>(
+      bpf_program__fd(skel->progs.tc_flow_ingress),
+      bpf_program__fd(skel->progs.tc_flow_egress), kFlowTcPriority,
+      [](const LinkInfo& link) { return link.type == ARPHRD_ETHER; });
+  if (!tc_hooks_->Start([this](uint32_t, bool) { links_changed_ = true; })) {
+    std::cerr << "FlowMonitor: link hotplug disabled, "
+              << "interfaces created later are not monitored" << std::endl;
+  }
+  last_drain_ = std::chrono::steady_clock::now();
+
+  std::cout << "FlowMonitor: top " << top_n_ << " flows on "
+            << tc_hooks_->AttachedCount() << " interfaces, map size "
+            << map_max_entries_ << std::endl;
+  return true;
+}
+
+void FlowMonitor::CleanupEbpf() {
+  // 先分离 TC hook，再销毁程序
+  tc_hooks_.reset();
+
+  if (bpf_obj_) {
+    flow_stats_bpf__destroy(reinterpret_cast<struct flow_stats_bpf*>(bpf_obj_));
+    bpf_obj_ = nullptr;
+  }
+  map_fd_ = -1;
+  loaded_ = false;
+}
+
+void FlowMonitor::AddFlow(const struct flow_key& key,
+                          const struct flow_stats* per_cpu) {
+  Flow flow = {key, {}, 0};
+  for (size_t cpu = 0; cpu < possible_cpus_; ++cpu) {
+    flow.stats.rcv_bytes += per_cpu[cpu].rcv_bytes;
+    flow.stats.rcv_packets += per_cpu[cpu].rcv_packets;
+    flow.stats.snd_bytes += per_cpu[cpu].snd_bytes;
+    flow.stats.snd_packets += per_cpu[cpu].snd_packets;
+  }
+  flow.total_bytes = flow.stats.rcv_bytes + flow.stats.snd_bytes;
+  flows_.push_back(flow);
+}
+
+bool FlowMonitor::DrainAll() {
+  flows_.clear();
+  if (batch_supported_) {
+    int err = DrainBatch();
+    if (err == 0) {
+      return true;
+    }
+    if (err != -EINVAL && err != -ENOTSUP && err != -EOPNOTSUPP &&
+        err != -ENOSPC) {
+      std::cerr << "FlowMonitor: bpf_map_lookup_and_delete_batch failed: "
+                << strerror(-err) << std::endl;
+      return false;
+    }
+    if (err != -ENOSPC) {
+      std::cerr << "FlowMonitor: batch lookup unsupported, "
+                << "falling back to per-key lookup" << std::endl;
+      batch_supported_ = false;
+    }
+    // ENOSPC：某个桶的条目比一批还多，本次剩下的逐个读出；已读出的保留
+  }
+  DrainByKey();
+  return true;
+}
+
+int FlowMonitor::DrainBatch() {
+  // 哈希表的批量读取以桶为单位续读，token 是一个 u32；读出的条目同时被删除，
+  // 之后的新包会重新插入，下次采集再读出
+  uint32_t token = 0;
+  bool first = true;
+  while (true) {
+    uint32_t count = kBatchSize;
+    LIBBPF_OPTS(bpf_map_batch_opts, opts);
+    int err = bpf_map_lookup_and_delete_batch(
+        map_fd_, first ? nullptr : &token, &token, batch_keys_.data(),
+        batch_values_.data(), &count, &opts);
+    // 兼容 libbpf 1.0 之前返回 -1 并设置 errno 的行为
+    err = err ? -errno : 0;
+    if (err && err != -ENOENT) {
+      return err;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+      AddFlow(batch_keys_[i], &batch_values_[i * possible_cpus_]);
+    }
+
+    // ENOENT 表示已读到末尾（本次可能仍带回了最后一批）
+    if (err == -ENOENT) {
+      return 0;
+    }
+    first = false;
+  }
+}
+
+void FlowMonitor::DrainByKey() {
+  // 每次都从头取第一个 key，读出后删除；最多读 map 容量条，
+  // 避免流量持续插入新流时停不下来
+  struct flow_key key;
+  for (uint32_t n = 0; n < map_max_entries_; ++n) {
+    if (bpf_map_get_next_key(map_fd_, nullptr, &key) != 0) {
+      break;
+    }
+    if (bpf_map_lookup_elem(map_fd_, &key, batch_values_.data()) == 0) {
+      AddFlow(key, batch_values_.data());
+    }
+    bpf_map_delete_elem(map_fd_, &key);
+  }
+}
+
+void FlowMonitor::RefreshLinks() {
+  std::vector<LinkInfo> links;
+  if (!DumpLinks(&links)) {
+    return;  // 保留旧的名称，下次再试
+  }
+  ifname_cache_.clear();
+  for (auto& link : links) {
+    ifname_cache_[link.ifindex] = std::move(link.name);
+  }
+}
+
+void FlowMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
+  if (!monitor_info || !loaded_ || map_fd_ < 0) {
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (!DrainAll()) {
+    return;
+  }
+  double dt = std::chrono::duration<double>(now - last_drain_).count();
+  last_drain_ = now;
+  if (dt <= 0 || flows_.empty()) {
+    return;
+  }
+
+  // O(流数) 选出前 top_n_ 条，只对这几条排序
+  auto by_bytes = [](const Flow& a, const Flow& b) {
+    return a.total_bytes > b.total_bytes;
+  };
+  if (flows_.size() > top_n_) {
+    std::nth_element(flows_.begin(), flows_.begin() + top_n_, flows_.end(),
+                     by_bytes);
+    flows_.resize(top_n_);
+  }
+  std::sort(flows_.begin(), flows_.end(), by_bytes);
+
+  bool unknown = links_changed_.exchange(false);
+  for (size_t i = 0; i < flows_.size() && !unknown; ++i) {
+    unknown = ifname_cache_.count(flows_[i].key.ifindex) == 0;
+  }
+  if (unknown || now - last_link_refresh_ >= kLinkRefreshInterval) {
+    RefreshLinks();
+    last_link_refresh_ = now;
+  }
+
+  for (const Flow& flow : flows_) {
+    auto* flow_info = monitor_info->add_flow_info();
+    auto name = ifname_cache_.find(flow.key.ifindex);
+    if (name != ifname_cache_.end()) {
+      flow_info->set_interface(name->second);
+    }
+    flow_info->set_protocol(flow.key.protocol);
+    flow_info->set_local_ip(FormatAddr(flow.key.local_addr));
+    flow_info->set_local_port(flow.key.local_port);
+    flow_info->set_remote_ip(FormatAddr(flow.key.remote_addr));
+    flow_info->set_remote_port(flow.key.remote_port);
+    // 与 NetInfo 相同的单位：kB/s
+    flow_info->set_send_rate(flow.stats.snd_bytes / 1024.0 / dt);
+    flow_info->set_rcv_rate(flow.stats.rcv_bytes / 1024.0 / dt);
+    flow_info->set_send_packets_rate(flow.stats.snd_packets / dt);
+    flow_info->set_rcv_packets_rate(flow.stats.rcv_packets / dt);
+  }
+}
+
+void FlowMonitor::Stop() {
+  CleanupEbpf();
+}
+
+}  // namespace monitor
@@ -79,17 +79,11 @@ void HostInfoMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
     return;
   }
 
-  // 主机信息通常不变，只需获取一次并缓存
-  if (!info_cached_) {
-    cached_hostname_ = GetHostname();
-    cached_ip_ = GetPrimaryIpAddress();
-    info_cached_ = true;
-  }
-
-  // 填充 HostInfo 消息
+  // 主机信息很少变化，刷新频率由 Period() 控制，每次执行都重新获取，
+  // 网卡地址变更后最多一个周期即可上报
   auto* host_info = monitor_info->mutable_host_info();
-  host_info->set_hostname(cached_hostname_);
-  host_info->set_ip_address(cached_ip_);
+  host_info->set_hostname(GetHostname());
+  host_info->set_ip_address(GetPrimaryIpAddress());
 }
 
 }  // namespace monitor
@@ -1,54 +1,57 @@
 #include "monitor/mem_monitor.h"
-#include "utils/read_file.h"
+
+#include <iterator>
+#include <string_view>
+
+#include "utils/procfs_reader.h"
 
 namespace monitor {
 static constexpr float KBToGB = 1000 * 1000;
 
+namespace {
+
+// /proc/meminfo 中关心的键，顺序与 kMemFields 一一对应
+constexpr std::string_view kMemKeys[] = {
+    "MemTotal:",     "MemFree:",        "MemAvailable:",   "Buffers:",
+    "Cached:",       "SwapCached:",     "Active:",         "Inactive:",
+    "Active(anon):", "Inactive(anon):", "Active(file):",   "Inactive(file):",
+    "Dirty:",        "Writeback:",      "AnonPages:",      "Mapped:",
+    "KReclaimable:", "SReclaimable:",   "SUnreclaim:",
+};
+constexpr StaticKeyTable<std::size(kMemKeys)> kMemKeyTable(kMemKeys);
+
+}  // namespace
+
 void MemMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
-  ReadFile mem_file("/proc/meminfo");
-  struct MenInfo mem_info;
-  std::vector<std::string> mem_datas;
-  while (mem_file.ReadLine(&mem_datas)) {
-    if (mem_datas[0] == "MemTotal:") {
-      mem_info.total = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "MemFree:") {
-      mem_info.free = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "MemAvailable:") {
-      mem_info.avail = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Buffers:") {
-      mem_info.buffers = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Cached:") {
-      mem_info.cached = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "SwapCached:") {
-      mem_info.swap_cached = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Active:") {
-      mem_info.active = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Inactive:") {
-      mem_info.in_active = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Active(anon):") {
-      mem_info.active_anon = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Inactive(anon):") {
-      mem_info.inactive_anon = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Active(file):") {
-      mem_info.active_file = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Inactive(file):") {
-      mem_info.inactive_file = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Dirty:") {
-      mem_info.dirty = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Writeback:") {
-      mem_info.writeback = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "AnonPages:") {
-      mem_info.anon_pages = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "Mapped:") {
-      mem_info.mapped = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "KReclaimable:") {
-      mem_info.kReclaimable = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "SReclaimable:") {
-      mem_info.sReclaimable = std::stoll(mem_datas[1]);
-    } else if (mem_datas[0] == "SUnreclaim:") {
-      mem_info.sUnreclaim = std::stoll(mem_datas[1]);
+  using Field = uint64_t MenInfo::*;
+  static constexpr Field kMemFields[] = {
+      &MenInfo::total,         &MenInfo::free,          &MenInfo::avail,
+      &MenInfo::buffers,       &MenInfo::cached,        &MenInfo::swap_cached,
+      &MenInfo::active,        &MenInfo::in_active,     &MenInfo::active_anon,
+      &MenInfo::inactive_anon, &MenInfo::active_file,   &MenInfo::inactive_file,
+      &MenInfo::dirty,         &MenInfo::writeback,     &MenInfo::anon_pages,
+      &MenInfo::mapped,        &MenInfo::kReclaimable,  &MenInfo::sReclaimable,
+      &MenInfo::sUnreclaim,
+  };
+  static_assert(std::size(kMemFields) == std::size(kMemKeys),
+                "kMemFields and kMemKeys must match");
+
+  struct MenInfo mem_info = {};
+  if (!meminfo_.Read()) {
+    return;
+  }
+  std::string_view line;
+  std::string_view key;
+  while (meminfo_.NextLine(&line)) {
+    // "MemTotal:       16318480 kB"
+    if (!NextField(&line, &key)) continue;
+    int index = kMemKeyTable.Find(key);
+    if (index >= 0) {
+      NextUint(&line, &(mem_info.*kMemFields[index]));
     }
-    mem_datas.clear();
+  }
+  if (mem_info.total == 0) {
+    return;
   }
 
   auto mem_detail = monitor_info->mutable_mem_info();
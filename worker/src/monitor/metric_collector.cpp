@@ -2,23 +2,113 @@
 
 #include <unistd.h>
 
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
 #include <memory>
+#include <string>
 
+#include "monitor/cpu_counter_source.h"
 #include "monitor/cpu_load_monitor.h"
 #include "monitor/cpu_softirq_monitor.h"
 #include "monitor/cpu_stat_monitor.h"
 #include "monitor/disk_monitor.h"
 #include "monitor/mem_monitor.h"
 #include "monitor/host_info_monitor.h"
+#include "monitor/monitor_structs.h"
+
+#include "monitor/net_monitor.h"
 
 #ifdef ENABLE_EBPF
+#include "monitor/flow_monitor.h"
 #include "monitor/net_ebpf_monitor.h"
-#else
-#include "monitor/net_monitor.h"
 #endif
 
 namespace monitor {
 
+namespace {
+// 执行 kExpensive 监控项的工作线程数
+constexpr size_t kSchedulerPoolThreads = 2;
+
+// MONITOR_SAMPLE_MS 允许的最小值
+constexpr long kMinSampleMs = 10;
+
+// 读取 MONITOR_SAMPLE_MS；未设置或无效时返回 false，各监控项沿用自己的周期
+bool SamplePeriod(std::chrono::milliseconds* period) {
+  const char* value = getenv("MONITOR_SAMPLE_MS");
+  if (!value) {
+    return false;
+  }
+  char* end = nullptr;
+  long ms = strtol(value, &end, 10);
+  if (end == value || *end != '\0' || ms < kMinSampleMs) {
+    std::cerr << "Invalid MONITOR_SAMPLE_MS '" << value
+              << "', using default periods" << std::endl;
+    return false;
+  }
+  *period = std::chrono::milliseconds(ms);
+  return true;
+}
+
+// 网络流量的来源：环境变量 MONITOR_NET_BACKEND 指定 ebpf / netlink / procfs，
+// 默认 auto 在编译了 eBPF 时先试 ebpf，其次 netlink，最后 procfs
+std::unique_ptr<MonitorInter> CreateNetMonitor() {
+  std::string name = "auto";
+  if (const char* value = getenv("MONITOR_NET_BACKEND")) {
+    name = value;
+    if (name != "auto" && name != "ebpf" && name != "netlink" &&
+        name != "procfs") {
+      std::cerr << "Unknown MONITOR_NET_BACKEND '" << name
+                << "', using auto" << std::endl;
+      name = "auto";
+    }
+  }
+
+#ifdef ENABLE_EBPF
+  if (name == "auto" || name == "ebpf") {
+    auto monitor = std::make_unique<NetEbpfMonitor>();
+    if (monitor->IsLoaded()) {
+      std::cout << "Net stats backend: ebpf" << std::endl;
+      return monitor;
+    }
+  }
+#else
+  if (name == "ebpf") {
+    std::cerr << "Net backend ebpf unavailable (built without eBPF), "
+                 "using netlink" << std::endl;
+  }
+#endif
+
+  auto backend = name == "procfs" ? NetMonitor::Backend::kProcfs
+                                  : NetMonitor::Backend::kNetlink;
+  auto monitor = std::make_unique<NetMonitor>(backend);
+  std::cout << "Net stats backend: "
+            << NetMonitor::BackendName(monitor->backend()) << std::endl;
+  return monitor;
+}
+
+#ifdef ENABLE_EBPF
+// 读取 MONITOR_FLOW_TOP_N；未设置或为 0 时不统计按流流量（不挂载
+// flow_stats 程序）。它在每个网卡的数据路径上逐包解析并更新哈希表，
+// 开销比 net_stats 大，只在显式要求时启用，MONITOR_NET_BACKEND=netlink
+// 选择的零数据路径开销不会被它破坏
+long FlowTopN() {
+  const char* value = getenv("MONITOR_FLOW_TOP_N");
+  if (!value) {
+    return 0;
+  }
+  char* end = nullptr;
+  long n = strtol(value, &end, 10);
+  if (end == value || *end != '\0' || n < 0) {
+    std::cerr << "Invalid MONITOR_FLOW_TOP_N '" << value
+              << "', per-flow stats disabled" << std::endl;
+    return 0;
+  }
+  return n;
+}
+#endif
+}  // namespace
+
 MetricCollector::MetricCollector() {
   // 获取主机名
   char hostname[256];
@@ -28,21 +118,86 @@ MetricCollector::MetricCollector() {
     hostname_ = "unknown";
   }
 
+  // CPU 状态、软中断、平均负载由同一个内核模块导出，三者共用一个映射
+  kmod_stats_ =
+      std::make_shared<KmodMapping>(MONITOR_DEVICE_PATH, MONITOR_SHM_SIZE);
+
+  // 核心指标的采样周期：MONITOR_SAMPLE_MS 未设置时各监控项沿用自己的周期
+  std::chrono::milliseconds sample_period;
+  bool override_period = SamplePeriod(&sample_period);
+
+  // CPU 时间与软中断计数的来源：环境变量 MONITOR_CPU_BACKEND 指定
+  // kmod / ebpf / procfs，默认 auto 按此顺序选第一个可用的；
+  // eBPF 来源按 CPU 的采样周期刷新各 CPU 的计数
+  auto backend = CpuCounterSource::Backend::kAuto;
+  if (const char* name = getenv("MONITOR_CPU_BACKEND")) {
+    if (!CpuCounterSource::ParseBackend(name, &backend)) {
+      std::cerr << "Unknown MONITOR_CPU_BACKEND '" << name
+                << "', using auto" << std::endl;
+    }
+  }
+  // 未覆盖时为 CpuStatMonitor 默认的 1 秒周期（MonitorInter::Period()）
+  std::chrono::milliseconds cpu_period =
+      override_period ? sample_period : std::chrono::seconds(1);
+  std::shared_ptr<CpuCounterSource> cpu_source =
+      CpuCounterSource::Create(backend, kmod_stats_, cpu_period);
+  if (!cpu_source) {
+    std::cerr << "CPU backend " << CpuCounterSource::BackendName(backend)
+              << " unavailable, falling back to procfs" << std::endl;
+    cpu_source = CpuCounterSource::Create(CpuCounterSource::Backend::kProcfs,
+                                          kmod_stats_);
+  }
+  std::cout << "CPU stats backend: "
+            << CpuCounterSource::BackendName(cpu_source->backend())
+            << std::endl;
+
   // 初始化所有监控器
-  monitors_.push_back(std::make_unique<CpuLoadMonitor>());
-  monitors_.push_back(std::make_unique<CpuStatMonitor>());
-  monitors_.push_back(std::make_unique<CpuSoftIrqMonitor>());
+  monitors_.push_back(std::make_unique<CpuLoadMonitor>(kmod_stats_));
   monitors_.push_back(std::make_unique<MemMonitor>());
+  monitors_.push_back(std::make_unique<HostInfoMonitor>());
 #ifdef ENABLE_EBPF
-  monitors_.push_back(std::make_unique<NetEbpfMonitor>());
-#else
-  monitors_.push_back(std::make_unique<NetMonitor>());
+  if (long top_n = FlowTopN(); top_n > 0) {
+    auto flows = std::make_unique<FlowMonitor>(static_cast<size_t>(top_n));
+    if (flows->IsLoaded()) {
+      monitors_.push_back(std::move(flows));
+    }
+  }
 #endif
-  monitors_.push_back(std::make_unique<DiskMonitor>());
-  monitors_.push_back(std::make_unique<HostInfoMonitor>());
+  // 核心指标：按 MONITOR_SAMPLE_MS 采样，推送时附带窗口统计
+  std::vector<std::unique_ptr<MonitorInter>> sampled;
+  sampled.push_back(std::make_unique<CpuStatMonitor>(cpu_source));
+  sampled.push_back(std::make_unique<CpuSoftIrqMonitor>(cpu_source));
+  sampled.push_back(CreateNetMonitor());
+  sampled.push_back(std::make_unique<DiskMonitor>());
+
+  scheduler_ = std::make_unique<MonitorScheduler>(kSchedulerPoolThreads);
+  for (auto& monitor : monitors_) {
+    scheduler_->Add(monitor.get());
+  }
+  for (auto& monitor : sampled) {
+    if (override_period) {
+      scheduler_->Add(monitor.get(), sample_period);
+    } else {
+      scheduler_->Add(monitor.get());
+    }
+    monitors_.push_back(std::move(monitor));
+  }
+  scheduler_->SetResultObserver(
+      [this](const monitor::proto::MonitorInfo& result) {
+        aggregator_.Observe(result);
+      });
+  // 让内核模块在读取前刷新一次，同一轮的 CPU 状态 / 软中断 / 平均负载读到的
+  // 是此刻的同一份数据；模块未加载或不支持 SNAPSHOT 时沿用其后台定时器刷新的数据
+  scheduler_->SetBeforeCheapRun([this] {
+    if (kmod_stats_->Get()) {
+      kmod_stats_->Ioctl(MONITOR_IOC_SNAPSHOT);
+    }
+  });
+  scheduler_->Start();
 }
 
 MetricCollector::~MetricCollector() {
+  scheduler_->Stop();
   for (auto& monitor : monitors_) {
     monitor->Stop();
   }
@@ -56,10 +211,9 @@ void MetricCollector::CollectAll(monitor::proto::MonitorInfo* monitor_info) {
   // 设置主机名
   monitor_info->set_name(hostname_);
 
-  // 调用每个监控器的 UpdateOnce 方法
-  for (auto& monitor : monitors_) {
-    monitor->UpdateOnce(monitor_info);
-  }
+  // 合并各监控项最近一次的结果，附上本窗口（上一次 CollectAll 以来）的统计
+  scheduler_->MergeLatest(monitor_info);
+  aggregator_.Fill(monitor_info);
 }
 
 }  // namespace monitor
@@ -0,0 +1,157 @@
+#include "monitor/monitor_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace monitor {
+
+MonitorScheduler::MonitorScheduler(size_t pool_threads)
+    : pool_threads_(std::max<size_t>(1, pool_threads)) {}
+
+MonitorScheduler::~MonitorScheduler() {
+  Stop();
+}
+
+void MonitorScheduler::Add(MonitorInter* monitor) {
+  Add(monitor, monitor->Period());
+}
+
+void MonitorScheduler::Add(MonitorInter* monitor,
+                           std::chrono::milliseconds period) {
+  auto entry = std::make_unique<Entry>();
+  entry->monitor = monitor;
+  entry->period = std::max(period, std::chrono::milliseconds(1));
+  entry->cost = monitor->Cost();
+  entries_.push_back(std::move(entry));
+}
+
+void MonitorScheduler::SetBeforeCheapRun(std::function<void()> hook) {
+  before_cheap_run_ = std::move(hook);
+}
+
+void MonitorScheduler::SetResultObserver(
+    std::function<void(const monitor::proto::MonitorInfo&)> observer) {
+  result_observer_ = std::move(observer);
+}
+
+void MonitorScheduler::Start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  for (auto& entry : entries_) {
+    entry->next_run = now;
+  }
+  for (size_t i = 0; i < pool_threads_; ++i) {
+    workers_.emplace_back(&MonitorScheduler::WorkerLoop, this);
+  }
+  thread_ = std::thread(&MonitorScheduler::Loop, this);
+}
+
+void MonitorScheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mtx_);
+    queue_closed_ = true;
+    queue_.clear();
+  }
+  queue_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void MonitorScheduler::MergeLatest(
+    monitor::proto::MonitorInfo* monitor_info) const {
+  for (const auto& entry : entries_) {
+    std::lock_guard<std::mutex> lock(entry->mtx);
+    monitor_info->MergeFrom(entry->latest);
+  }
+}
+
+void MonitorScheduler::Loop() {
+  std::vector<Entry*> due;
+  while (true) {
+    auto now = std::chrono::steady_clock::now();
+    due.clear();
+    bool cheap_due = false;
+    for (auto& entry : entries_) {
+      if (entry->next_run > now) continue;
+      // 固定时刻表：错过的时刻直接跳过
+      entry->next_run += entry->period;
+      if (entry->next_run <= now) {
+        auto missed = (now - entry->next_run) / entry->period + 1;
+        entry->next_run += entry->period * missed;
+      }
+      due.push_back(entry.get());
+      cheap_due |= entry->cost == MonitorCost::kCheap;
+    }
+
+    for (Entry* entry : due) {
+      if (entry->cost != MonitorCost::kExpensive) continue;
+      if (entry->running.exchange(true)) continue;  // 上一次还没结束
+      {
+        std::lock_guard<std::mutex> lock(queue_mtx_);
+        queue_.push_back(entry);
+      }
+      queue_cv_.notify_one();
+    }
+
+    if (cheap_due && before_cheap_run_) {
+      before_cheap_run_();
+    }
+    for (Entry* entry : due) {
+      if (entry->cost == MonitorCost::kCheap) {
+        Run(entry);
+      }
+    }
+
+    // 没有监控项时也定期醒来，避免 wait_until(time_point::max()) 溢出
+    auto next = now + std::chrono::minutes(1);
+    for (const auto& entry : entries_) {
+      next = std::min(next, entry->next_run);
+    }
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (cv_.wait_until(lock, next, [this] { return stopping_; })) {
+      return;
+    }
+  }
+}
+
+void MonitorScheduler::WorkerLoop() {
+  while (true) {
+    Entry* entry = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(queue_mtx_);
+      queue_cv_.wait(lock, [this] { return queue_closed_ || !queue_.empty(); });
+      if (queue_closed_) {
+        return;
+      }
+      entry = queue_.front();
+      queue_.pop_front();
+    }
+    Run(entry);
+    entry->running = false;
+  }
+}
+
+void MonitorScheduler::Run(Entry* entry) {
+  monitor::proto::MonitorInfo result;
+  entry->monitor->UpdateOnce(&result);
+  if (result_observer_) {
+    result_observer_(result);
+  }
+  std::lock_guard<std::mutex> lock(entry->mtx);
+  entry->latest.Swap(&result);
+}
+
+}  // namespace monitor
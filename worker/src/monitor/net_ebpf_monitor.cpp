@@ -2,19 +2,14 @@
 
 #include <bpf/libbpf.h>
 #include <bpf/bpf.h>
-#include <net/if.h>
-#include <linux/if_link.h>
-#include <linux/pkt_sched.h>
 #include <unistd.h>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
-#include <fstream>
-#include <dirent.h>
-#include <sys/socket.h>
-#include <linux/netlink.h>
-#include <linux/rtnetlink.h>
 
+#include "monitor/tc_hook_manager.h"
 #include "monitor_info.pb.h"
+#include "utils/rtnetlink.h"
 
 // 包含生成的 skeleton 头文件
 #include "monitor/net_stats.skel.h"
@@ -31,64 +26,15 @@ struct net_stats {
 
 namespace monitor {
 
-// 获取系统所有网卡的 ifindex索引号
-static std::vector<uint32_t> GetAllIfIndexes() {
-    std::vector<uint32_t> indexes;
-
-    DIR* dir = opendir("/sys/class/net");
-    if (!dir) return indexes;
-
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        if (entry->d_name[0] == '.') continue;
-        
-        unsigned int ifindex = if_nametoindex(entry->d_name);
-        if (ifindex > 0) {
-            indexes.push_back(ifindex);
-        }
-    }
-    closedir(dir);
-    return indexes;
-}
-
-// TC qdisc 操作辅助函数
-static int tc_qdisc_create_clsact(int ifindex) {
-    // 使用 system 调用 tc 命令创建 clsact qdisc
-    // 这是最简单可靠的方式
-    char cmd[256];
-    snprintf(cmd, sizeof(cmd), 
-             "tc qdisc add dev $(cat /sys/class/net/*/ifindex | "
-             "while read idx; do [ \"$idx\" = \"%d\" ] && "
-             "basename $(dirname $(grep -l $idx /sys/class/net/*/ifindex)); done) "
-             "clsact 2>/dev/null || true", ifindex);
-    
-    // 更简单的方式：通过 ifindex 获取设备名
-    char ifname[IF_NAMESIZE];
-    if (if_indextoname(ifindex, ifname) == nullptr) {
-        return -1;
-    }
-    
-    snprintf(cmd, sizeof(cmd), "tc qdisc add dev %s clsact 2>/dev/null", ifname);
-    return system(cmd);
-}
-
-static int tc_qdisc_delete_clsact(int ifindex) {
-    char ifname[IF_NAMESIZE];
-    if (if_indextoname(ifindex, ifname) == nullptr) {
-        return -1;
-    }
-    
-    char cmd[256];
-    snprintf(cmd, sizeof(cmd), "tc qdisc del dev %s clsact 2>/dev/null", ifname);
-    return system(cmd);
-}
+// 网卡列表的刷新周期，兜底发现被删除或 ifindex 被复用的网卡
+constexpr std::chrono::seconds kLinkRefreshInterval(30);
 
 NetEbpfMonitor::NetEbpfMonitor() {
     last_update_ = std::chrono::steady_clock::now();
     loaded_ = InitEbpf();
     if (!loaded_) {
         std::cerr << "NetEbpfMonitor: Failed to load eBPF program, "
-                  << "falling back to /proc/net/dev" << std::endl;
+                  << "falling back to kernel link counters" << std::endl;
     }
 }
 
@@ -122,94 +68,40 @@ bool NetEbpfMonitor::InitEbpf() {
         return false;
     }
 
-    // 获取所有网卡并附加 TC hook
-    auto ifindexes = GetAllIfIndexes();
-    int ingress_fd = bpf_program__fd(skel->progs.tc_ingress);
-    int egress_fd = bpf_program__fd(skel->progs.tc_egress);
-
-    for (uint32_t ifindex : ifindexes) {
-        char ifname[IF_NAMESIZE];
-        if (if_indextoname(ifindex, ifname) == nullptr) continue;
-        
-        // 跳过 loopback
-        if (strcmp(ifname, "lo") == 0) continue;
-
-        // 创建 clsact qdisc
-        tc_qdisc_create_clsact(ifindex);
-
-        // 使用 libbpf 的 TC attach API
-        LIBBPF_OPTS(bpf_tc_hook, hook,
-            .ifindex = static_cast<int>(ifindex),
-            .attach_point = BPF_TC_INGRESS,
-        );
-        
-        // 创建 hook
-        err = bpf_tc_hook_create(&hook);
-        if (err && err != -EEXIST) {
-            std::cerr << "Failed to create TC hook for " << ifname 
-                      << ": " << strerror(-err) << std::endl;
-            continue;
-        }
-
-        // 附加 ingress 程序
-        LIBBPF_OPTS(bpf_tc_opts, opts_in,
-            .prog_fd = ingress_fd,
-        );
-        err = bpf_tc_attach(&hook, &opts_in);
-        if (err) {
-            std::cerr << "Failed to attach TC ingress for " << ifname 
-                      << ": " << strerror(-err) << std::endl;
-        } else {
-            attached_ifindexes_.push_back(ifindex);
-            std::cout << "Attached TC ingress to " << ifname << std::endl;
-        }
-
-        // 附加 egress 程序
-        hook.attach_point = BPF_TC_EGRESS;
-        LIBBPF_OPTS(bpf_tc_opts, opts_eg,
-            .prog_fd = egress_fd,
-        );
-        err = bpf_tc_attach(&hook, &opts_eg);
-        if (err) {
-            std::cerr << "Failed to attach TC egress for " << ifname 
-                      << ": " << strerror(-err) << std::endl;
-        } else {
-            std::cout << "Attached TC egress to " << ifname << std::endl;
-        }
+    // per-CPU map 的查找结果按可能的 CPU 数（而不是在线 CPU 数）排列
+    int possible_cpus = libbpf_num_possible_cpus();
+    if (possible_cpus <= 0) {
+        std::cerr << "Failed to get possible CPU count" << std::endl;
+        net_stats_bpf__destroy(skel);
+        return false;
     }
+    possible_cpus_ = possible_cpus;
+    map_max_entries_ = bpf_map__max_entries(skel->maps.net_stats_map);
+    batch_keys_.resize(map_max_entries_);
+    batch_values_.resize(static_cast<size_t>(map_max_entries_) * possible_cpus_);
+    keys_.reserve(map_max_entries_);
+    totals_.reserve(map_max_entries_);
 
     // 保存 skeleton 指针
     bpf_obj_ = reinterpret_cast<struct bpf_object*>(skel);
 
-    if (attached_ifindexes_.empty()) {
-        std::cerr << "No interfaces attached" << std::endl;
-        net_stats_bpf__destroy(skel);
-        bpf_obj_ = nullptr;
-        return false;
+    // 挂到所有网卡，并在网卡增删时自动挂载；网卡变化后下一次采集立即刷新名称
+    tc_hooks_ = std::make_unique<TcHookManager>(
+        bpf_program__fd(skel->progs.tc_ingress),
+        bpf_program__fd(skel->progs.tc_egress));
+    if (!tc_hooks_->Start([this](uint32_t, bool) { links_changed_ = true; })) {
+        std::cerr << "NetEbpfMonitor: link hotplug disabled, "
+                  << "interfaces created later are not monitored" << std::endl;
     }
 
-    std::cout << "NetEbpfMonitor: eBPF TC hook loaded successfully" << std::endl;
+    std::cout << "NetEbpfMonitor: eBPF TC hook loaded on "
+              << tc_hooks_->AttachedCount() << " interfaces" << std::endl;
     return true;
 }
 
 void NetEbpfMonitor::CleanupEbpf() {
-    // 分离 TC hook
-    for (uint32_t ifindex : attached_ifindexes_) {
-        LIBBPF_OPTS(bpf_tc_hook, hook,
-            .ifindex = static_cast<int>(ifindex),
-            .attach_point = BPF_TC_INGRESS,
-        );
-        
-        LIBBPF_OPTS(bpf_tc_opts, opts);
-        bpf_tc_detach(&hook, &opts);
-        
-        hook.attach_point = BPF_TC_EGRESS;
-        bpf_tc_detach(&hook, &opts);
-        
-        // 可选：删除 clsact qdisc
-        // tc_qdisc_delete_clsact(ifindex);
-    }
-    attached_ifindexes_.clear();
+    // 先停止热插拔监听并分离 TC hook，再销毁程序
+    tc_hooks_.reset();
 
     if (bpf_obj_) {
         net_stats_bpf__destroy(reinterpret_cast<struct net_stats_bpf*>(bpf_obj_));
@@ -219,22 +111,107 @@ void NetEbpfMonitor::CleanupEbpf() {
     loaded_ = false;
 }
 
-std::string NetEbpfMonitor::GetIfName(uint32_t ifindex) {
-    // 先查缓存
-    auto it = ifname_cache_.find(ifindex);
-    if (it != ifname_cache_.end()) {
-        return it->second;
+bool NetEbpfMonitor::ReadAllStats() {
+    keys_.clear();
+    totals_.clear();
+    if (batch_supported_) {
+        int err = ReadBatch();
+        if (err == 0) {
+            return true;
+        }
+        if (err != -EINVAL && err != -ENOTSUP && err != -EOPNOTSUPP) {
+            std::cerr << "NetEbpfMonitor: bpf_map_lookup_batch failed: "
+                      << strerror(-err) << std::endl;
+            return false;
+        }
+        // 内核不支持对该类型 map 批量读取
+        std::cerr << "NetEbpfMonitor: batch lookup unsupported, "
+                  << "falling back to per-key lookup" << std::endl;
+        batch_supported_ = false;
+        keys_.clear();
+        totals_.clear();
     }
+    return ReadByKey();
+}
 
-    // 使用 if_indextoname 获取网卡名
-    char ifname[IF_NAMESIZE];
-    if (if_indextoname(ifindex, ifname) != nullptr) {
-        std::string name(ifname);
-        ifname_cache_[ifindex] = name;
-        return name;
+int NetEbpfMonitor::ReadBatch() {
+    // PERCPU_HASH 的批量读取以桶为单位续读，token 是一个 u32
+    uint32_t token = 0;
+    bool first = true;
+    while (true) {
+        uint32_t count = map_max_entries_;
+        LIBBPF_OPTS(bpf_map_batch_opts, opts);
+        int err = bpf_map_lookup_batch(map_fd_, first ? nullptr : &token, &token,
+                                       batch_keys_.data(), batch_values_.data(),
+                                       &count, &opts);
+        // 兼容 libbpf 1.0 之前返回 -1 并设置 errno 的行为
+        err = err ? -errno : 0;
+        if (err && err != -ENOENT) {
+            return err;
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const struct net_stats* values = &batch_values_[i * possible_cpus_];
+            struct net_stats sum = {};
+            for (size_t cpu = 0; cpu < possible_cpus_; ++cpu) {
+                sum.rcv_bytes += values[cpu].rcv_bytes;
+                sum.rcv_packets += values[cpu].rcv_packets;
+                sum.snd_bytes += values[cpu].snd_bytes;
+                sum.snd_packets += values[cpu].snd_packets;
+            }
+            keys_.push_back(batch_keys_[i]);
+            totals_.push_back(sum);
+        }
+
+        // ENOENT 表示已读到末尾（本次可能仍带回了最后一批）
+        if (err == -ENOENT) {
+            return 0;
+        }
+        first = false;
     }
+}
 
-    return "";
+bool NetEbpfMonitor::ReadByKey() {
+    uint32_t key = 0, next_key;
+    const uint32_t* prev = nullptr;  // 从头开始遍历
+    while (bpf_map_get_next_key(map_fd_, prev, &next_key) == 0) {
+        if (bpf_map_lookup_elem(map_fd_, &next_key, batch_values_.data()) == 0) {
+            struct net_stats sum = {};
+            for (size_t cpu = 0; cpu < possible_cpus_; ++cpu) {
+                sum.rcv_bytes += batch_values_[cpu].rcv_bytes;
+                sum.rcv_packets += batch_values_[cpu].rcv_packets;
+                sum.snd_bytes += batch_values_[cpu].snd_bytes;
+                sum.snd_packets += batch_values_[cpu].snd_packets;
+            }
+            keys_.push_back(next_key);
+            totals_.push_back(sum);
+        }
+        key = next_key;
+        prev = &key;
+    }
+    return true;
+}
+
+void NetEbpfMonitor::RefreshLinks() {
+    std::vector<LinkInfo> links;
+    if (!DumpLinks(&links)) {
+        return;  // 保留旧的名称，下次再试
+    }
+    ifname_cache_.clear();
+    for (auto& link : links) {
+        ifname_cache_[link.ifindex] = std::move(link.name);
+    }
+
+    // 已删除网卡的计数不会再增长，从 BPF map 与速率缓存中清除；
+    // ifindex 被新网卡复用时名称随之更新
+    for (uint32_t ifindex : keys_) {
+        if (ifname_cache_.count(ifindex) == 0) {
+            bpf_map_delete_elem(map_fd_, &ifindex);
+        }
+    }
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        it = ifname_cache_.count(it->first) ? std::next(it) : cache_.erase(it);
+    }
 }
 
 void NetEbpfMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
@@ -243,74 +220,77 @@ void NetEbpfMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
     }
 
     auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - last_update_).count();
-    
-    // 避免除零
-    if (duration == 0) {
-        duration = 1;
+
+    // 一到两次系统调用读出所有网卡的统计
+    if (!ReadAllStats()) {
+        return;
     }
 
-    // 遍历 BPF map 获取所有网卡统计
-    uint32_t key = 0, next_key;
-    struct net_stats stats;
-
-    while (bpf_map_get_next_key(map_fd_, &key, &next_key) == 0) {
-        if (bpf_map_lookup_elem(map_fd_, &next_key, &stats) == 0) {
-            std::string ifname = GetIfName(next_key);
-            if (ifname.empty() || ifname == "lo") {
-                // 跳过未知网卡和 loopback
-                key = next_key;
-                continue;
-            }
+    // 网卡有增删、出现未知的 ifindex 或到了刷新周期时重新获取网卡列表，
+    // 并清理已删除的网卡
+    bool unknown = links_changed_.exchange(false);
+    for (size_t i = 0; i < keys_.size() && !unknown; ++i) {
+        unknown = ifname_cache_.count(keys_[i]) == 0;
+    }
+    if (unknown || now - last_link_refresh_ >= kLinkRefreshInterval) {
+        RefreshLinks();
+        last_link_refresh_ = now;
+    }
 
-            auto* net_info = monitor_info->add_net_info();
-            net_info->set_name(ifname);
-
-            // 查找上次的缓存数据
-            auto cache_it = cache_.find(next_key);
-            if (cache_it != cache_.end()) {
-                const auto& old = cache_it->second;
-                auto old_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - old.timestamp).count();
-                
-                if (old_duration > 0) {
-                    // 计算速率 (bytes/sec)
-                    int64_t rcv_diff = stats.rcv_bytes - old.rcv_bytes;
-                    int64_t snd_diff = stats.snd_bytes - old.snd_bytes;
-                    int64_t rcv_pkt_diff = stats.rcv_packets - old.rcv_packets;
-                    int64_t snd_pkt_diff = stats.snd_packets - old.snd_packets;
-
-                    // 处理计数器溢出
-                    if (rcv_diff < 0) rcv_diff = stats.rcv_bytes;
-                    if (snd_diff < 0) snd_diff = stats.snd_bytes;
-                    if (rcv_pkt_diff < 0) rcv_pkt_diff = stats.rcv_packets;
-                    if (snd_pkt_diff < 0) snd_pkt_diff = stats.snd_packets;
-
-                    // 转换为每秒速率
-                    net_info->set_rcv_rate(rcv_diff * 1000 / old_duration);
-                    net_info->set_send_rate(snd_diff * 1000 / old_duration);
-                    net_info->set_rcv_packets_rate(rcv_pkt_diff * 1000 / old_duration);
-                    net_info->set_send_packets_rate(snd_pkt_diff * 1000 / old_duration);
-                }
-            } else {
-                // 首次采集，速率为 0
-                net_info->set_rcv_rate(0);
-                net_info->set_send_rate(0);
-                net_info->set_rcv_packets_rate(0);
-                net_info->set_send_packets_rate(0);
-            }
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        uint32_t ifindex = keys_[i];
+        const struct net_stats& stats = totals_[i];
 
-            // 更新缓存
-            cache_[next_key] = {
-                stats.rcv_bytes,
-                stats.rcv_packets,
-                stats.snd_bytes,
-                stats.snd_packets,
-                now
-            };
+        auto name_it = ifname_cache_.find(ifindex);
+        if (name_it == ifname_cache_.end() || name_it->second == "lo") {
+            // 跳过已删除的网卡和 loopback
+            continue;
         }
-        key = next_key;
+
+        auto* net_info = monitor_info->add_net_info();
+        net_info->set_name(name_it->second);
+
+        // 查找上次的缓存数据
+        auto cache_it = cache_.find(ifindex);
+        if (cache_it != cache_.end()) {
+            const auto& old = cache_it->second;
+            double dt = std::chrono::duration<double>(now - old.timestamp).count();
+
+            if (dt > 0) {
+                // 计算速率，单位与 NetMonitor 一致：字节为 KB/s，包为 个/s
+                int64_t rcv_diff = stats.rcv_bytes - old.rcv_bytes;
+                int64_t snd_diff = stats.snd_bytes - old.snd_bytes;
+                int64_t rcv_pkt_diff = stats.rcv_packets - old.rcv_packets;
+                int64_t snd_pkt_diff = stats.snd_packets - old.snd_packets;
+
+                // 处理计数器溢出
+                if (rcv_diff < 0) rcv_diff = stats.rcv_bytes;
+                if (snd_diff < 0) snd_diff = stats.snd_bytes;
+                if (rcv_pkt_diff < 0) rcv_pkt_diff = stats.rcv_packets;
+                if (snd_pkt_diff < 0) snd_pkt_diff = stats.snd_packets;
+
+                // 转换为每秒速率
+                net_info->set_rcv_rate(rcv_diff / 1024.0 / dt);
+                net_info->set_send_rate(snd_diff / 1024.0 / dt);
+                net_info->set_rcv_packets_rate(rcv_pkt_diff / dt);
+                net_info->set_send_packets_rate(snd_pkt_diff / dt);
+            }
+        } else {
+            // 首次采集，速率为 0
+            net_info->set_rcv_rate(0);
+            net_info->set_send_rate(0);
+            net_info->set_rcv_packets_rate(0);
+            net_info->set_send_packets_rate(0);
+        }
+
+        // 更新缓存
+        cache_[ifindex] = {
+            stats.rcv_bytes,
+            stats.rcv_packets,
+            stats.snd_bytes,
+            stats.snd_packets,
+            now
+        };
     }
 
     last_update_ = now;
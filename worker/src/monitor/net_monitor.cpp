@@ -1,17 +1,27 @@
 #include "monitor/net_monitor.h"
+#include <linux/if_link.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
 #include <string>
-#include <vector>
+#include <string_view>
 #include <cstdint>
-#include <fstream>
-#include <sstream>
 #include "monitor_info.grpc.pb.h"
 #include "monitor_info.pb.h"
 
 namespace monitor {
 
-struct NetStat {
-    std::string name;
+namespace {
+// 网卡名表的定期刷新间隔；dump 中出现未知 ifindex 时也会立即刷新
+constexpr auto kLinkNamesRefreshInterval = std::chrono::seconds(30);
+}  // namespace
+
+struct NetMonitor::NetStat {
+    std::string_view name;
     uint64_t rcv_bytes;
     uint64_t rcv_packets;
     uint64_t snd_bytes;
@@ -22,87 +32,197 @@ struct NetStat {
     uint64_t drop_out;
 };
 
-// 从 /proc/net/dev 读取网络统计信息
-static std::vector<NetStat> get_net_stats_from_proc() {
-    std::vector<NetStat> stats;
-    std::ifstream file("/proc/net/dev");
-    if (!file.is_open()) return stats;
-
-    std::string line;
-    // 跳过前两行标题
-    std::getline(file, line);
-    std::getline(file, line);
-
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        NetStat stat;
-        
-        // 解析接口名
-        std::string iface;
-        iss >> iface;
-        if (iface.empty()) continue;
-        
-        // 移除末尾的冒号
-        if (iface.back() == ':') {
-            iface.pop_back();
-        }
-        
-        // 跳过 lo 接口
-        if (iface == "lo") continue;
-        
-        stat.name = iface;
-        
-        // 解析接收统计: bytes packets errs drop fifo frame compressed multicast
-        iss >> stat.rcv_bytes >> stat.rcv_packets >> stat.err_in >> stat.drop_in;
-        uint64_t dummy;
-        iss >> dummy >> dummy >> dummy >> dummy;  // fifo frame compressed multicast
-        
-        // 解析发送统计: bytes packets errs drop fifo colls carrier compressed
-        iss >> stat.snd_bytes >> stat.snd_packets >> stat.err_out >> stat.drop_out;
-        
-        stats.push_back(stat);
+// 解析 /proc/net/dev 的一行接口统计，标题行与 lo 返回 false
+static bool ParseNetDevLine(std::string_view line, NetMonitor::NetStat* stat) {
+    // "  eth0: 1234 ..."，计数很大时冒号后可能没有空格，按冒号切分接口名
+    size_t colon = line.find(':');
+    if (colon == std::string_view::npos) return false;
+    std::string_view iface = line.substr(0, colon);
+    if (!NextField(&iface, &stat->name)) return false;
+
+    // 跳过 lo 接口
+    if (stat->name == "lo") return false;
+
+    line.remove_prefix(colon + 1);
+    uint64_t dummy;
+    // 解析接收统计: bytes packets errs drop fifo frame compressed multicast
+    NextUint(&line, &stat->rcv_bytes);
+    NextUint(&line, &stat->rcv_packets);
+    NextUint(&line, &stat->err_in);
+    NextUint(&line, &stat->drop_in);
+    for (int i = 0; i < 4; ++i) NextUint(&line, &dummy);
+
+    // 解析发送统计: bytes packets errs drop fifo colls carrier compressed
+    NextUint(&line, &stat->snd_bytes);
+    NextUint(&line, &stat->snd_packets);
+    NextUint(&line, &stat->err_out);
+    NextUint(&line, &stat->drop_out);
+    return true;
+}
+
+// 从 RTM_GETSTATS 应答中取出 IFLA_STATS_LINK_64，与 /proc/net/dev 的列对应
+static bool ParseStatsMessage(const struct nlmsghdr* nh, uint32_t* ifindex,
+                              struct rtnl_link_stats64* stats) {
+    if (nh->nlmsg_type != RTM_NEWSTATS) return false;
+    auto* ifsm = static_cast<const struct if_stats_msg*>(NLMSG_DATA(nh));
+    *ifindex = ifsm->ifindex;
+
+    auto* rta = reinterpret_cast<const struct rtattr*>(
+        reinterpret_cast<const char*>(ifsm) + NLMSG_ALIGN(sizeof(*ifsm)));
+    int attr_len = static_cast<int>(nh->nlmsg_len) -
+                   static_cast<int>(NLMSG_LENGTH(sizeof(*ifsm)));
+    for (; RTA_OK(rta, attr_len); rta = RTA_NEXT(rta, attr_len)) {
+        if (rta->rta_type != IFLA_STATS_LINK_64) continue;
+        // 属性只保证 4 字节对齐，复制出来再读 u64；老内核的结构可能更短
+        memset(stats, 0, sizeof(*stats));
+        memcpy(stats, RTA_DATA(rta),
+               std::min<size_t>(RTA_PAYLOAD(rta), sizeof(*stats)));
+        return true;
     }
-    
-    return stats;
+    return false;
+}
+
+NetMonitor::NetMonitor(Backend backend)
+    : backend_(backend), net_dev_("/proc/net/dev") {
+    if (backend_ == Backend::kNetlink && !rtnl_.Open()) {
+        std::cerr << "NetMonitor: failed to open netlink socket: "
+                  << strerror(errno) << ", falling back to /proc/net/dev"
+                  << std::endl;
+        backend_ = Backend::kProcfs;
+    }
+}
+
+const char* NetMonitor::BackendName(Backend backend) {
+    switch (backend) {
+        case Backend::kProcfs:
+            return "procfs";
+        case Backend::kNetlink:
+            return "netlink";
+    }
+    return "unknown";
 }
 
 void NetMonitor::UpdateOnce(monitor::proto::MonitorInfo* monitor_info) {
     auto now = std::chrono::steady_clock::now();
-    auto stats = get_net_stats_from_proc();
-
-    for (const auto& stat : stats) {
-        auto it = last_net_info_.find(stat.name);
-        double rcv_rate = 0, rcv_packets_rate = 0, send_rate = 0, send_packets_rate = 0;
-
-        if (it != last_net_info_.end()) {
-            const NetInfo& last = it->second;
-            double dt = std::chrono::duration<double>(now - last.timepoint).count();
-            if (dt > 0) {
-                rcv_rate = (stat.rcv_bytes - last.rcv_bytes) / 1024.0 / dt; // KB/s
-                rcv_packets_rate = (stat.rcv_packets - last.rcv_packets) / dt;
-                send_rate = (stat.snd_bytes - last.snd_bytes) / 1024.0 / dt; // KB/s
-                send_packets_rate = (stat.snd_packets - last.snd_packets) / dt;
-            }
+    if (backend_ == Backend::kNetlink) {
+        if (UpdateFromNetlink(monitor_info, now)) return;
+        std::cerr << "NetMonitor: RTM_GETSTATS failed: " << strerror(errno)
+                  << ", falling back to /proc/net/dev" << std::endl;
+        backend_ = Backend::kProcfs;
+        rtnl_.Close();
+    }
+    UpdateFromProcfs(monitor_info, now);
+}
+
+void NetMonitor::UpdateFromProcfs(monitor::proto::MonitorInfo* monitor_info,
+                                  std::chrono::steady_clock::time_point now) {
+    if (!net_dev_.Read()) return;
+
+    std::string_view line;
+    NetStat stat;
+    while (net_dev_.NextLine(&line)) {
+        if (ParseNetDevLine(line, &stat)) Emit(stat, now, monitor_info);
+    }
+    PruneLastNetInfo(now);
+}
+
+bool NetMonitor::UpdateFromNetlink(monitor::proto::MonitorInfo* monitor_info,
+                                   std::chrono::steady_clock::time_point now) {
+    struct if_stats_msg req = {};
+    req.family = AF_UNSPEC;
+    req.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+    if (!rtnl_.SendDump(RTM_GETSTATS, &req, sizeof(req))) return false;
+
+    // 先收齐整个 dump（缓冲区在 ReceiveDump 之间复用），再按需刷新网卡名
+    link_stats_.clear();
+    bool unknown_link = false;
+    bool ok = rtnl_.ReceiveDump([&](const struct nlmsghdr* nh) {
+        uint32_t ifindex;
+        struct rtnl_link_stats64 s;
+        if (!ParseStatsMessage(nh, &ifindex, &s)) return;
+        // /proc/net/dev 的 rx drop 列包含 rx_missed_errors，保持一致
+        link_stats_.push_back({ifindex, NetInfo{
+            s.rx_bytes, s.rx_packets, s.tx_bytes, s.tx_packets,
+            s.rx_errors, s.tx_errors, s.rx_dropped + s.rx_missed_errors,
+            s.tx_dropped, now}});
+        if (!link_names_.count(ifindex)) unknown_link = true;
+    });
+    if (!ok) return false;
+
+    if (unknown_link || now - link_names_time_ >= kLinkNamesRefreshInterval) {
+        RefreshLinkNames();
+        link_names_time_ = now;
+    }
+
+    for (const auto& [ifindex, info] : link_stats_) {
+        auto name = link_names_.find(ifindex);
+        // 刷新之后仍找不到：dump 与刷新之间被删除的网卡
+        if (name == link_names_.end() || name->second == "lo") continue;
+        NetStat stat{name->second,     info.rcv_bytes, info.rcv_packets,
+                     info.snd_bytes,   info.snd_packets, info.err_in,
+                     info.err_out,     info.drop_in,   info.drop_out};
+        Emit(stat, now, monitor_info);
+    }
+    PruneLastNetInfo(now);
+    return true;
+}
+
+void NetMonitor::PruneLastNetInfo(std::chrono::steady_clock::time_point now) {
+    // 本次输出过的接口时间戳都是 now，其余是已删除（或改名）的网卡
+    for (auto it = last_net_info_.begin(); it != last_net_info_.end();) {
+        it = it->second.timepoint == now ? std::next(it) : last_net_info_.erase(it);
+    }
+}
+
+bool NetMonitor::RefreshLinkNames() {
+    std::vector<LinkInfo> links;
+    if (!DumpLinks(&links)) return false;
+    link_names_.clear();
+    for (auto& link : links) {
+        link_names_.emplace(link.ifindex, std::move(link.name));
+    }
+    return true;
+}
+
+void NetMonitor::Emit(const NetStat& stat,
+                      std::chrono::steady_clock::time_point now,
+                      monitor::proto::MonitorInfo* monitor_info) {
+    auto it = last_net_info_.find(stat.name);
+    double rcv_rate = 0, rcv_packets_rate = 0, send_rate = 0, send_packets_rate = 0;
+
+    if (it != last_net_info_.end()) {
+        const NetInfo& last = it->second;
+        double dt = std::chrono::duration<double>(now - last.timepoint).count();
+        if (dt > 0) {
+            rcv_rate = (stat.rcv_bytes - last.rcv_bytes) / 1024.0 / dt; // KB/s
+            rcv_packets_rate = (stat.rcv_packets - last.rcv_packets) / dt;
+            send_rate = (stat.snd_bytes - last.snd_bytes) / 1024.0 / dt; // KB/s
+            send_packets_rate = (stat.snd_packets - last.snd_packets) / dt;
         }
+    }
+
+    // 填充 protobuf
+    auto net_info = monitor_info->add_net_info();
+    net_info->set_name(stat.name.data(), stat.name.size());
+    net_info->set_rcv_rate(rcv_rate);
+    net_info->set_rcv_packets_rate(rcv_packets_rate);
+    net_info->set_send_rate(send_rate);
+    net_info->set_send_packets_rate(send_packets_rate);
+    // 错误和丢弃统计
+    net_info->set_err_in(stat.err_in);
+    net_info->set_err_out(stat.err_out);
+    net_info->set_drop_in(stat.drop_in);
+    net_info->set_drop_out(stat.drop_out);
 
-        // 填充 protobuf
-        auto net_info = monitor_info->add_net_info();
-        net_info->set_name(stat.name);
-        net_info->set_rcv_rate(rcv_rate);
-        net_info->set_rcv_packets_rate(rcv_packets_rate);
-        net_info->set_send_rate(send_rate);
-        net_info->set_send_packets_rate(send_packets_rate);
-        // 错误和丢弃统计
-        net_info->set_err_in(stat.err_in);
-        net_info->set_err_out(stat.err_out);
-        net_info->set_drop_in(stat.drop_in);
-        net_info->set_drop_out(stat.drop_out);
-
-        // 更新缓存
-        last_net_info_[stat.name] = NetInfo{
-            stat.name, stat.rcv_bytes, stat.rcv_packets, stat.snd_bytes, stat.snd_packets,
-            stat.err_in, stat.err_out, stat.drop_in, stat.drop_out, now
-        };
+    // 更新缓存，只有新出现的接口才分配键
+    NetInfo info{
+        stat.rcv_bytes, stat.rcv_packets, stat.snd_bytes, stat.snd_packets,
+        stat.err_in, stat.err_out, stat.drop_in, stat.drop_out, now
+    };
+    if (it != last_net_info_.end()) {
+        it->second = info;
+    } else {
+        last_net_info_.emplace(std::string(stat.name), info);
     }
 }
 
@@ -0,0 +1,252 @@
+#include "monitor/tc_hook_manager.h"
+
+#include <bpf/libbpf.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace monitor {
+
+namespace {
+// 本程序过滤器的固定 handle
+constexpr uint32_t kTcHandle = 1;
+}  // namespace
+
+TcHookManager::TcHookManager(int ingress_prog_fd, int egress_prog_fd,
+                             uint32_t priority, LinkFilter filter)
+    : ingress_fd_(ingress_prog_fd),
+      egress_fd_(egress_prog_fd),
+      priority_(priority),
+      filter_(std::move(filter)) {}
+
+TcHookManager::~TcHookManager() {
+  Stop();
+}
+
+bool TcHookManager::Start(LinkCallback callback) {
+  callback_ = std::move(callback);
+
+  // 先订阅再 dump：两者之间新建的网卡会出现在通知里，重复的挂载会被忽略
+  bool listening = listener_.Open(RTMGRP_LINK);
+  if (!listening) {
+    std::cerr << "TcHookManager: failed to subscribe link events: "
+              << strerror(errno) << std::endl;
+  }
+
+  Sync();
+
+  if (listening) {
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+      listener_.Close();
+      return false;
+    }
+    thread_ = std::thread(&TcHookManager::Loop, this);
+  }
+  return listening;
+}
+
+void TcHookManager::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    if (write(stop_fd_, &one, sizeof(one)) < 0) {
+      // eventfd 计数溢出之外不会失败
+    }
+    thread_.join();
+  }
+  if (stop_fd_ >= 0) {
+    close(stop_fd_);
+    stop_fd_ = -1;
+  }
+  listener_.Close();
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (const auto& entry : attached_) {
+    Detach(entry.first, entry.second);
+  }
+  attached_.clear();
+}
+
+size_t TcHookManager::AttachedCount() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return attached_.size();
+}
+
+bool TcHookManager::Accepts(const LinkInfo& link) const {
+  return link.name != "lo" && (!filter_ || filter_(link));
+}
+
+void TcHookManager::Sync() {
+  std::vector<LinkInfo> links;
+  if (!DumpLinks(&links)) {
+    std::cerr << "TcHookManager: failed to dump links: " << strerror(errno)
+              << std::endl;
+    return;
+  }
+
+  std::unordered_set<uint32_t> present;
+  for (const auto& link : links) {
+    present.insert(link.ifindex);
+    if (Accepts(link) && Attach(link.ifindex, link.name) && callback_) {
+      callback_(link.ifindex, true);
+    }
+  }
+
+  // 丢失通知期间被删除的网卡
+  std::vector<uint32_t> removed;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto it = attached_.begin(); it != attached_.end();) {
+      if (present.count(it->first)) {
+        ++it;
+      } else {
+        removed.push_back(it->first);
+        it = attached_.erase(it);
+      }
+    }
+  }
+  if (callback_) {
+    for (uint32_t ifindex : removed) {
+      callback_(ifindex, false);
+    }
+  }
+}
+
+bool TcHookManager::Attach(uint32_t ifindex, const std::string& name) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (attached_.count(ifindex)) {
+    return false;
+  }
+
+  LIBBPF_OPTS(bpf_tc_hook, hook,
+      .ifindex = static_cast<int>(ifindex),
+      .attach_point = BPF_TC_INGRESS,
+  );
+  // 创建 clsact qdisc；已存在（其他程序创建或上次运行留下）时沿用
+  int err = bpf_tc_hook_create(&hook);
+  if (err && err != -EEXIST) {
+    std::cerr << "TcHookManager: failed to create clsact on " << name << ": "
+              << strerror(-err) << std::endl;
+    return false;
+  }
+
+  Attachment attachment;
+  const struct {
+    enum bpf_tc_attach_point point;
+    int prog_fd;
+    Filter* filter;
+  } targets[] = {
+      {BPF_TC_INGRESS, ingress_fd_, &attachment.ingress},
+      {BPF_TC_EGRESS, egress_fd_, &attachment.egress},
+  };
+  for (const auto& target : targets) {
+    hook.attach_point = target.point;
+    LIBBPF_OPTS(bpf_tc_opts, opts,
+        .prog_fd = target.prog_fd,
+        .flags = BPF_TC_F_REPLACE,
+        .handle = kTcHandle,
+        .priority = priority_,
+    );
+    err = bpf_tc_attach(&hook, &opts);
+    if (err) {
+      std::cerr << "TcHookManager: failed to attach "
+                << (target.point == BPF_TC_INGRESS ? "ingress" : "egress")
+                << " on " << name << ": " << strerror(-err) << std::endl;
+      continue;
+    }
+    target.filter->attached = true;
+    target.filter->handle = opts.handle;
+    target.filter->priority = opts.priority;
+  }
+
+  if (!attachment.ingress.attached && !attachment.egress.attached) {
+    return false;
+  }
+  attached_.emplace(ifindex, attachment);
+  return true;
+}
+
+void TcHookManager::Detach(uint32_t ifindex, const Attachment& attachment) {
+  LIBBPF_OPTS(bpf_tc_hook, hook, .ifindex = static_cast<int>(ifindex));
+  const std::pair<enum bpf_tc_attach_point, const Filter*> filters[] = {
+      {BPF_TC_INGRESS, &attachment.ingress},
+      {BPF_TC_EGRESS, &attachment.egress},
+  };
+  for (const auto& [point, filter] : filters) {
+    if (!filter->attached) continue;
+    hook.attach_point = point;
+    // bpf_tc_detach 要求 handle / priority 与挂载时一致，其余字段为 0
+    LIBBPF_OPTS(bpf_tc_opts, opts,
+        .handle = filter->handle,
+        .priority = filter->priority,
+    );
+    bpf_tc_detach(&hook, &opts);
+  }
+}
+
+void TcHookManager::Loop() {
+  struct pollfd fds[2] = {
+      {listener_.fd(), POLLIN, 0},
+      {stop_fd_, POLLIN, 0},
+  };
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "TcHookManager: poll failed: " << strerror(errno)
+                << std::endl;
+      return;
+    }
+    if (fds[1].revents) {
+      return;
+    }
+    if (!fds[0].revents) {
+      continue;
+    }
+
+    bool ok = listener_.ReceiveOnce(
+        [this](const struct nlmsghdr* nh) { HandleMessage(nh); });
+    if (!ok && errno == ENOBUFS) {
+      // 网卡批量增删时接收队列溢出，丢了通知：重新全量同步
+      Sync();
+    }
+  }
+}
+
+void TcHookManager::HandleMessage(const struct nlmsghdr* nh) {
+  LinkInfo link;
+  if (!ParseLinkMessage(nh, &link)) {
+    return;
+  }
+
+  if (nh->nlmsg_type == RTM_NEWLINK) {
+    if (!Accepts(link)) {
+      return;
+    }
+    // 状态变化（up / down、改名等）也会发 RTM_NEWLINK，已挂载的忽略
+    if (Attach(link.ifindex, link.name) && callback_) {
+      callback_(link.ifindex, true);
+    }
+    return;
+  }
+
+  // RTM_DELLINK：过滤器随设备一起销毁，只需移除记录
+  size_t erased;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    erased = attached_.erase(link.ifindex);
+  }
+  if (erased && callback_) {
+    callback_(link.ifindex, false);
+  }
+}
+
+}  // namespace monitor
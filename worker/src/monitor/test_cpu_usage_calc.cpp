@@ -0,0 +1,176 @@
+/**
+ * CPU 使用率批量计算测试程序
+ *
+ * 用随机计数（含计数回退、超大差值、全 0 的行，行数不是 4 的倍数）
+ * 校验 AVX2 与标量实现逐位一致，并检查已知输入的结果；
+ * 最后输出 257 行（256 线程 + 汇总）时两种实现的单次耗时。
+ *
+ * 编译: g++ -O2 -std=c++17 -I../../include -o test_cpu_usage_calc \
+ *           test_cpu_usage_calc.cpp cpu_usage_calc.cpp
+ * 运行: ./test_cpu_usage_calc
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "monitor/cpu_usage_calc.h"
+
+namespace {
+
+using monitor::kCpuPercentColumns;
+using monitor::kCpuTimeColumns;
+
+struct Columns {
+  explicit Columns(size_t rows) {
+    for (auto& c : curr) c.resize(rows);
+    for (auto& c : prev) c.resize(rows);
+    for (auto& p : percent) p.resize(rows);
+    for (auto& p : expected) p.resize(rows);
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+      curr_ptr[c] = curr[c].data();
+      prev_ptr[c] = prev[c].data();
+    }
+    for (int p = 0; p < kCpuPercentColumns; ++p) {
+      percent_ptr[p] = percent[p].data();
+      expected_ptr[p] = expected[p].data();
+    }
+  }
+
+  std::vector<uint64_t> curr[kCpuTimeColumns];
+  std::vector<uint64_t> prev[kCpuTimeColumns];
+  std::vector<float> percent[kCpuPercentColumns];
+  std::vector<float> expected[kCpuPercentColumns];
+  const uint64_t* curr_ptr[kCpuTimeColumns];
+  const uint64_t* prev_ptr[kCpuTimeColumns];
+  float* percent_ptr[kCpuPercentColumns];
+  float* expected_ptr[kCpuPercentColumns];
+};
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+void Fill(Columns* cols, std::mt19937_64* rng) {
+  size_t rows = cols->curr[0].size();
+  for (size_t row = 0; row < rows; ++row) {
+    int kind = static_cast<int>((*rng)() % 8);
+    for (int c = 0; c < kCpuTimeColumns; ++c) {
+      uint64_t before = (*rng)() >> 4;
+      uint64_t delta = (*rng)() % 2000000000ull;
+      if (kind == 0) delta = 0;                              // 全 0
+      if (kind == 1 && c == monitor::kCpuTimeIowait) {       // iowait 回退
+        delta = static_cast<uint64_t>(-1000);
+      }
+      if (kind == 2 && c == monitor::kCpuTimeUser) {         // 超出 2^52
+        delta = 1ull << 60;
+      }
+      cols->prev[c][row] = before;
+      cols->curr[c][row] = before + delta;
+    }
+  }
+}
+
+void TestKnownValues() {
+  Columns cols(1);
+  // user 30, nice 0, system 10, idle 50, iowait 10, 其余 0
+  const uint64_t delta[kCpuTimeColumns] = {30, 0, 10, 50, 10, 0, 0, 0};
+  for (int c = 0; c < kCpuTimeColumns; ++c) {
+    cols.prev[c][0] = 1000;
+    cols.curr[c][0] = 1000 + delta[c];
+  }
+  monitor::ComputeCpuPercent(cols.curr_ptr, cols.prev_ptr, 1, cols.percent_ptr);
+  Check(cols.percent[monitor::kCpuPercentBusy][0] == 40.0f, "busy 40%");
+  Check(cols.percent[monitor::kCpuPercentUser][0] == 30.0f, "user 30%");
+  Check(cols.percent[monitor::kCpuPercentIdle][0] == 50.0f, "idle 50%");
+  Check(cols.percent[monitor::kCpuPercentIowait][0] == 10.0f, "iowait 10%");
+
+  // 计数不变时全部为 0，不能出现 NaN
+  for (int c = 0; c < kCpuTimeColumns; ++c) cols.curr[c][0] = 1000;
+  monitor::ComputeCpuPercent(cols.curr_ptr, cols.prev_ptr, 1, cols.percent_ptr);
+  for (int p = 0; p < kCpuPercentColumns; ++p) {
+    Check(cols.percent[p][0] == 0.0f, "zero delta gives 0%");
+  }
+}
+
+void TestMatchesScalar() {
+#ifdef MONITOR_HAVE_AVX2_KERNEL
+  if (strcmp(monitor::CpuPercentImplName(), "avx2") != 0) {
+    printf("AVX2 not supported, skipping comparison\n");
+    return;
+  }
+  std::mt19937_64 rng(42);
+  for (size_t rows : {1, 3, 4, 5, 63, 257}) {
+    Columns cols(rows);
+    for (int round = 0; round < 50; ++round) {
+      Fill(&cols, &rng);
+      monitor::ComputeCpuPercentScalar(cols.curr_ptr, cols.prev_ptr, rows,
+                                       cols.expected_ptr);
+      monitor::ComputeCpuPercentAvx2(cols.curr_ptr, cols.prev_ptr, rows,
+                                     cols.percent_ptr);
+      for (int p = 0; p < kCpuPercentColumns; ++p) {
+        Check(memcmp(cols.percent[p].data(), cols.expected[p].data(),
+                     rows * sizeof(float)) == 0,
+              "avx2 matches scalar");
+        for (float v : cols.percent[p]) {
+          Check(std::isfinite(v) && v >= 0.0f && v <= 100.0f,
+                "percent in [0, 100]");
+        }
+      }
+    }
+  }
+#else
+  printf("no AVX2 kernel on this architecture, skipping comparison\n");
+#endif
+}
+
+template <typename Fn>
+double NsPerCall(Fn fn) {
+  constexpr int kRounds = 20000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRounds; ++i) fn();
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         kRounds;
+}
+
+void Bench() {
+  constexpr size_t kRows = 257;
+  Columns cols(kRows);
+  std::mt19937_64 rng(7);
+  Fill(&cols, &rng);
+  double scalar = NsPerCall([&] {
+    monitor::ComputeCpuPercentScalar(cols.curr_ptr, cols.prev_ptr, kRows,
+                                     cols.percent_ptr);
+  });
+  printf("%zu rows: scalar %.0f ns", kRows, scalar);
+  double selected = NsPerCall([&] {
+    monitor::ComputeCpuPercent(cols.curr_ptr, cols.prev_ptr, kRows,
+                               cols.percent_ptr);
+  });
+  printf(", %s %.0f ns\n", monitor::CpuPercentImplName(), selected);
+}
+
+}  // namespace
+
+int main() {
+  TestKnownValues();
+  TestMatchesScalar();
+  Bench();
+  if (failures) {
+    printf("%d checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
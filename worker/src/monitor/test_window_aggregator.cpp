@@ -0,0 +1,129 @@
+/**
+ * WindowAggregator 测试程序
+ *
+ * 检查 min / max / mean / p95 / last / samples 的计算、窗口在 Fill 后重置、
+ * 环形缓冲在超过 kWindowCapacity 时只保留最近的样本、
+ * 窗口内没有样本的行不填写统计、stale 行（沿用上一次结果）不计入，
+ * 以及不同行的序列互不干扰。
+ *
+ * 编译（在 build 目录生成 proto 代码之后）:
+ *   g++ -std=c++17 -I../../include -I<proto 生成目录> -o test_window_aggregator \
+ *       test_window_aggregator.cpp window_aggregator.cpp <proto 生成的 .pb.cc> \
+ *       -lprotobuf -lpthread
+ * 运行: ./test_window_aggregator
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "monitor/window_aggregator.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+  printf("%s: %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) ++failures;
+}
+
+bool Near(double a, double b) { return std::fabs(a - b) < 1e-3; }
+
+monitor::proto::MonitorInfo CpuSample(const char* name, float percent) {
+  monitor::proto::MonitorInfo info;
+  auto* cpu = info.add_cpu_stat();
+  cpu->set_cpu_name(name);
+  cpu->set_cpu_percent(percent);
+  return info;
+}
+
+}  // namespace
+
+int main() {
+  monitor::WindowAggregator aggregator;
+
+  // 1..100 打乱顺序记入 cpu，cpu0 只有一个样本
+  for (int i = 0; i < 100; ++i) {
+    aggregator.Observe(CpuSample("cpu", static_cast<float>((i * 37) % 100 + 1)));
+  }
+  aggregator.Observe(CpuSample("cpu0", 42));
+  {
+    monitor::proto::MonitorInfo sample;
+    auto* net = sample.add_net_info();
+    net->set_name("eth0");
+    net->set_rcv_rate(10);
+    net->set_send_rate(5);
+    aggregator.Observe(sample);
+    net->set_rcv_rate(30);
+    aggregator.Observe(sample);
+  }
+
+  monitor::proto::MonitorInfo info;
+  info.add_cpu_stat()->set_cpu_name("cpu");
+  info.add_cpu_stat()->set_cpu_name("cpu0");
+  info.add_cpu_stat()->set_cpu_name("cpu1");
+  info.add_net_info()->set_name("eth0");
+  aggregator.Fill(&info);
+
+  const auto& all = info.cpu_stat(0).cpu_percent_agg();
+  Check(all.samples() == 100, "samples counted");
+  Check(Near(all.min(), 1) && Near(all.max(), 100), "min / max");
+  Check(Near(all.mean(), 50.5), "mean");
+  Check(Near(all.p95(), 95), "p95 by nearest rank");
+  Check(Near(all.last(), (99 * 37) % 100 + 1), "last is the newest sample");
+
+  const auto& cpu0 = info.cpu_stat(1).cpu_percent_agg();
+  Check(cpu0.samples() == 1 && Near(cpu0.p95(), 42) && Near(cpu0.min(), 42),
+        "single sample window");
+  Check(!info.cpu_stat(2).has_cpu_percent_agg(), "row without samples untouched");
+
+  const auto& eth0 = info.net_info(0);
+  Check(Near(eth0.rcv_rate_agg().mean(), 20) && Near(eth0.rcv_rate_agg().max(), 30),
+        "net rcv_rate aggregated");
+  Check(Near(eth0.send_rate_agg().mean(), 5), "fields of one row kept apart");
+
+  // 新窗口：只有本窗口的样本；超过容量时保留最近的 kWindowCapacity 个
+  const size_t capacity = monitor::WindowAggregator::kWindowCapacity;
+  for (size_t i = 0; i < capacity + 100; ++i) {
+    aggregator.Observe(CpuSample("cpu", i < 100 ? 1000.0f : 1.0f));
+  }
+  info.Clear();
+  info.add_cpu_stat()->set_cpu_name("cpu");
+  aggregator.Fill(&info);
+  const auto& wrapped = info.cpu_stat(0).cpu_percent_agg();
+  Check(wrapped.samples() == capacity, "window capped at kWindowCapacity");
+  Check(Near(wrapped.max(), 1), "oldest samples overwritten");
+
+  // 窗口内没有新样本：不填写统计
+  info.Clear();
+  info.add_cpu_stat()->set_cpu_name("cpu");
+  aggregator.Fill(&info);
+  Check(!info.cpu_stat(0).has_cpu_percent_agg(), "empty window leaves agg unset");
+
+  // 来源刷新慢于采样：重复输出的 stale 行不算新样本
+  aggregator.Observe(CpuSample("cpu", 10));
+  for (int i = 0; i < 9; ++i) {
+    monitor::proto::MonitorInfo repeat = CpuSample("cpu", 10);
+    repeat.mutable_cpu_stat(0)->set_stale(true);
+    auto* softirq = repeat.add_soft_irq();
+    softirq->set_cpu("cpu0");
+    softirq->set_net_rx(100);
+    softirq->set_stale(true);
+    aggregator.Observe(repeat);
+  }
+  aggregator.Observe(CpuSample("cpu", 30));
+  info.Clear();
+  info.add_cpu_stat()->set_cpu_name("cpu");
+  info.add_soft_irq()->set_cpu("cpu0");
+  aggregator.Fill(&info);
+  const auto& fresh = info.cpu_stat(0).cpu_percent_agg();
+  Check(fresh.samples() == 2 && Near(fresh.mean(), 20), "stale rows skipped");
+  Check(!info.soft_irq(0).has_net_rx_agg(), "stale softirq rows skipped");
+
+  if (failures) {
+    printf("%d checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
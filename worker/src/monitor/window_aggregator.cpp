@@ -0,0 +1,188 @@
+#include "monitor/window_aggregator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace monitor {
+
+namespace {
+
+// 参与窗口统计的指标
+enum Metric {
+  kCpuPercent,
+  kSoftIrqNetTx,
+  kSoftIrqNetRx,
+  kNetSendRate,
+  kNetRcvRate,
+  kNetSendPacketsRate,
+  kNetRcvPacketsRate,
+  kDiskReadBytesPerSec,
+  kDiskWriteBytesPerSec,
+  kDiskUtilPercent,
+  kMetricCount
+};
+
+// 一个 repeated 消息中参与统计的字段：取值与对应的 *_agg 字段
+template <typename Msg>
+struct AggregatedField {
+  Metric metric;
+  float (*value)(const Msg&);
+  monitor::proto::MetricAggregate* (*mutable_aggregate)(Msg*);
+};
+
+using monitor::proto::CpuStat;
+using monitor::proto::DiskInfo;
+using monitor::proto::MetricAggregate;
+using monitor::proto::NetInfo;
+using monitor::proto::SoftIrq;
+
+const AggregatedField<CpuStat> kCpuStatFields[] = {
+    {kCpuPercent, [](const CpuStat& m) { return m.cpu_percent(); },
+     [](CpuStat* m) { return m->mutable_cpu_percent_agg(); }},
+};
+
+const AggregatedField<SoftIrq> kSoftIrqFields[] = {
+    {kSoftIrqNetTx, [](const SoftIrq& m) { return m.net_tx(); },
+     [](SoftIrq* m) { return m->mutable_net_tx_agg(); }},
+    {kSoftIrqNetRx, [](const SoftIrq& m) { return m.net_rx(); },
+     [](SoftIrq* m) { return m->mutable_net_rx_agg(); }},
+};
+
+const AggregatedField<NetInfo> kNetInfoFields[] = {
+    {kNetSendRate, [](const NetInfo& m) { return m.send_rate(); },
+     [](NetInfo* m) { return m->mutable_send_rate_agg(); }},
+    {kNetRcvRate, [](const NetInfo& m) { return m.rcv_rate(); },
+     [](NetInfo* m) { return m->mutable_rcv_rate_agg(); }},
+    {kNetSendPacketsRate, [](const NetInfo& m) { return m.send_packets_rate(); },
+     [](NetInfo* m) { return m->mutable_send_packets_rate_agg(); }},
+    {kNetRcvPacketsRate, [](const NetInfo& m) { return m.rcv_packets_rate(); },
+     [](NetInfo* m) { return m->mutable_rcv_packets_rate_agg(); }},
+};
+
+const AggregatedField<DiskInfo> kDiskInfoFields[] = {
+    {kDiskReadBytesPerSec,
+     [](const DiskInfo& m) { return static_cast<float>(m.read_bytes_per_sec()); },
+     [](DiskInfo* m) { return m->mutable_read_bytes_per_sec_agg(); }},
+    {kDiskWriteBytesPerSec,
+     [](const DiskInfo& m) { return static_cast<float>(m.write_bytes_per_sec()); },
+     [](DiskInfo* m) { return m->mutable_write_bytes_per_sec_agg(); }},
+    {kDiskUtilPercent,
+     [](const DiskInfo& m) { return static_cast<float>(m.util_percent()); },
+     [](DiskInfo* m) { return m->mutable_util_percent_agg(); }},
+};
+
+// 沿用上一次结果的行（来源尚未刷新）不是新的样本
+bool IsStale(const CpuStat& m) { return m.stale(); }
+bool IsStale(const SoftIrq& m) { return m.stale(); }
+bool IsStale(const NetInfo&) { return false; }
+bool IsStale(const DiskInfo&) { return false; }
+
+// 各行的序列名
+const std::string& RowName(const CpuStat& m) { return m.cpu_name(); }
+const std::string& RowName(const SoftIrq& m) { return m.cpu(); }
+const std::string& RowName(const NetInfo& m) { return m.name(); }
+const std::string& RowName(const DiskInfo& m) { return m.name(); }
+
+}  // namespace
+
+WindowAggregator::WindowAggregator() : series_(kMetricCount) {}
+
+void WindowAggregator::Observe(const monitor::proto::MonitorInfo& sample) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto observe = [this](const auto& rows, const auto& fields) {
+    for (const auto& row : rows) {
+      if (IsStale(row)) continue;
+      for (const auto& field : fields) {
+        Add(field.metric, RowName(row), field.value(row));
+      }
+    }
+  };
+  observe(sample.cpu_stat(), kCpuStatFields);
+  observe(sample.soft_irq(), kSoftIrqFields);
+  observe(sample.net_info(), kNetInfoFields);
+  observe(sample.disk_info(), kDiskInfoFields);
+}
+
+void WindowAggregator::Fill(monitor::proto::MonitorInfo* monitor_info) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  // 上一个窗口之后再没有出现的序列
+  for (auto& map : series_) {
+    for (auto it = map.begin(); it != map.end();) {
+      it = it->second.samples.empty() ? map.erase(it) : std::next(it);
+    }
+  }
+
+  auto fill = [this](auto* rows, const auto& fields) {
+    for (auto& row : *rows) {
+      for (const auto& field : fields) {
+        MetricAggregate aggregate;
+        if (Take(field.metric, RowName(row), &aggregate)) {
+          field.mutable_aggregate(&row)->Swap(&aggregate);
+        }
+      }
+    }
+  };
+  fill(monitor_info->mutable_cpu_stat(), kCpuStatFields);
+  fill(monitor_info->mutable_soft_irq(), kSoftIrqFields);
+  fill(monitor_info->mutable_net_info(), kNetInfoFields);
+  fill(monitor_info->mutable_disk_info(), kDiskInfoFields);
+
+  // 开始新的窗口，保留容量
+  for (auto& map : series_) {
+    for (auto& entry : map) {
+      entry.second.samples.clear();
+      entry.second.next = 0;
+    }
+  }
+}
+
+void WindowAggregator::Add(int metric, const std::string& name, float value) {
+  SeriesMap& map = series_[metric];
+  auto it = map.find(name);
+  if (it == map.end()) {
+    it = map.emplace(name, Series()).first;
+  }
+  Series& series = it->second;
+  if (series.samples.size() < kWindowCapacity) {
+    series.samples.push_back(value);
+  } else {
+    series.samples[series.next] = value;
+    series.next = (series.next + 1) % kWindowCapacity;
+  }
+  series.last = value;
+}
+
+bool WindowAggregator::Take(int metric, const std::string& name,
+                            monitor::proto::MetricAggregate* aggregate) {
+  const SeriesMap& map = series_[metric];
+  auto it = map.find(name);
+  if (it == map.end() || it->second.samples.empty()) {
+    return false;
+  }
+  const std::vector<float>& samples = it->second.samples;
+
+  float min = samples[0];
+  float max = samples[0];
+  double sum = 0;
+  for (float v : samples) {
+    min = std::min(min, v);
+    max = std::max(max, v);
+    sum += v;
+  }
+
+  // 最近秩法：第 ceil(0.95 * n) 小的样本
+  scratch_.assign(samples.begin(), samples.end());
+  size_t rank = static_cast<size_t>(std::ceil(0.95 * scratch_.size()));
+  auto p95 = scratch_.begin() + (rank > 0 ? rank - 1 : 0);
+  std::nth_element(scratch_.begin(), p95, scratch_.end());
+
+  aggregate->set_min(min);
+  aggregate->set_max(max);
+  aggregate->set_mean(static_cast<float>(sum / samples.size()));
+  aggregate->set_p95(*p95);
+  aggregate->set_last(it->second.last);
+  aggregate->set_samples(static_cast<uint32_t>(samples.size()));
+  return true;
+}
+
+}  // namespace monitor
@@ -1,22 +1,134 @@
 #include "rpc/monitor_pusher.h"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <string>
 
 namespace monitor {
 
+namespace {
+// 与管理者约定的 trailing metadata 键
+constexpr char kRetryAfterMetadataKey[] = "retry-after-ms";
+// 管理者没有给出提示时的退避上限
+constexpr auto kMaxBackoff = std::chrono::seconds(60);
+// 发送失败后的首次重试等待，之后按 2 的幂增长到 kMaxBackoff
+constexpr auto kRetryBase = std::chrono::seconds(1);
+// 建流、单次写出、一元调用的截止时间；管理者卡死时到点取消，不会无限等待
+constexpr auto kSendDeadline = std::chrono::seconds(10);
+// 退出时等待推送流正常结束的时间，超过则直接取消
+constexpr auto kStopGrace = std::chrono::seconds(3);
+// 发送线程在完成队列上的最长等待，用于检查退避、重试与 deadline
+constexpr auto kPollInterval = std::chrono::milliseconds(200);
+// 采集线程与发送线程之间最多缓存的样本数，按默认 10 秒间隔约 10 分钟
+constexpr size_t kRingCapacity = 64;
+// 长连接上的 keepalive：连接静默时探测对端是否还在
+constexpr int kKeepaliveTimeMs = 30000;
+constexpr int kKeepaliveTimeoutMs = 10000;
+// 补传批次：每批最多 kBackfillBatchRecords 条 / kBackfillBatchBytes 字节（压缩前），
+// 每次推送成功后最多连续补传 kMaxBackfillBatches 批，补传与实时推送交替进行
+constexpr size_t kBackfillBatchRecords = 256;
+constexpr size_t kBackfillBatchBytes = 1 << 20;
+constexpr int kMaxBackfillBatches = 8;
+constexpr auto kBackfillDeadline = std::chrono::seconds(10);
+
+// 完成队列上的操作标签：同一时刻至多一条推送流、一次一元调用和一次补传，
+// 一条流的所有操作取回之前不会建立下一条，标签只需区分操作种类
+enum class PushOp : intptr_t {
+  kWake = 1,
+  kStart,
+  kWrite,
+  kRead,
+  kWritesDone,
+  kFinish,
+  kUnary,
+  kBackfill,
+};
+
+void* ToTag(PushOp op) {
+  return reinterpret_cast<void*>(static_cast<intptr_t>(op));
+}
+
+PushOp FromTag(void* tag) {
+  return static_cast<PushOp>(reinterpret_cast<intptr_t>(tag));
+}
+
+int64_t UnixMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
+struct MonitorPusher::StreamCall {
+  grpc::ClientContext ctx;
+  std::unique_ptr<grpc::ClientAsyncReaderWriter<monitor::proto::MonitorInfo,
+                                                monitor::proto::PushAck>>
+      rw;
+  monitor::proto::PushAck ack;
+  grpc::Status status;
+
+  int pending = 0;         // 已发起、尚未从完成队列取回的操作数
+  bool started = false;    // StartCall 已完成
+  bool writing = false;
+  bool reading = false;
+  bool closing = false;    // 已半关闭写端或已取消，不再写出
+  bool cancelled = false;
+  bool finishing = false;
+  bool finished = false;
+  bool acked = false;      // 收到过回执，说明连接曾经可用
+  std::chrono::steady_clock::time_point deadline;  // 建流 / 当前写出的截止时刻
+
+  // 已写出、尚未被回执确认的样本（序列化后），流结束时转入 spool
+  std::deque<std::string> unacked;
+  uint64_t unacked_base = 0;  // unacked 第一个元素在本条流上的序号
+};
+
+struct MonitorPusher::UnaryCall {
+  grpc::ClientContext ctx;
+  google::protobuf::Empty response;
+  grpc::Status status;
+  monitor::proto::MonitorInfo info;  // 失败时落盘或放回环中重试
+  std::unique_ptr<grpc::ClientAsyncResponseReader<google::protobuf::Empty>> reader;
+};
+
+struct MonitorPusher::BackfillCall {
+  grpc::ClientContext ctx;
+  monitor::proto::MonitorInfoBatch batch;
+  monitor::proto::BackfillAck ack;
+  grpc::Status status;
+  std::vector<PushSpool::Record> records;  // 与 batch.items 一一对应，确认后提交游标
+  std::unique_ptr<grpc::ClientAsyncResponseReader<monitor::proto::BackfillAck>> reader;
+};
+
 MonitorPusher::MonitorPusher(const std::string& manager_address,
-                             int interval_seconds)
+                             int interval_seconds,
+                             const PushSpoolOptions& spool_options)
     : manager_address_(manager_address),
       interval_seconds_(interval_seconds),
-      running_(false) {
+      running_(false),
+      ring_(kRingCapacity) {
   // 创建 gRPC channel 和 stub
-  auto channel = grpc::CreateChannel(manager_address,
-                                     grpc::InsecureChannelCredentials());
+  grpc::ChannelArguments args;
+  args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, kKeepaliveTimeMs);
+  args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS, kKeepaliveTimeoutMs);
+  auto channel = grpc::CreateCustomChannel(
+      manager_address, grpc::InsecureChannelCredentials(), args);
   stub_ = monitor::proto::GrpcManager::NewStub(channel);
 
   // 创建指标采集器
   collector_ = std::make_unique<MetricCollector>();
+
+  // 打开本地 spool；失败时只是不再落盘，推送照常进行
+  spool_ = std::make_unique<PushSpool>(spool_options);
+  if (!spool_->Open()) {
+    std::cerr << "Push spool disabled, samples will be dropped while the "
+              << "manager is unreachable" << std::endl;
+    spool_.reset();
+  }
 }
 
 MonitorPusher::~MonitorPusher() {
@@ -28,36 +140,60 @@ void MonitorPusher::Start() {
     return;
   }
   running_ = true;
-  thread_ = std::make_unique<std::thread>(&MonitorPusher::PushLoop, this);
+  collecting_ = true;
+  send_thread_ = std::make_unique<std::thread>(&MonitorPusher::SendLoop, this);
+  collect_thread_ = std::make_unique<std::thread>(&MonitorPusher::CollectLoop, this);
   std::cout << "MonitorPusher started, pushing to " << manager_address_
             << " every " << interval_seconds_ << " seconds" << std::endl;
 }
 
 void MonitorPusher::Stop() {
   running_ = false;
-  if (thread_ && thread_->joinable()) {
-    thread_->join();
+  if (collect_thread_ && collect_thread_->joinable()) {
+    collect_thread_->join();
+  }
+  if (send_thread_ && send_thread_->joinable()) {
+    WakeSender();
+    send_thread_->join();
   }
 }
 
-void MonitorPusher::PushLoop() {
+void MonitorPusher::CollectLoop() {
+  const auto interval = std::chrono::seconds(interval_seconds_);
+  auto next = std::chrono::steady_clock::now();
   while (running_) {
-    if (!PushOnce()) {
-      std::cerr << "Failed to push monitor data to " << manager_address_
-                << std::endl;
+    monitor::proto::MonitorInfo info;
+    CollectOnce(&info);
+    if (!ring_.Push(std::move(info))) {
+      std::cerr << "Send queue full, dropped the oldest sample ("
+                << ring_.Dropped() << " dropped so far)" << std::endl;
     }
+    WakeSender();
 
-    // 等待指定间隔
-    for (int i = 0; i < interval_seconds_ && running_; ++i) {
-      std::this_thread::sleep_for(std::chrono::seconds(1));
+    // 固定时刻表：第 n 次采样在 start + n * interval，与采集、发送耗时无关；
+    // 进程被挂起等原因错过的时刻直接跳过，不补采
+    next += interval;
+    auto now = std::chrono::steady_clock::now();
+    if (next <= now) {
+      auto missed = (now - next) / interval + 1;
+      next += interval * missed;
+      std::cerr << "Collector fell behind, skipped " << missed << " samples"
+                << std::endl;
+    }
+    while (running_) {
+      now = std::chrono::steady_clock::now();
+      if (now >= next) break;
+      std::this_thread::sleep_until(std::min(next, now + kPollInterval));
     }
   }
+  collecting_ = false;
 }
 
-bool MonitorPusher::PushOnce() {
+void MonitorPusher::CollectOnce(monitor::proto::MonitorInfo* info_ptr) {
   // 采集监控数据
-  monitor::proto::MonitorInfo info;
+  monitor::proto::MonitorInfo& info = *info_ptr;
   collector_->CollectAll(&info);
+  info.set_collect_time_ms(UnixMillis());
 
   // 打印采集到的所有指标
   std::cout << "\n================== Collected Metrics ==================" << std::endl;
@@ -174,19 +310,467 @@ bool MonitorPusher::PushOnce() {
   
   std::cout << "========================================================\n" << std::endl;
 
-  // 推送数据
-  grpc::ClientContext context;
-  google::protobuf::Empty response;
+}
+
+void MonitorPusher::WakeSender() {
+  // 闹钟未被取走之前不能再次设置；发送线程退出前把 wake_pending_ 永久置位，
+  // 之后的唤醒都不会再触碰已关闭的完成队列
+  std::lock_guard<std::mutex> lock(wake_mtx_);
+  if (wake_pending_) {
+    return;
+  }
+  wake_pending_ = true;
+  wake_alarm_.Set(&cq_, std::chrono::system_clock::now(), ToTag(PushOp::kWake));
+}
 
-  grpc::Status status = stub_->SetMonitorInfo(&context, info, &response);
+void MonitorPusher::SendLoop() {
+  bool stopping = false;
+  std::chrono::steady_clock::time_point stop_deadline;
+
+  while (true) {
+    auto now = std::chrono::steady_clock::now();
+    if (!stopping && !running_ && !collecting_) {
+      // 采集已结束：环中剩余样本落盘，推送流半关闭，等待管理者确认最后的上报
+      stopping = true;
+      stop_deadline = now + kStopGrace;
+      SpoolRing();
+    }
+    if (stopping) {
+      if (!stream_ && !unary_ && !backfill_) {
+        break;
+      }
+      CloseStreamGracefully();
+      if (now >= stop_deadline) {
+        if (stream_) {
+          BreakStream(nullptr);
+        }
+        if (backfill_) {
+          // 未确认的批次仍在 spool 中，下次启动后重新补传
+          backfill_->ctx.TryCancel();
+        }
+      }
+    } else {
+      Pump();
+    }
+
+    void* tag = nullptr;
+    bool ok = false;
+    auto status = cq_.AsyncNext(&tag, &ok, std::chrono::system_clock::now() + kPollInterval);
+    if (status == grpc::CompletionQueue::GOT_EVENT) {
+      HandleEvent(tag, ok);
+    } else if (status == grpc::CompletionQueue::SHUTDOWN) {
+      break;
+    }
+    CheckDeadlines();
+  }
+
+  // 退出过程中被放回环中的样本（过载重试、退回一元调用）同样落盘
+  SpoolRing();
+  {
+    std::lock_guard<std::mutex> lock(wake_mtx_);
+    wake_pending_ = true;
+  }
+  cq_.Shutdown();
+  void* tag = nullptr;
+  bool ok = false;
+  while (cq_.Next(&tag, &ok)) {
+  }
+}
+
+void MonitorPusher::Pump() {
+  auto now = std::chrono::steady_clock::now();
+  // 过载退避期间样本留在环中，退避结束后按顺序发出
+  if (now < backoff_until_ || ring_.Size() == 0) {
+    return;
+  }
+
+  if (!stream_supported_) {
+    if (unary_) {
+      return;
+    }
+    if (now < retry_at_) {
+      SpoolRing();
+      return;
+    }
+    monitor::proto::MonitorInfo info;
+    if (ring_.Pop(&info)) {
+      StartUnary(&info);
+    }
+    return;
+  }
+
+  if (!stream_) {
+    if (now < retry_at_) {
+      // 等待重连期间的样本直接落盘，连接恢复后补传
+      SpoolRing();
+      return;
+    }
+    OpenStream();
+    return;
+  }
+
+  // 异步流上同一时刻只能有一个写操作
+  if (stream_->started && !stream_->writing && !stream_->closing) {
+    monitor::proto::MonitorInfo info;
+    if (ring_.Pop(&info)) {
+      WriteStream(&info);
+    }
+  }
+}
+
+void MonitorPusher::HandleEvent(void* tag, bool ok) {
+  PushOp op = FromTag(tag);
+  if (op == PushOp::kWake) {
+    std::lock_guard<std::mutex> lock(wake_mtx_);
+    wake_pending_ = false;
+    return;
+  }
+  if (op == PushOp::kUnary) {
+    OnUnaryDone();
+    return;
+  }
+  if (op == PushOp::kBackfill) {
+    OnBackfillDone();
+    return;
+  }
+
+  StreamCall* call = stream_.get();
+  --call->pending;
+  switch (op) {
+    case PushOp::kStart:
+      if (ok) {
+        call->started = true;
+        PostRead();
+        std::cout << "Push stream opened to " << manager_address_ << std::endl;
+      } else {
+        BreakStream(nullptr);
+      }
+      break;
+    case PushOp::kWrite:
+      call->writing = false;
+      if (ok) {
+        std::cout << ">>> Pushed monitor data to " << manager_address_
+                  << " over stream <<<" << std::endl;
+        if (!call->closing) {
+          Backfill();
+        }
+      } else {
+        BreakStream(">>> Push stream broken, will reconnect <<<");
+      }
+      break;
+    case PushOp::kRead:
+      call->reading = false;
+      if (ok) {
+        call->acked = true;
+        while (call->unacked_base < call->ack.received() && !call->unacked.empty()) {
+          call->unacked.pop_front();
+          ++call->unacked_base;
+        }
+        if (call->ack.retry_after_ms() > 0) {
+          SetBackoff(std::chrono::milliseconds(call->ack.retry_after_ms()));
+          std::cerr << ">>> Manager overloaded (" << call->ack.rejected() << "/"
+                    << call->ack.received() << " rejected on this stream), backing off <<<"
+                    << std::endl;
+        }
+        PostRead();
+      } else if (!call->closing) {
+        // 管理者结束了流或连接断开：取消写端，再取回最终状态
+        BreakStream(nullptr);
+      } else if (!call->finishing) {
+        FinishStream();
+      }
+      break;
+    case PushOp::kWritesDone:
+      break;
+    case PushOp::kFinish:
+      call->finished = true;
+      if (call->status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+        // 旧版管理者没有流式接口，此后改用一元调用
+        stream_supported_ = false;
+        std::cerr << "Manager does not support streaming push, "
+                  << "falling back to unary calls" << std::endl;
+      } else if (!call->status.ok() &&
+                 call->status.error_code() != grpc::StatusCode::CANCELLED) {
+        std::cerr << "Push stream closed: " << call->status.error_message() << std::endl;
+      }
+      break;
+    default:
+      break;
+  }
+  MaybeRetireStream();
+}
+
+void MonitorPusher::CheckDeadlines() {
+  if (!stream_ || stream_->cancelled) {
+    return;
+  }
+  if ((!stream_->started || stream_->writing) &&
+      std::chrono::steady_clock::now() >= stream_->deadline) {
+    BreakStream(">>> Push stream deadline exceeded, will reconnect <<<");
+  }
+}
+
+void MonitorPusher::OpenStream() {
+  stream_ = std::make_unique<StreamCall>();
+  stream_->rw = stub_->PrepareAsyncStreamMonitorInfo(&stream_->ctx, &cq_);
+  stream_->deadline = std::chrono::steady_clock::now() + kSendDeadline;
+  stream_->rw->StartCall(ToTag(PushOp::kStart));
+  ++stream_->pending;
+}
+
+void MonitorPusher::WriteStream(monitor::proto::MonitorInfo* info) {
+  // 先登记为未确认再写出：回执按序号确认，流结束时未确认的部分转入 spool
+  std::string payload;
+  info->SerializeToString(&payload);
+  stream_->unacked.push_back(std::move(payload));
+
+  stream_->rw->Write(*info, ToTag(PushOp::kWrite));
+  ++stream_->pending;
+  stream_->writing = true;
+  stream_->deadline = std::chrono::steady_clock::now() + kSendDeadline;
+}
+
+void MonitorPusher::PostRead() {
+  stream_->rw->Read(&stream_->ack, ToTag(PushOp::kRead));
+  ++stream_->pending;
+  stream_->reading = true;
+}
+
+void MonitorPusher::BreakStream(const char* reason) {
+  StreamCall* call = stream_.get();
+  if (!call->cancelled) {
+    call->cancelled = true;
+    call->closing = true;
+    call->ctx.TryCancel();
+    if (reason) {
+      std::cerr << reason << std::endl;
+    }
+  }
+  // 读操作在途时由它的失败事件触发 Finish
+  if (!call->reading && !call->finishing) {
+    FinishStream();
+  }
+}
+
+void MonitorPusher::FinishStream() {
+  stream_->finishing = true;
+  stream_->rw->Finish(&stream_->status, ToTag(PushOp::kFinish));
+  ++stream_->pending;
+}
+
+void MonitorPusher::MaybeRetireStream() {
+  if (!stream_ || !stream_->finished || stream_->pending > 0) {
+    return;
+  }
+  std::unique_ptr<StreamCall> call = std::move(stream_);
+
+  // 收到过回执说明连接曾经可用，重试退避从头开始
+  if (call->acked) {
+    retry_attempts_ = 0;
+  }
+
+  if (!call->unacked.empty()) {
+    if (!stream_supported_) {
+      // 管理者没有处理过这些样本，放回环中由一元调用重新发送
+      for (auto it = call->unacked.rbegin(); it != call->unacked.rend(); ++it) {
+        monitor::proto::MonitorInfo info;
+        if (info.ParseFromString(*it)) {
+          ring_.PushFront(std::move(info));
+        }
+      }
+    } else if (spool_) {
+      // 未被确认的样本可能没有送达，落盘等待补传
+      for (const auto& payload : call->unacked) {
+        spool_->AppendPayload(payload);
+      }
+      std::cerr << "Spooled " << call->unacked.size()
+                << " unacknowledged samples from the closed stream" << std::endl;
+    }
+  }
+
+  if (running_ && stream_supported_ && !call->status.ok()) {
+    ScheduleRetry();
+  }
+}
+
+void MonitorPusher::CloseStreamGracefully() {
+  if (!stream_ || stream_->closing) {
+    return;
+  }
+  if (!stream_->started) {
+    BreakStream(nullptr);
+    return;
+  }
+  if (stream_->writing) {
+    return;  // 等当前写出完成后再半关闭
+  }
+  // 半关闭写端，管理者处理完剩余上报、发出最后的回执后结束流
+  stream_->closing = true;
+  stream_->rw->WritesDone(ToTag(PushOp::kWritesDone));
+  ++stream_->pending;
+}
+
+void MonitorPusher::StartUnary(monitor::proto::MonitorInfo* info) {
+  unary_ = std::make_unique<UnaryCall>();
+  unary_->info.Swap(info);
+  unary_->ctx.set_deadline(std::chrono::system_clock::now() + kSendDeadline);
+  unary_->reader = stub_->PrepareAsyncSetMonitorInfo(&unary_->ctx, unary_->info, &cq_);
+  unary_->reader->StartCall();
+  unary_->reader->Finish(&unary_->response, &unary_->status, ToTag(PushOp::kUnary));
+}
+
+void MonitorPusher::OnUnaryDone() {
+  std::unique_ptr<UnaryCall> call = std::move(unary_);
+  const grpc::Status& status = call->status;
 
   if (status.ok()) {
+    consecutive_rejects_ = 0;
+    retry_attempts_ = 0;
     std::cout << ">>> Pushed monitor data to " << manager_address_ << " successfully <<<" << std::endl;
-    return true;
+    Backfill();
+  } else if (status.error_code() == grpc::StatusCode::RESOURCE_EXHAUSTED) {
+    // 管理者过载：样本放回队头，退避结束后重试
+    BackOff(call->ctx);
+    ring_.PushFront(std::move(call->info));
+    std::cerr << ">>> Manager overloaded, backing off: " << status.error_message()
+              << " <<<" << std::endl;
   } else {
     std::cerr << ">>> Push failed: " << status.error_message() << " <<<" << std::endl;
-    return false;
+    Spool(call->info);
+    ScheduleRetry();
+  }
+}
+
+void MonitorPusher::ScheduleRetry() {
+  int shift = std::min(retry_attempts_++, 6);
+  auto delay = std::min<std::chrono::milliseconds>(kRetryBase * (1 << shift),
+                                                   kMaxBackoff);
+  // 加 0 ~ 50% 的随机抖动，避免所有工作者在管理者恢复的同一时刻重连
+  std::uniform_real_distribution<double> jitter(1.0, 1.5);
+  delay = std::chrono::milliseconds(
+      static_cast<int64_t>(delay.count() * jitter(rng_)));
+  retry_at_ = std::chrono::steady_clock::now() + delay;
+}
+
+void MonitorPusher::Spool(const monitor::proto::MonitorInfo& info) {
+  if (spool_ && spool_->Append(info)) {
+    std::cerr << ">>> Sample spooled for backfill (" << spool_->PendingBytes()
+              << " bytes pending) <<<" << std::endl;
+  }
+}
+
+void MonitorPusher::SpoolRing() {
+  size_t count = 0;
+  monitor::proto::MonitorInfo info;
+  while (ring_.Pop(&info)) {
+    if (spool_ && spool_->Append(info)) {
+      ++count;
+    }
+  }
+  if (count > 0) {
+    std::cerr << ">>> Push stream down, spooled " << count << " samples ("
+              << spool_->PendingBytes() << " bytes pending) <<<" << std::endl;
+  }
+}
+
+void MonitorPusher::Backfill() {
+  // 上一次补传仍在途时由它的完成事件接着补传
+  if (backfill_) {
+    return;
   }
+  backfill_rounds_ = 0;
+  StartBackfill();
+}
+
+void MonitorPusher::StartBackfill() {
+  if (!spool_ || !backfill_supported_ || !running_ || spool_->Empty()) {
+    return;
+  }
+  auto records = spool_->Peek(kBackfillBatchRecords, kBackfillBatchBytes);
+  if (records.empty()) {
+    return;
+  }
+
+  backfill_ = std::make_unique<BackfillCall>();
+  backfill_->records = std::move(records);
+  // 与 records 一一对应：解析失败的帧以空样本占位，管理者按无效样本计入已接收
+  for (const auto& record : backfill_->records) {
+    auto* item = backfill_->batch.add_items();
+    if (!item->ParseFromString(record.payload)) {
+      item->Clear();
+    }
+    item->set_replayed(true);
+  }
+
+  backfill_->ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+  backfill_->ctx.set_deadline(std::chrono::system_clock::now() + kBackfillDeadline);
+  backfill_->reader =
+      stub_->PrepareAsyncBackfill(&backfill_->ctx, backfill_->batch, &cq_);
+  backfill_->reader->StartCall();
+  backfill_->reader->Finish(&backfill_->ack, &backfill_->status,
+                            ToTag(PushOp::kBackfill));
+  ++backfill_rounds_;
+}
+
+void MonitorPusher::OnBackfillDone() {
+  std::unique_ptr<BackfillCall> call = std::move(backfill_);
+  const grpc::Status& status = call->status;
+  if (!status.ok()) {
+    if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+      backfill_supported_ = false;
+      std::cerr << "Manager does not support backfill, spooled samples "
+                << "will not be replayed" << std::endl;
+    } else {
+      std::cerr << ">>> Backfill failed: " << status.error_message() << " <<<"
+                << std::endl;
+    }
+    return;
+  }
+
+  const auto& records = call->records;
+  size_t accepted = std::min<size_t>(call->ack.accepted(), records.size());
+  if (accepted > 0) {
+    spool_->Commit(records[accepted - 1].end);
+    std::cout << ">>> Backfilled " << accepted << " samples, "
+              << spool_->PendingBytes() << " bytes pending <<<" << std::endl;
+  }
+  if (call->ack.retry_after_ms() > 0) {
+    SetBackoff(std::chrono::milliseconds(call->ack.retry_after_ms()));
+    return;
+  }
+  if (accepted < records.size() || backfill_rounds_ >= kMaxBackfillBatches) {
+    return;
+  }
+  StartBackfill();
+}
+
+void MonitorPusher::BackOff(const grpc::ClientContext& context) {
+  ++consecutive_rejects_;
+
+  // 优先使用管理者给出的重试提示；没有时按推送间隔指数退避
+  std::chrono::milliseconds delay(0);
+  const auto& trailers = context.GetServerTrailingMetadata();
+  auto it = trailers.find(kRetryAfterMetadataKey);
+  if (it != trailers.end()) {
+    delay = std::chrono::milliseconds(
+        std::strtoll(std::string(it->second.data(), it->second.size()).c_str(),
+                     nullptr, 10));
+  }
+  if (delay.count() <= 0) {
+    int shift = std::min(consecutive_rejects_ - 1, 6);
+    delay = std::chrono::seconds(interval_seconds_) * (1 << shift);
+  }
+  SetBackoff(delay);
+}
+
+void MonitorPusher::SetBackoff(std::chrono::milliseconds delay) {
+  delay = std::min<std::chrono::milliseconds>(delay, kMaxBackoff);
+
+  // 加 0 ~ 50% 的随机抖动，避免所有工作者在同一时刻重新涌入
+  std::uniform_real_distribution<double> jitter(1.0, 1.5);
+  delay = std::chrono::milliseconds(
+      static_cast<int64_t>(delay.count() * jitter(rng_)));
+  backoff_until_ = std::max(backoff_until_, std::chrono::steady_clock::now() + delay);
 }
 
 }  // namespace monitor
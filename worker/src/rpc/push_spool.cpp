@@ -0,0 +1,389 @@
+#include "rpc/push_spool.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace monitor {
+
+namespace {
+
+constexpr uint32_t kFrameMagic = 0x4d535031;  // "MSP1"
+constexpr uint32_t kMaxFrameLength = 16u << 20;
+constexpr char kSegmentPrefix[] = "spool-";
+constexpr char kSegmentSuffix[] = ".log";
+constexpr char kCursorFile[] = "cursor";
+
+struct FrameHeader {
+  uint32_t magic;
+  uint32_t length;
+  uint32_t crc;
+};
+
+// CRC32 (IEEE 802.3)，按字节查表
+uint32_t Crc32(const void* data, size_t len) {
+  static const auto table = [] {
+    std::vector<uint32_t> t(256);
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      t[i] = c;
+    }
+    return t;
+  }();
+
+  uint32_t crc = 0xffffffffu;
+  const auto* p = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; ++i) {
+    crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffffu;
+}
+
+bool WriteAll(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    ssize_t n = ::write(fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool ReadAt(int fd, void* buf, size_t len, uint64_t offset) {
+  auto* p = static_cast<char*>(buf);
+  while (len > 0) {
+    ssize_t n = ::pread(fd, p, len, static_cast<off_t>(offset));
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (n == 0) return false;
+    p += n;
+    len -= static_cast<size_t>(n);
+    offset += static_cast<uint64_t>(n);
+  }
+  return true;
+}
+
+// 读取并校验 offset 处的一帧；成功时 payload 为帧内容
+bool ReadFrame(int fd, uint64_t offset, uint64_t limit, std::string* payload) {
+  FrameHeader header;
+  if (offset + sizeof(header) > limit ||
+      !ReadAt(fd, &header, sizeof(header), offset)) {
+    return false;
+  }
+  if (header.magic != kFrameMagic || header.length > kMaxFrameLength ||
+      offset + sizeof(header) + header.length > limit) {
+    return false;
+  }
+  payload->resize(header.length);
+  if (header.length > 0 &&
+      !ReadAt(fd, &(*payload)[0], header.length, offset + sizeof(header))) {
+    return false;
+  }
+  return Crc32(payload->data(), payload->size()) == header.crc;
+}
+
+}  // namespace
+
+PushSpool::PushSpool(const PushSpoolOptions& options) : options_(options) {
+  options_.segment_bytes = std::max<uint64_t>(options_.segment_bytes, 64 << 10);
+  options_.max_bytes = std::max(options_.max_bytes, options_.segment_bytes * 2);
+}
+
+PushSpool::~PushSpool() {
+  if (write_fd_ >= 0) {
+    ::close(write_fd_);
+  }
+}
+
+std::string PushSpool::SegmentPath(uint64_t seq) const {
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s%010llu%s", kSegmentPrefix,
+                static_cast<unsigned long long>(seq), kSegmentSuffix);
+  return options_.dir + "/" + name;
+}
+
+bool PushSpool::Open() {
+  if (::mkdir(options_.dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    std::cerr << "PushSpool: cannot create " << options_.dir << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  DIR* dir = ::opendir(options_.dir.c_str());
+  if (!dir) {
+    std::cerr << "PushSpool: cannot open " << options_.dir << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  std::vector<uint64_t> seqs;
+  const size_t prefix_len = std::strlen(kSegmentPrefix);
+  while (struct dirent* entry = ::readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.compare(0, prefix_len, kSegmentPrefix) != 0) continue;
+    seqs.push_back(std::strtoull(name.c_str() + prefix_len, nullptr, 10));
+  }
+  ::closedir(dir);
+  std::sort(seqs.begin(), seqs.end());
+
+  segments_.clear();
+  total_bytes_ = 0;
+  for (uint64_t seq : seqs) {
+    struct stat st;
+    if (seq == 0 || ::stat(SegmentPath(seq).c_str(), &st) != 0) continue;
+    segments_.push_back({seq, static_cast<uint64_t>(st.st_size)});
+    total_bytes_ += static_cast<uint64_t>(st.st_size);
+  }
+
+  // 只有最后一个段可能在写入中途被打断，截断到最后一个完整帧
+  if (!segments_.empty()) {
+    Segment& last = segments_.back();
+    uint64_t valid = ValidLength(SegmentPath(last.seq), last.size);
+    if (valid < last.size) {
+      std::cerr << "PushSpool: truncating torn tail of " << SegmentPath(last.seq)
+                << " (" << last.size - valid << " bytes)" << std::endl;
+      if (::truncate(SegmentPath(last.seq).c_str(), static_cast<off_t>(valid)) == 0) {
+        total_bytes_ -= last.size - valid;
+        last.size = valid;
+      }
+    }
+  }
+
+  uint64_t write_seq = segments_.empty() ? 1 : segments_.back().seq;
+  if (!OpenWriteSegment(write_seq)) {
+    return false;
+  }
+
+  LoadCursor();
+  opened_ = true;
+  if (!Empty()) {
+    std::cout << "PushSpool: " << PendingBytes() << " bytes pending backfill in "
+              << options_.dir << std::endl;
+  }
+  return true;
+}
+
+bool PushSpool::OpenWriteSegment(uint64_t seq) {
+  if (write_fd_ >= 0) {
+    ::close(write_fd_);
+    write_fd_ = -1;
+  }
+  std::string path = SegmentPath(seq);
+  write_fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (write_fd_ < 0) {
+    std::cerr << "PushSpool: cannot open " << path << ": " << std::strerror(errno)
+              << std::endl;
+    return false;
+  }
+  if (segments_.empty() || segments_.back().seq != seq) {
+    segments_.push_back({seq, 0});
+  }
+  return true;
+}
+
+uint64_t PushSpool::ValidLength(const std::string& path, uint64_t size) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return 0;
+  uint64_t offset = 0;
+  std::string payload;
+  while (ReadFrame(fd, offset, size, &payload)) {
+    offset += sizeof(FrameHeader) + payload.size();
+  }
+  ::close(fd);
+  return offset;
+}
+
+bool PushSpool::Append(const monitor::proto::MonitorInfo& info) {
+  std::string payload;
+  if (!info.SerializeToString(&payload)) {
+    return false;
+  }
+  return AppendPayload(payload);
+}
+
+bool PushSpool::AppendPayload(const std::string& payload) {
+  if (!opened_ || payload.size() > kMaxFrameLength) {
+    return false;
+  }
+
+  // 当前段写满时切换到新段
+  Segment* current = &segments_.back();
+  uint64_t frame_size = sizeof(FrameHeader) + payload.size();
+  if (current->size > 0 && current->size + frame_size > options_.segment_bytes) {
+    if (!OpenWriteSegment(current->seq + 1)) {
+      return false;
+    }
+    current = &segments_.back();
+  }
+
+  // 头和内容拼成一次 write，O_APPEND 保证整帧追加到段尾
+  FrameHeader header{kFrameMagic, static_cast<uint32_t>(payload.size()),
+                     Crc32(payload.data(), payload.size())};
+  std::string frame;
+  frame.reserve(frame_size);
+  frame.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  frame.append(payload);
+  if (!WriteAll(write_fd_, frame.data(), frame.size())) {
+    std::cerr << "PushSpool: write failed: " << std::strerror(errno) << std::endl;
+    return false;
+  }
+  current->size += frame_size;
+  total_bytes_ += frame_size;
+
+  EnforceLimit();
+  return true;
+}
+
+void PushSpool::EnforceLimit() {
+  while (total_bytes_ > options_.max_bytes && segments_.size() > 1) {
+    const Segment& oldest = segments_.front();
+    uint64_t unread = oldest.size;
+    if (read_.seq == oldest.seq) {
+      unread -= std::min(read_.offset, oldest.size);
+    } else if (read_.seq > oldest.seq) {
+      unread = 0;
+    }
+    dropped_bytes_ += unread;
+    total_bytes_ -= oldest.size;
+    ::unlink(SegmentPath(oldest.seq).c_str());
+    segments_.pop_front();
+
+    if (read_.seq < segments_.front().seq) {
+      read_ = {segments_.front().seq, 0};
+      SaveCursor();
+    }
+  }
+}
+
+std::vector<PushSpool::Record> PushSpool::Peek(size_t max_records, size_t max_bytes) {
+  std::vector<Record> records;
+  if (!opened_) return records;
+
+  Cursor pos = read_;
+  size_t bytes = 0;
+  for (const Segment& segment : segments_) {
+    if (segment.seq < pos.seq) continue;
+    if (segment.seq > pos.seq) pos = {segment.seq, 0};
+
+    int fd = ::open(SegmentPath(segment.seq).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) continue;
+    std::string payload;
+    while (pos.offset < segment.size && records.size() < max_records &&
+           bytes < max_bytes) {
+      if (!ReadFrame(fd, pos.offset, segment.size, &payload)) {
+        // 段中间的损坏帧无法定位下一帧，跳过该段剩余部分
+        ++corrupt_frames_;
+        pos.offset = segment.size;
+        if (records.empty()) {
+          read_ = pos;
+          SaveCursor();
+        } else {
+          records.back().end = pos;
+        }
+        break;
+      }
+      pos.offset += sizeof(FrameHeader) + payload.size();
+      bytes += payload.size();
+      records.push_back({std::move(payload), pos});
+    }
+    ::close(fd);
+
+    if (records.size() >= max_records || bytes >= max_bytes) break;
+  }
+  return records;
+}
+
+void PushSpool::Commit(const Cursor& cursor) {
+  if (!opened_) return;
+  read_ = cursor;
+  ReleaseConsumed();
+  SaveCursor();
+}
+
+void PushSpool::ReleaseConsumed() {
+  // 读完的旧段整段删除；当前写入段读完后截断为空，重新从头写
+  while (segments_.size() > 1 && (read_.seq > segments_.front().seq ||
+                                  (read_.seq == segments_.front().seq &&
+                                   read_.offset >= segments_.front().size))) {
+    total_bytes_ -= segments_.front().size;
+    ::unlink(SegmentPath(segments_.front().seq).c_str());
+    segments_.pop_front();
+    if (read_.seq < segments_.front().seq) {
+      read_ = {segments_.front().seq, 0};
+    }
+  }
+
+  Segment& last = segments_.back();
+  if (read_.seq == last.seq && read_.offset >= last.size && last.size > 0) {
+    if (::ftruncate(write_fd_, 0) == 0) {
+      total_bytes_ -= last.size;
+      last.size = 0;
+      read_.offset = 0;
+    }
+  }
+}
+
+bool PushSpool::Empty() const { return PendingBytes() == 0; }
+
+uint64_t PushSpool::PendingBytes() const {
+  uint64_t pending = 0;
+  for (const Segment& segment : segments_) {
+    if (segment.seq > read_.seq) {
+      pending += segment.size;
+    } else if (segment.seq == read_.seq && segment.size > read_.offset) {
+      pending += segment.size - read_.offset;
+    }
+  }
+  return pending;
+}
+
+void PushSpool::LoadCursor() {
+  read_ = {segments_.front().seq, 0};
+  std::string path = options_.dir + "/" + kCursorFile;
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  Cursor saved;
+  if (ReadAt(fd, &saved, sizeof(saved), 0)) {
+    // 游标指向已删除的段时从现存最旧的段开始
+    for (const Segment& segment : segments_) {
+      if (segment.seq == saved.seq) {
+        read_ = {saved.seq, std::min(saved.offset, segment.size)};
+        break;
+      }
+      if (segment.seq > saved.seq) {
+        read_ = {segment.seq, 0};
+        break;
+      }
+    }
+  }
+  ::close(fd);
+}
+
+void PushSpool::SaveCursor() {
+  std::string path = options_.dir + "/" + kCursorFile;
+  std::string tmp = path + ".tmp";
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) return;
+  bool ok = WriteAll(fd, reinterpret_cast<const char*>(&read_), sizeof(read_));
+  ::close(fd);
+  if (ok) {
+    ::rename(tmp.c_str(), path.c_str());
+  }
+}
+
+}  // namespace monitor
@@ -0,0 +1,57 @@
+#include "rpc/sample_ring.h"
+
+#include <algorithm>
+
+namespace monitor {
+
+SampleRing::SampleRing(size_t capacity) : slots_(std::max<size_t>(capacity, 1)) {}
+
+bool SampleRing::Push(monitor::proto::MonitorInfo&& info) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  size_t tail = (head_ + size_) % slots_.size();
+  slots_[tail].Swap(&info);
+  if (size_ < slots_.size()) {
+    ++size_;
+    return true;
+  }
+  // 已满：tail 与 head_ 重合，刚覆盖的就是最旧的一条
+  head_ = (head_ + 1) % slots_.size();
+  ++dropped_;
+  return false;
+}
+
+bool SampleRing::PushFront(monitor::proto::MonitorInfo&& info) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (size_ == slots_.size()) {
+    ++dropped_;
+    return false;
+  }
+  head_ = (head_ + slots_.size() - 1) % slots_.size();
+  slots_[head_].Swap(&info);
+  ++size_;
+  return true;
+}
+
+bool SampleRing::Pop(monitor::proto::MonitorInfo* info) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (size_ == 0) {
+    return false;
+  }
+  info->Clear();
+  info->Swap(&slots_[head_]);
+  head_ = (head_ + 1) % slots_.size();
+  --size_;
+  return true;
+}
+
+size_t SampleRing::Size() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return size_;
+}
+
+uint64_t SampleRing::Dropped() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return dropped_;
+}
+
+}  // namespace monitor
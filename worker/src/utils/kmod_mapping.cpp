@@ -0,0 +1,102 @@
+#include "utils/kmod_mapping.h"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace monitor {
+
+namespace {
+// 已映射时校验设备节点的间隔
+constexpr auto kRevalidateInterval = std::chrono::seconds(1);
+// 设备不存在时重试 open 的间隔
+constexpr auto kRetryInterval = std::chrono::seconds(5);
+}  // namespace
+
+KmodMapping::KmodMapping(const std::string& path, size_t size)
+    : path_(path), size_(size) {
+  Map();
+  next_check_ = std::chrono::steady_clock::now() +
+                (addr_ ? kRevalidateInterval : kRetryInterval);
+}
+
+KmodMapping::~KmodMapping() {
+  Unmap();
+}
+
+const void* KmodMapping::Get() {
+  auto now = std::chrono::steady_clock::now();
+  if (now < next_check_) {
+    return addr_;
+  }
+
+  if (addr_ && Stale()) {
+    Unmap();
+  }
+  if (!addr_) {
+    Map();
+  }
+  next_check_ = now + (addr_ ? kRevalidateInterval : kRetryInterval);
+  return addr_;
+}
+
+bool KmodMapping::Map() {
+  int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    // 设备不存在，可能内核模块未加载
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  //使用mmap()直接将内核态设备数据映射到当前进程的虚拟地址空间，
+  //映射完成后进程可直接访问该内存，无需再进行数据拷贝
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+
+  addr_ = addr;
+  fd_ = fd;
+  rdev_ = st.st_rdev;
+  ino_ = st.st_ino;
+  return true;
+}
+
+void KmodMapping::Unmap() {
+  if (addr_) {
+    munmap(addr_, size_);
+    addr_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+int KmodMapping::Ioctl(unsigned long request, void* arg) {
+  if (fd_ < 0) {
+    errno = ENODEV;
+    return -1;
+  }
+  return ioctl(fd_, request, arg);
+}
+
+bool KmodMapping::Stale() const {
+  struct stat st;
+  if (stat(path_.c_str(), &st) != 0) {
+    return true;
+  }
+  return st.st_rdev != rdev_ || st.st_ino != ino_;
+}
+
+}  // namespace monitor
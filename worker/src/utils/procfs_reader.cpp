@@ -0,0 +1,69 @@
+#include "utils/procfs_reader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace monitor {
+
+ProcfsReader::ProcfsReader(const char* path, size_t initial_size)
+    : path_(path), buf_(new char[initial_size]), cap_(initial_size) {
+  Open();
+}
+
+ProcfsReader::~ProcfsReader() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool ProcfsReader::Open() {
+  fd_ = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  return fd_ >= 0;
+}
+
+bool ProcfsReader::Read() {
+  len_ = 0;
+  pos_ = 0;
+  if (fd_ < 0 && !Open()) {
+    return false;
+  }
+
+  // seq_file 一次 read 可能只返回部分记录，读到返回 0 为止；
+  // 偏移始终等于已读长度，内核按顺序续读，不会从头重新遍历
+  while (true) {
+    ssize_t n = pread(fd_, buf_.get() + len_, cap_ - len_, len_);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      len_ = 0;
+      return false;
+    }
+    if (n == 0) {
+      return true;
+    }
+    len_ += static_cast<size_t>(n);
+    if (len_ == cap_) {
+      std::unique_ptr<char[]> bigger(new char[cap_ * 2]);
+      memcpy(bigger.get(), buf_.get(), len_);
+      buf_ = std::move(bigger);
+      cap_ *= 2;
+    }
+  }
+}
+
+bool ProcfsReader::NextLine(std::string_view* line) {
+  if (pos_ >= len_) {
+    return false;
+  }
+  const char* begin = buf_.get() + pos_;
+  const void* newline = memchr(begin, '\n', len_ - pos_);
+  size_t size = newline ? static_cast<const char*>(newline) - begin : len_ - pos_;
+  *line = std::string_view(begin, size);
+  pos_ += size + 1;
+  return true;
+}
+
+}  // namespace monitor
@@ -0,0 +1,163 @@
+#include "utils/rtnetlink.h"
+
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace monitor {
+
+namespace {
+// 带统计信息的 RTM_NEWLINK 每条约 1~2KB，一次 recv 可以取回几十条
+constexpr size_t kReceiveBufferSize = 64 * 1024;
+}  // namespace
+
+RtnlSocket::~RtnlSocket() {
+  Close();
+}
+
+bool RtnlSocket::Open(uint32_t groups) {
+  Close();
+  fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (fd_ < 0) {
+    return false;
+  }
+  struct sockaddr_nl addr = {};
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = groups;
+  if (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    Close();
+    return false;
+  }
+  buf_.resize(kReceiveBufferSize);
+  return true;
+}
+
+void RtnlSocket::Close() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool RtnlSocket::SendDump(uint16_t type, const void* header,
+                          size_t header_len) {
+  std::vector<char> req(NLMSG_SPACE(header_len));
+  auto* nh = reinterpret_cast<struct nlmsghdr*>(req.data());
+  nh->nlmsg_len = NLMSG_LENGTH(header_len);
+  nh->nlmsg_type = type;
+  nh->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  nh->nlmsg_seq = ++seq_;
+  memcpy(NLMSG_DATA(nh), header, header_len);
+
+  struct sockaddr_nl kernel = {};
+  kernel.nl_family = AF_NETLINK;
+  ssize_t sent;
+  do {
+    sent = sendto(fd_, req.data(), nh->nlmsg_len, 0,
+                  reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel));
+  } while (sent < 0 && errno == EINTR);
+  return sent == static_cast<ssize_t>(nh->nlmsg_len);
+}
+
+bool RtnlSocket::ReceiveDump(const Handler& handler) {
+  while (true) {
+    ssize_t len = recv(fd_, buf_.data(), buf_.size(), 0);
+    if (len < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (len == 0) {
+      return false;
+    }
+
+    int remaining = static_cast<int>(len);
+    for (auto* nh = reinterpret_cast<const struct nlmsghdr*>(buf_.data());
+         NLMSG_OK(nh, remaining); nh = NLMSG_NEXT(nh, remaining)) {
+      // 同一套接字上的组播通知与其他请求的应答
+      if (nh->nlmsg_seq != seq_) continue;
+      if (nh->nlmsg_type == NLMSG_DONE) {
+        return true;
+      }
+      if (nh->nlmsg_type == NLMSG_ERROR) {
+        auto* err = static_cast<const struct nlmsgerr*>(NLMSG_DATA(nh));
+        errno = err->error ? -err->error : EIO;
+        return false;
+      }
+      handler(nh);
+    }
+  }
+}
+
+bool RtnlSocket::ReceiveOnce(const Handler& handler) {
+  ssize_t len;
+  do {
+    len = recv(fd_, buf_.data(), buf_.size(), 0);
+  } while (len < 0 && errno == EINTR);
+  if (len <= 0) {
+    return false;
+  }
+
+  int remaining = static_cast<int>(len);
+  for (auto* nh = reinterpret_cast<const struct nlmsghdr*>(buf_.data());
+       NLMSG_OK(nh, remaining); nh = NLMSG_NEXT(nh, remaining)) {
+    if (nh->nlmsg_type == NLMSG_DONE || nh->nlmsg_type == NLMSG_ERROR) {
+      continue;
+    }
+    handler(nh);
+  }
+  return true;
+}
+
+bool ParseLinkMessage(const struct nlmsghdr* nh, LinkInfo* link) {
+  if (nh->nlmsg_type != RTM_NEWLINK && nh->nlmsg_type != RTM_DELLINK) {
+    return false;
+  }
+  if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg))) {
+    return false;
+  }
+  auto* ifm = static_cast<const struct ifinfomsg*>(NLMSG_DATA(nh));
+  // 只认网卡本身的消息：桥端口等会以 AF_BRIDGE 发 RTM_NEWLINK / RTM_DELLINK
+  // （如端口离开网桥、VLAN 变化），网卡并没有增删
+  if (ifm->ifi_family != AF_UNSPEC) {
+    return false;
+  }
+  link->ifindex = ifm->ifi_index;
+  link->flags = ifm->ifi_flags;
+  link->type = ifm->ifi_type;
+  link->name.clear();
+
+  int attr_len = IFLA_PAYLOAD(nh);
+  for (auto* rta = IFLA_RTA(ifm); RTA_OK(rta, attr_len);
+       rta = RTA_NEXT(rta, attr_len)) {
+    if (rta->rta_type == IFLA_IFNAME) {
+      link->name = static_cast<const char*>(RTA_DATA(rta));
+      break;
+    }
+  }
+  return true;
+}
+
+bool DumpLinks(std::vector<LinkInfo>* links) {
+  RtnlSocket sock;
+  if (!sock.Open()) {
+    return false;
+  }
+  struct ifinfomsg ifm = {};
+  ifm.ifi_family = AF_UNSPEC;
+  if (!sock.SendDump(RTM_GETLINK, &ifm, sizeof(ifm))) {
+    return false;
+  }
+
+  links->clear();
+  LinkInfo link;
+  return sock.ReceiveDump([&](const struct nlmsghdr* nh) {
+    if (ParseLinkMessage(nh, &link)) {
+      links->push_back(link);
+    }
+  });
+}
+
+}  // namespace monitor